@@ -1,18 +1,44 @@
 
 package de.stetro.master.chisel;
 
+import java.nio.ByteBuffer;
+import java.nio.FloatBuffer;
 
 public class JNIInterface {
     static {
         System.loadLibrary("chisel");
     }
 
-    public static native void addPoints(float[] vertices, float[] transformation);
+    // integrate count xyz triples of a direct buffer, read in place
+    public static native void addPoints(FloatBuffer vertices, int count, float[] transformation);
 
-    public static native float[] getMesh();
+    // weld the chunk meshes for the export, returns the count of vertex floats
+    public static native int prepareMesh();
+
+    // count of triangle indices of the prepared mesh
+    public static native int getMeshIndexCount();
+
+    // copy prepared vertex floats or indices from offset into a direct buffer in
+    // native order, as many as fit, returns the count or -1 for a heap buffer
+    public static native int exportMeshVertices(ByteBuffer buffer, int offset);
+
+    public static native int exportMeshIndices(ByteBuffer buffer, int offset);
 
     public static native void clear();
 
     public static native void update();
 
+    // decimate the chunk meshes with an error bound in meters, 0 disables it
+    public static native void setDecimation(float maxError);
+
+    // move distant chunks into a map in directory once the TSDF takes more than
+    // budgetMegabytes
+    public static native void setStreaming(String directory, int budgetMegabytes);
+
+    // write the TSDF into a map file
+    public static native boolean save(String path);
+
+    // start from a saved map, its chunks are loaded around the camera
+    public static native boolean load(String path);
+
 }
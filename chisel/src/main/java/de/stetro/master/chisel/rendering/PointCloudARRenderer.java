@@ -16,6 +16,10 @@ import org.rajawali3d.math.Quaternion;
 import org.rajawali3d.math.vector.Vector3;
 import org.rajawali3d.primitives.Cube;
 
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.FloatBuffer;
+import java.nio.IntBuffer;
 import java.util.ArrayList;
 import java.util.List;
 import java.util.Stack;
@@ -33,7 +37,11 @@ public class PointCloudARRenderer extends TangoRajawaliRenderer {
     private PointCloudManager pointCloudManager;
     private Polygon polygon;
     private boolean isRunning = true;
-    private float[] mesh;
+    // direct buffers the native mesh is exported into, reused across captures
+    private ByteBuffer meshVertices;
+    private ByteBuffer meshIndices;
+    private int meshVertexFloats;
+    private int meshIndexCount;
     private boolean updateMesh;
     private Cube cube;
 
@@ -63,20 +71,39 @@ public class PointCloudARRenderer extends TangoRajawaliRenderer {
         if (pointCloudManager != null) {
             long measure = System.currentTimeMillis();
             Pose pose = mScenePoseCalcuator.toOpenGLPointCloudPose(pointCloudManager.getDevicePoseAtCloudTime());
-            float[] points = pointCloudManager.getPoints();
             Matrix4 transformation = poseToTransformation(pose);
-            Vector3 aPoint = new Vector3(points[0], points[1], points[2]);
-            cube.setPosition(aPoint.multiply(transformation));
             float[] values = transformation.getFloatValues();
             float[] copy = swapMatrixFloatRepresentation(values);
-            JNIInterface.addPoints(points, copy);
+            synchronized (pointCloudManager) {
+                FloatBuffer points = pointCloudManager.getPoints();
+                Vector3 aPoint = new Vector3(points.get(0), points.get(1), points.get(2));
+                cube.setPosition(aPoint.multiply(transformation));
+                JNIInterface.addPoints(points, pointCloudManager.getPointCount(), copy);
+            }
             JNIInterface.update();
-            mesh = JNIInterface.getMesh();
-            updateMesh = true;
+            fetchMesh();
             Log.d(tag, "Operation took " + (System.currentTimeMillis() - measure) + "ms");
         }
     }
 
+    private synchronized void fetchMesh() {
+        meshVertexFloats = JNIInterface.prepareMesh();
+        meshIndexCount = JNIInterface.getMeshIndexCount();
+        meshVertices = ensureCapacity(meshVertices, meshVertexFloats * 4);
+        meshIndices = ensureCapacity(meshIndices, meshIndexCount * 4);
+        JNIInterface.exportMeshVertices(meshVertices, 0);
+        JNIInterface.exportMeshIndices(meshIndices, 0);
+        updateMesh = true;
+    }
+
+    private static ByteBuffer ensureCapacity(ByteBuffer buffer, int bytes) {
+        if (buffer != null && buffer.capacity() >= bytes) {
+            return buffer;
+        }
+        // grow by half so a growing reconstruction rarely reallocates
+        return ByteBuffer.allocateDirect(bytes + bytes / 2).order(ByteOrder.nativeOrder());
+    }
+
     private float[] swapMatrixFloatRepresentation(float[] values) {
         float[] copy = new float[16];
         copy[0] = values[Matrix4.M00];
@@ -126,28 +153,31 @@ public class PointCloudARRenderer extends TangoRajawaliRenderer {
 
                 synchronized (pointCloudManager) {
 
-                    if (polygon != null) {
-                        getCurrentScene().removeChild(polygon);
-                    }
-                    Stack<Vector3> faces = new Stack<>();
-                    for (int i = 0; i < mesh.length / 3; i++) {
-                        faces.add(new Vector3(mesh[i * 3], mesh[i * 3 + 1], mesh[i * 3 + 2]));
+                    if (polygon == null || !polygon.fits(meshVertexFloats, meshIndexCount)) {
+                        if (polygon != null) {
+                            getCurrentScene().removeChild(polygon);
+                        }
+                        polygon = new Polygon(meshVertices.capacity() / 4, meshIndices.capacity() / 4);
+                        polygon.setTransparent(true);
+                        polygon.setMaterial(Materials.getDepthMaterial());
+                        polygon.setDepthTestEnabled(true);
+                        polygon.setDoubleSided(true);
+                        getCurrentScene().addChild(polygon);
                     }
-                    polygon = new Polygon(faces);
-                    polygon.setTransparent(true);
-                    polygon.setMaterial(Materials.getDepthMaterial());
-                    polygon.setDepthTestEnabled(true);
-                    polygon.setDoubleSided(true);
-                    getCurrentScene().addChild(polygon);
+                    polygon.update(meshVertices.asFloatBuffer(), meshVertexFloats,
+                            meshIndices.asIntBuffer(), meshIndexCount);
                 }
             }
         }
     }
 
-    public void setFaces(Stack<Vector3> faces) {
-        float[] mesh = JNIInterface.getMesh();
-        for (int i = 0; i < mesh.length / 3; i++) {
-            faces.add(new Vector3(mesh[i * 3], mesh[i * 3 + 1], mesh[i * 3 + 2]));
+    public synchronized void setFaces(Stack<Vector3> faces) {
+        fetchMesh();
+        FloatBuffer vertices = meshVertices.asFloatBuffer();
+        IntBuffer indices = meshIndices.asIntBuffer();
+        for (int i = 0; i < meshIndexCount; i++) {
+            int index = indices.get(i);
+            faces.add(new Vector3(vertices.get(index * 3), vertices.get(index * 3 + 1), vertices.get(index * 3 + 2)));
         }
     }
 
@@ -158,6 +188,7 @@ public class PointCloudARRenderer extends TangoRajawaliRenderer {
     public void clearPoints() {
         if (polygon != null) {
             getCurrentScene().removeChild(polygon);
+            polygon = null;
             JNIInterface.clear();
         }
     }
@@ -167,13 +198,16 @@ public class PointCloudARRenderer extends TangoRajawaliRenderer {
         Log.d(tag, "Toggled Reconstruction to " + isRunning);
     }
 
-    public void exportMesh() {
-        if (mesh.length > 0) {
+    public synchronized void exportMesh() {
+        if (meshVertexFloats > 0) {
+            FloatBuffer mesh = meshVertices.asFloatBuffer();
             List<Vector3> vertices = new ArrayList<>();
-            for (int i = 0; i < mesh.length / 3; i++) {
-                vertices.add(new Vector3(mesh[i * 3], mesh[i * 3 + 1], mesh[i * 3 + 2]));
+            for (int i = 0; i < meshVertexFloats / 3; i++) {
+                vertices.add(new Vector3(mesh.get(i * 3), mesh.get(i * 3 + 1), mesh.get(i * 3 + 2)));
             }
-            PLYExporter plyExporter = new PLYExporter(getContext(), vertices);
+            int[] indices = new int[meshIndexCount];
+            meshIndices.asIntBuffer().get(indices);
+            PLYExporter plyExporter = new PLYExporter(getContext(), vertices, indices);
             plyExporter.export();
         }
     }
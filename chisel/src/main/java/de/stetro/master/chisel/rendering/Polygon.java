@@ -4,6 +4,8 @@ package de.stetro.master.chisel.rendering;
 import org.rajawali3d.Object3D;
 import org.rajawali3d.math.vector.Vector3;
 
+import java.nio.FloatBuffer;
+import java.nio.IntBuffer;
 import java.util.Stack;
 
 public class Polygon extends Object3D {
@@ -15,6 +17,37 @@ public class Polygon extends Object3D {
         init();
     }
 
+    // indexed mesh with room for vertexFloats (xyz triples) and indexCount
+    // triangle indices, filled on the GL thread with update
+    public Polygon(int vertexFloats, int indexCount) {
+        super();
+        setDoubleSided(true);
+
+        int numVertices = vertexFloats / 3;
+        float[] textureCoors = new float[numVertices * 2];
+        float[] normals = new float[numVertices * 3];
+        for (int i = 0; i < numVertices; i++) {
+            normals[i * 3 + 2] = 1;
+        }
+
+        setData(new float[numVertices * 3], normals, textureCoors, null, new int[indexCount], true);
+        mGeometry.setNumIndices(0);
+    }
+
+    public boolean fits(int vertexFloats, int indexCount) {
+        return mGeometry.getVertices().capacity() >= vertexFloats &&
+                mGeometry.getIndices().capacity() >= indexCount;
+    }
+
+    // uploads the leading part of the buffers into the existing VBOs
+    public void update(FloatBuffer vertices, int vertexFloats, IntBuffer indices, int indexCount) {
+        vertices.position(0);
+        indices.position(0);
+        mGeometry.changeBufferData(mGeometry.getVertexBufferInfo(), vertices, 0, vertexFloats);
+        mGeometry.changeBufferData(mGeometry.getIndexBufferInfo(), indices, 0, indexCount);
+        mGeometry.setNumIndices(indexCount);
+    }
+
     private void init() {
         setDoubleSided(true);
 
@@ -27,12 +27,17 @@ import java.io.IOException;
 import java.io.InputStream;
 import java.util.ArrayList;
 
+import de.stetro.master.chisel.JNIInterface;
 import de.stetro.master.chisel.R;
 import de.stetro.master.chisel.rendering.PointCloudARRenderer;
 import de.stetro.master.chisel.util.PointCloudManager;
 
 public class MainActivity extends BaseActivity implements View.OnTouchListener {
     private static final String tag = MainActivity.class.getSimpleName();
+    // surface deviation allowed by the mesh decimation in meters
+    private static final float MESH_DECIMATION_ERROR = 0.01f;
+    private static final String MAP_FILE = "map.tsdf";
+    private static final int TSDF_MEMORY_BUDGET_MB = 128;
     private TangoRajawaliView glView;
     private PointCloudARRenderer renderer;
     private PointCloudManager pointCloudManager;
@@ -55,6 +60,9 @@ public class MainActivity extends BaseActivity implements View.OnTouchListener {
                 Tango.TANGO_INTENT_ACTIVITYCODE);
         wrapper.addView(glView);
 
+        // spill distant parts of large TSDF maps into the cache
+        JNIInterface.setStreaming(new File(getCacheDir(), "tsdf").getAbsolutePath(),
+                TSDF_MEMORY_BUDGET_MB);
     }
 
     private void loadAssetLibrary(String libraryName) {
@@ -168,6 +176,20 @@ public class MainActivity extends BaseActivity implements View.OnTouchListener {
             case R.id.activity_main_menu_archive:
                 renderer.exportMesh();
                 return true;
+            case R.id.activity_main_menu_decimate:
+                item.setChecked(!item.isChecked());
+                JNIInterface.setDecimation(item.isChecked() ? MESH_DECIMATION_ERROR : 0.0f);
+                return true;
+            case R.id.activity_main_menu_save:
+                if (!JNIInterface.save(new File(getFilesDir(), MAP_FILE).getAbsolutePath())) {
+                    Toast.makeText(this, R.string.save_map_failed, Toast.LENGTH_SHORT).show();
+                }
+                return true;
+            case R.id.activity_main_menu_load:
+                if (!JNIInterface.load(new File(getFilesDir(), MAP_FILE).getAbsolutePath())) {
+                    Toast.makeText(this, R.string.load_map_failed, Toast.LENGTH_SHORT).show();
+                }
+                return true;
         }
         return super.onOptionsItemSelected(item);
     }
@@ -23,12 +23,14 @@ import de.stetro.master.chisel.R;
 public class PLYExporter {
     private final Context context;
     private List<Vector3> mesh;
+    private int[] indices;
 
     private MaterialDialog dialog;
 
-    public PLYExporter(Context context, List<Vector3> mesh) {
+    public PLYExporter(Context context, List<Vector3> mesh, int[] indices) {
         this.context = context;
         this.mesh = mesh;
+        this.indices = indices;
 
         dialog = new MaterialDialog.Builder(context)
                 .title(R.string.calculating_mesh)
@@ -66,7 +68,7 @@ public class PLYExporter {
                 os.write("property float32 x\n".getBytes());
                 os.write("property float32 y\n".getBytes());
                 os.write("property float32 z\n".getBytes());
-                os.write(("element face " + (mesh.size() / 3) + "\n").getBytes());
+                os.write(("element face " + (indices.length / 3) + "\n").getBytes());
                 os.write("property list uint8 int32 vertex_index\n".getBytes());
                 os.write("end_header\n".getBytes());
 
@@ -79,8 +81,8 @@ public class PLYExporter {
                         dialog.setProgress(i / 2);
                     }
                 }
-                for (int i = 0; i < mesh.size() / 3; i++) {
-                    os.write(("3 " + i * 3 + " " + (i * 3 + 1) + " " + (i * 3 + 2) + "\n").getBytes());
+                for (int i = 0; i < indices.length / 3; i++) {
+                    os.write(("3 " + indices[i * 3] + " " + indices[i * 3 + 1] + " " + indices[i * 3 + 2] + "\n").getBytes());
                     if (i % 100 == 0) {
                         dialog.setProgress(size / 2 + i * 3);
                     }
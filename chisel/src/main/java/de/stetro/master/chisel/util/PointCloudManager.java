@@ -14,6 +14,7 @@ import org.rajawali3d.math.vector.Vector3;
 
 import java.nio.ByteBuffer;
 import java.nio.ByteOrder;
+import java.nio.FloatBuffer;
 
 
 public class PointCloudManager {
@@ -71,15 +72,13 @@ public class PointCloudManager {
         return newCloudTime != lastCloudTime;
     }
 
-    public synchronized float[] getPoints() {
-        float[] floats = new float[xyzIjData.xyzCount * 3];
-        xyzIjData.xyz.position(0);
-        for (int i = 0; i < xyzIjData.xyzCount; i++) {
-            floats[i * 3] = xyzIjData.xyz.get();
-            floats[i * 3 + 1] = xyzIjData.xyz.get();
-            floats[i * 3 + 2] = xyzIjData.xyz.get();
-        }
-        return floats;
+    // direct buffer of the latest cloud, only valid while holding this manager
+    public synchronized FloatBuffer getPoints() {
+        return xyzIjData.xyz;
+    }
+
+    public synchronized int getPointCount() {
+        return xyzIjData.xyzCount;
     }
 
     /*
@@ -6,6 +6,7 @@ PROJECT_ROOT := $(LOCAL_PATH)/$(PROJECT_ROOT_FROM_JNI)
 EIGEN_INCLUDE := $(LOCAL_PATH)/../../../../native-libraries/eigen
 CHISEL := $(LOCAL_PATH)/../../../../native-libraries/open_chisel
 BOOST:= $(LOCAL_PATH)/../../../../native-libraries/boost
+PROTOTYPE := $(LOCAL_PATH)/../../../../prototype/src/main/jni
 
 
 # Building Boost
@@ -20,10 +21,20 @@ include $(CLEAR_VARS)
 LOCAL_MODULE := chisel
 
 LOCAL_C_INCLUDES := $(EIGEN_INCLUDE) \
-                    $(CHISEL)/include
+                    $(CHISEL)/include \
+                    $(PROTOTYPE)
 
+# the prototype sources listed below must not use glm or tango-gl, only
+# chisel, Eigen and the standard library are available in this module
 LOCAL_SRC_FILES := jni_interface.cc \
                    chisel.cc \
+                   $(PROTOTYPE)/chunk_streamer.cc \
+                   $(PROTOTYPE)/mesh_decimator.cc \
+                   $(PROTOTYPE)/mesh_welder.cc \
+                   $(PROTOTYPE)/voxel_codec.cc \
+                   $(PROTOTYPE)/tsdf_map_file.cc \
+                   $(PROTOTYPE)/parallel_chisel.cc \
+                   $(PROTOTYPE)/worker_pool.cc \
                    $(CHISEL)/src/Chunk.cpp \
                    $(CHISEL)/src/ChunkManager.cpp \
                    $(CHISEL)/src/DistVoxel.cpp \
@@ -12,23 +12,56 @@
 
 #include <Eigen/Core>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+
+namespace {
+    // copies values from offset into a direct buffer, bounded by its capacity
+    template<typename T>
+    jint exportValues(JNIEnv *env, jobject buffer, jint offset, const std::vector<T> &values) {
+        void *address = env->GetDirectBufferAddress(buffer);
+        jlong capacity = env->GetDirectBufferCapacity(buffer);
+        if (address == NULL || capacity < 0) {
+            LOGE("Mesh export needs a direct buffer");
+            return -1;
+        }
+        if (offset < 0 || static_cast<size_t>(offset) >= values.size()) {
+            return 0;
+        }
+        size_t count = std::min(values.size() - offset,
+                                static_cast<size_t>(capacity) / sizeof(T));
+        std::memcpy(address, values.data() + offset, count * sizeof(T));
+        return count;
+    }
+}  // namespace
 
 namespace chisel {
 
-    void ChiselApplication::addPoints(JNIEnv *env, jfloatArray vertices,
+    void ChiselApplication::addPoints(JNIEnv *env, jobject vertices, jint vertexCount,
                                       jfloatArray transformation) {
-        // move jfloatArray vertices to Chisel PointCloud
+        // read the direct buffer in place, the cloud gets the only copy
+        const jfloat *verticesData = static_cast<const jfloat *>(
+                env->GetDirectBufferAddress(vertices));
+        jlong capacity = env->GetDirectBufferCapacity(vertices);
+        if (verticesData == NULL || capacity < 0) {
+            LOGE("Points need a direct buffer");
+            return;
+        }
+        vertexCount = static_cast<jint>(std::min(static_cast<jlong>(vertexCount), capacity / 3));
+        LOGI("got %d points from as pointcloud data", vertexCount);
         lastPointCloud->Clear();
-        int vertexCount = env->GetArrayLength(vertices) / 3;
-        LOGI("got %d points from as pointcloud data", vertexCount / 3);
-        jfloat *verticesData = env->GetFloatArrayElements(vertices, NULL);
+        Vec3List &points = lastPointCloud->GetMutablePoints();
+        points.resize(vertexCount);
         for (int i = 0; i < vertexCount; ++i) {
-            Vec3 vec3(verticesData[i * 3], verticesData[i * 3 + 1], verticesData[i * 3 + 2]);
-            lastPointCloud->AddPoint(vec3);
+            points[i] = Vec3::Map(verticesData + i * 3);
         }
 
         // move extrisics to a Eigen transformation
-        jfloat *transformationData = env->GetFloatArrayElements(transformation, NULL);
+        jfloat transformationData[16];
+        env->GetFloatArrayRegion(transformation, 0, 16, transformationData);
         Transform extrinsic = Transform();
         for (int j = 0; j < 4; ++j) {
             for (int k = 0; k < 4; ++k) {
@@ -41,7 +74,24 @@ namespace chisel {
         LOGD("%lf %lf %lf %lf", extrinsic(0, 2), extrinsic(1, 2), extrinsic(2, 2), extrinsic(3, 2));
         LOGD("%lf %lf %lf %lf", extrinsic(0, 3), extrinsic(1, 3), extrinsic(2, 3), extrinsic(3, 3));
 
-        chiselMap->IntegratePointCloud(
+        // the rays of the next point cloud reach every chunk up to rayTruncation
+        // behind the far clipping, those have to be in memory
+        std::vector<ChunkID> loaded;
+        std::vector<ChunkID> merged;
+        streamer.update(chiselMap->GetMutableChunkManager(), extrinsic.translation(),
+                        farClipping + rayTruncation + std::sqrt(3.0) * chunkSize * chunkResolution,
+                        &loaded, &merged);
+        for (const ChunkID &id : loaded) {
+            // chunks of an opened map have no mesh yet
+            if (chunkMeshes.find(id) == chunkMeshes.end()) {
+                chiselMap->remeshChunk(id);
+            }
+        }
+        for (const ChunkID &id : merged) {
+            chiselMap->remeshChunk(id);
+        }
+        chiselMap->integratePointCloud(
+                pool,
                 projectionIntegrator,
                 *lastPointCloud,
                 extrinsic,
@@ -51,37 +101,131 @@ namespace chisel {
 
     }
 
-    jfloatArray ChiselApplication::getMesh(JNIEnv * env) {
+    jint ChiselApplication::prepareMesh(JNIEnv * env) {
         LOGD("Getting Mesh ...");
-        MeshMap meshMap = chiselMap->GetChunkManager().GetAllMeshes();
-        LOGD("Map with %d items", meshMap.size());
-        int size = 0;
-        for (const std::pair <chisel::ChunkID, chisel::MeshPtr> &meshes : meshMap) {
-            size += meshes.second->vertices.size();
+        LOGD("Map with %d items", chunkMeshes.size());
+        // shared vertices are stored once, also across chunk borders
+        welder.clear();
+        meshIndices.clear();
+        bool decimate = decimator.getMaxError() > 0.0f;
+        for (const std::pair <chisel::ChunkID, chisel::MeshPtr> &meshes : chunkMeshes) {
+            addMesh(meshes.first, *meshes.second, decimate);
         }
-        jfloatArray array = env->NewFloatArray(size * 3);
-        float points[size * 3];
-        int i = 0;
-        for (const std::pair <chisel::ChunkID, chisel::MeshPtr> &meshes : meshMap) {
-            for (size_t &index: meshes.second->indices) {
-                points[i * 3] = meshes.second->vertices[index](0);
-                points[i * 3 + 1] = meshes.second->vertices[index](1);
-                points[i * 3 + 2] = meshes.second->vertices[index](2);
-                i++;
+        const std::vector<float> &vertices = welder.getVertices();
+        LOGD("Mesh with %d vertices and %d triangles", vertices.size() / 3,
+             meshIndices.size() / 3);
+        return vertices.size();
+    }
+
+    jint ChiselApplication::getMeshIndexCount(JNIEnv * env) {
+        return meshIndices.size();
+    }
+
+    jint ChiselApplication::exportMeshVertices(JNIEnv * env, jobject buffer, jint offset) {
+        return exportValues(env, buffer, offset, welder.getVertices());
+    }
+
+    jint ChiselApplication::exportMeshIndices(JNIEnv * env, jobject buffer, jint offset) {
+        return exportValues(env, buffer, offset, meshIndices);
+    }
+
+    void ChiselApplication::addMesh(const ChunkID &id, const Mesh &mesh, bool decimate) {
+        if (decimate) {
+            // chunks are decimated on their own, their borders stay untouched
+            const DecimatedMesh &decimated = getDecimatedMesh(id, mesh);
+            for (const uint32_t &index : decimated.indices) {
+                meshIndices.push_back(welder.add(decimated.vertices[index * 3],
+                                                 decimated.vertices[index * 3 + 1],
+                                                 decimated.vertices[index * 3 + 2]));
+            }
+        } else {
+            for (const size_t &index : mesh.indices) {
+                const Vec3 &vertex = mesh.vertices[index];
+                meshIndices.push_back(welder.add(vertex(0), vertex(1), vertex(2)));
             }
         }
-        env->SetFloatArrayRegion(array, 0, size * 3, points);
+    }
 
-        return array;
+    const ChiselApplication::DecimatedMesh &ChiselApplication::getDecimatedMesh(
+            const ChunkID &id, const Mesh &mesh) {
+        DecimatedMesh &decimated = decimatedMeshes[id];
+        float maxError = decimator.getMaxError();
+        if (decimated.maxError != maxError || decimated.indices.empty()) {
+            decimated.maxError = maxError;
+            decimated.vertices.clear();
+            for (const Vec3 &vertex : mesh.vertices) {
+                decimated.vertices.push_back(vertex(0));
+                decimated.vertices.push_back(vertex(1));
+                decimated.vertices.push_back(vertex(2));
+            }
+            decimated.indices.assign(mesh.indices.begin(), mesh.indices.end());
+            std::vector<float> colors;
+            decimator.decimate(decimated.vertices, decimated.indices, colors);
+        }
+        return decimated;
     }
 
     void ChiselApplication::update(JNIEnv * env) {
+        // decimations of the remeshed chunks are outdated
+        std::vector<ChunkID> remeshed;
+        for (const std::pair <chisel::ChunkID, bool> &chunk : chiselMap->GetMeshesToUpdate()) {
+            decimatedMeshes.erase(chunk.first);
+            remeshed.push_back(chunk.first);
+        }
         chiselMap->UpdateMeshes();
+
+        // evicted chunks were not remeshed and keep their last mesh
+        const ChunkManager &chunks = chiselMap->GetChunkManager();
+        const MeshMap &meshMap = chunks.GetAllMeshes();
+        for (const ChunkID &id : remeshed) {
+            if (!chunks.HasChunk(id)) {
+                continue;
+            }
+            MeshMap::const_iterator mesh = meshMap.find(id);
+            if (mesh != meshMap.end()) {
+                chunkMeshes[id] = mesh->second;
+            } else {
+                chunkMeshes.erase(id);
+            }
+        }
+    }
+
+    void ChiselApplication::setDecimation(JNIEnv * env, jfloat maxError) {
+        decimator.setMaxError(maxError);
+    }
+
+    void ChiselApplication::setStreaming(JNIEnv * env, jstring directory, jint budgetMegabytes) {
+        const char *path = env->GetStringUTFChars(directory, NULL);
+        streamer.setDirectory(path);
+        env->ReleaseStringUTFChars(directory, path);
+        streamer.setBudget(static_cast<size_t>(std::max(budgetMegabytes, 0)) * 1024 * 1024);
+    }
+
+    jboolean ChiselApplication::save(JNIEnv * env, jstring path) {
+        const char *file = env->GetStringUTFChars(path, NULL);
+        std::string target(file);
+        env->ReleaseStringUTFChars(path, file);
+
+        // evicted chunks and the chunks of an opened map are written as well
+        return streamer.save(chiselMap->GetChunkManager(), target) ? JNI_TRUE : JNI_FALSE;
+    }
+
+    jboolean ChiselApplication::load(JNIEnv * env, jstring path) {
+        clear(env);
+        const char *file = env->GetStringUTFChars(path, NULL);
+        bool opened = streamer.open(chiselMap->GetChunkManager(), file);
+        env->ReleaseStringUTFChars(path, file);
+        return opened ? JNI_TRUE : JNI_FALSE;
     }
 
     void ChiselApplication::clear(JNIEnv * env) {
-        chiselMap.reset(new chisel::Chisel(Eigen::Vector3i(chunkSize, chunkSize, chunkSize),
-                                           chunkResolution, false));
+        streamer.clear();
+        decimatedMeshes.clear();
+        chunkMeshes.clear();
+        welder.clear();
+        meshIndices.clear();
+        chiselMap.reset(new tango_augmented_reality::ParallelChisel(
+                Eigen::Vector3i(chunkSize, chunkSize, chunkSize), chunkResolution, false));
     }
 
     ChiselApplication::ChiselApplication() {
@@ -100,9 +244,9 @@ namespace chisel {
         farClipping = 2.0;
         rayTruncation = 0.5;
 
-        chiselMap = chisel::ChiselPtr(
-                new chisel::Chisel(Eigen::Vector3i(chunkSize, chunkSize, chunkSize),
-                                   chunkResolution, false));
+        chiselMap = tango_augmented_reality::ParallelChiselPtr(
+                new tango_augmented_reality::ParallelChisel(
+                        Eigen::Vector3i(chunkSize, chunkSize, chunkSize), chunkResolution, false));
 
         TruncatorPtr truncator(new ConstantTruncator(truncationDistScale));
 
@@ -113,6 +257,7 @@ namespace chisel {
         projectionIntegrator = ProjectionIntegrator(truncator, weighter, carvingDistance,
                                                     enableCarving, centroids);
         projectionIntegrator.SetCentroids(chiselMap->GetChunkManager().GetCentroids());
+        streamer.setWeightStep(weighting);
         LOGI("ChiselApplication was created in native environment");
     }
 
@@ -19,6 +19,14 @@
 #include <open_chisel/pointcloud/PointCloud.h>
 #include <open_chisel/ProjectionIntegrator.h>
 
+#include <unordered_map>
+#include <vector>
+
+#include <tango-augmented-reality/chunk_streamer.h>
+#include <tango-augmented-reality/mesh_decimator.h>
+#include <tango-augmented-reality/mesh_welder.h>
+#include <tango-augmented-reality/parallel_chisel.h>
+
 
 
 namespace chisel {
@@ -30,18 +38,75 @@ namespace chisel {
         ~ChiselApplication();
 
         // JNI Interface
-        void addPoints(JNIEnv *env, jfloatArray vertices, jfloatArray transformation);
+        // vertices is a direct FloatBuffer with vertexCount xyz triples
+        void addPoints(JNIEnv *env, jobject vertices, jint vertexCount, jfloatArray transformation);
+
+        // welds the meshes of all chunks across the chunk borders for the
+        // export, returns the count of vertex floats
+        jint prepareMesh(JNIEnv *env);
+
+        // count of triangle indices of the prepared mesh
+        jint getMeshIndexCount(JNIEnv *env);
 
-        jfloatArray getMesh(JNIEnv *env);
+        // copy the prepared vertex floats or indices from offset into a direct
+        // byte buffer in native order, as many as it has room for. Large meshes
+        // are exported in several calls with a bounded buffer. Returns the count
+        // of copied values or -1 if the buffer is not direct.
+        jint exportMeshVertices(JNIEnv *env, jobject buffer, jint offset);
+
+        jint exportMeshIndices(JNIEnv *env, jobject buffer, jint offset);
 
         void clear(JNIEnv *env);
 
         void update(JNIEnv *env);
 
-        chisel::ChiselPtr chiselMap;
+        // decimates the chunk meshes of prepareMesh, 0 disables it
+        void setDecimation(JNIEnv *env, jfloat maxError);
+
+        // moves chunks far away from the camera into a map in directory once the
+        // float voxels take more than budgetMegabytes, see ChunkStreamer
+        void setStreaming(JNIEnv *env, jstring directory, jint budgetMegabytes);
+
+        // writes all chunks into a map file
+        jboolean save(JNIEnv *env, jstring path);
+
+        // clears the TSDF and opens a map file, its chunks are loaded as soon
+        // as the camera comes close
+        jboolean load(JNIEnv *env, jstring path);
+
+        tango_augmented_reality::ParallelChiselPtr chiselMap;
         chisel::PointCloudPtr lastPointCloud = chisel::PointCloudPtr(new PointCloud());
         chisel::ProjectionIntegrator projectionIntegrator;
     protected:
+        // chunk mesh reduced with the error bound it was decimated with
+        struct DecimatedMesh {
+            float maxError;
+            std::vector<float> vertices;
+            std::vector<uint32_t> indices;
+        };
+
+        // returns the cached decimation of a chunk, redone for a new error bound
+        const DecimatedMesh &getDecimatedMesh(const ChunkID &id, const Mesh &mesh);
+
+        // welds the triangles of a chunk mesh into the prepared mesh
+        void addMesh(const ChunkID &id, const Mesh &mesh, bool decimate);
+
+        // integrates the chunks of a point cloud on all cores
+        tango_augmented_reality::WorkerPool pool;
+
+        tango_augmented_reality::MeshDecimator decimator;
+        // decimated chunks, entries of remeshed chunks are dropped by update
+        std::unordered_map<ChunkID, DecimatedMesh, ChunkHasher> decimatedMeshes;
+
+        tango_augmented_reality::MeshWelder welder;
+        std::vector<uint32_t> meshIndices;
+
+        // evicts distant chunks and loads the chunks of an opened map
+        tango_augmented_reality::ChunkStreamer streamer;
+        // meshes of all chunks, evicted chunks drop theirs from the TSDF but
+        // prepareMesh keeps exporting them
+        MeshMap chunkMeshes;
+
         double truncationDistConst;
         double truncationDistLinear;
         double truncationDistQuad;
@@ -36,16 +36,59 @@ Java_de_stetro_master_chisel_JNIInterface_update(JNIEnv* env, jobject /*obj*/) {
 chiselApplication.update(env);
 }
 
-JNIEXPORT jfloatArray JNICALL
-Java_de_stetro_master_chisel_JNIInterface_getMesh(
+JNIEXPORT void JNICALL
+Java_de_stetro_master_chisel_JNIInterface_setDecimation(
+        JNIEnv* env, jobject /*obj*/, jfloat maxError) {
+    chiselApplication.setDecimation(env, maxError);
+}
+
+JNIEXPORT void JNICALL
+Java_de_stetro_master_chisel_JNIInterface_setStreaming(
+        JNIEnv* env, jobject /*obj*/, jstring directory, jint budgetMegabytes) {
+    chiselApplication.setStreaming(env, directory, budgetMegabytes);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_de_stetro_master_chisel_JNIInterface_save(
+        JNIEnv* env, jobject /*obj*/, jstring path) {
+    return chiselApplication.save(env, path);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_de_stetro_master_chisel_JNIInterface_load(
+        JNIEnv* env, jobject /*obj*/, jstring path) {
+    return chiselApplication.load(env, path);
+}
+
+JNIEXPORT jint JNICALL
+Java_de_stetro_master_chisel_JNIInterface_prepareMesh(
+        JNIEnv* env, jobject /*obj*/) {
+    return chiselApplication.prepareMesh(env);
+}
+
+JNIEXPORT jint JNICALL
+Java_de_stetro_master_chisel_JNIInterface_getMeshIndexCount(
         JNIEnv* env, jobject /*obj*/) {
-    return chiselApplication.getMesh(env);
+    return chiselApplication.getMeshIndexCount(env);
+}
+
+JNIEXPORT jint JNICALL
+Java_de_stetro_master_chisel_JNIInterface_exportMeshVertices(
+        JNIEnv* env, jobject /*obj*/, jobject buffer, jint offset) {
+    return chiselApplication.exportMeshVertices(env, buffer, offset);
+}
+
+JNIEXPORT jint JNICALL
+Java_de_stetro_master_chisel_JNIInterface_exportMeshIndices(
+        JNIEnv* env, jobject /*obj*/, jobject buffer, jint offset) {
+    return chiselApplication.exportMeshIndices(env, buffer, offset);
 }
 
 JNIEXPORT void JNICALL
 Java_de_stetro_master_chisel_JNIInterface_addPoints(
-        JNIEnv* env, jobject /*obj*/, jfloatArray vertices, jfloatArray transformation) {
-chiselApplication.addPoints(env, vertices, transformation);
+        JNIEnv* env, jobject /*obj*/, jobject vertices, jint vertexCount,
+        jfloatArray transformation) {
+chiselApplication.addPoints(env, vertices, vertexCount, transformation);
 }
 
 #ifdef __cplusplus
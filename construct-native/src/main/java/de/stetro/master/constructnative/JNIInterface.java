@@ -18,6 +18,8 @@ package de.stetro.master.constructnative;
 
 import android.app.Activity;
 
+import java.nio.FloatBuffer;
+
 /**
  * Interfaces between native C++ code and Java code.
  */
@@ -26,8 +28,9 @@ public class JNIInterface {
         System.loadLibrary("constructnative");
     }
 
-    public static native float[] reconstructWithGreedy(float[] vertices);
+    // vertices are count xyz triples in a direct buffer, read in place
+    public static native float[] reconstructWithGreedy(FloatBuffer vertices, int count);
 
-    public static native float[] reconstructPiecewisePlanes(float[] vertices);
+    public static native float[] reconstructPiecewisePlanes(FloatBuffer vertices, int count);
 
 }
@@ -9,6 +9,9 @@ import org.poly2tri.triangulation.point.TPoint;
 import org.poly2tri.triangulation.sets.PointSet;
 import org.rajawali3d.math.vector.Vector3;
 
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.FloatBuffer;
 import java.util.ArrayList;
 import java.util.List;
 import java.util.Stack;
@@ -35,6 +38,8 @@ public class MeshTree extends OctTree {
     private List<Vector3> newPoints;
     private int generatorDepth;
     private List<Vector3> patches;
+    // direct buffer handed to the native reconstruction, reused across calls
+    private FloatBuffer patchPoints;
 
     public MeshTree(Vector3 position, double range, int depth, int generatorDepth) {
         super(position, range, depth);
@@ -284,14 +289,17 @@ public class MeshTree extends OctTree {
         if (boundaries.size() < 3) {
             return;
         }
-        float[] points = new float[boundaries.size() * 3];
-        for (int i = 0; i < boundaries.size(); i++) {
-            Vector3 vector3 = boundaries.get(i);
-            points[i * 3] = (float) vector3.x;
-            points[i * 3 + 1] = (float) vector3.y;
-            points[i * 3 + 2] = (float) vector3.z;
+        if (patchPoints == null || patchPoints.capacity() < boundaries.size() * 3) {
+            patchPoints = ByteBuffer.allocateDirect(boundaries.size() * 3 * 4)
+                    .order(ByteOrder.nativeOrder()).asFloatBuffer();
         }
-        float[] floats = JNIInterface.reconstructWithGreedy(points);
+        patchPoints.clear();
+        for (Vector3 vector3 : boundaries) {
+            patchPoints.put((float) vector3.x);
+            patchPoints.put((float) vector3.y);
+            patchPoints.put((float) vector3.z);
+        }
+        float[] floats = JNIInterface.reconstructWithGreedy(patchPoints, boundaries.size());
         if (patches == null) {
             patches = new ArrayList<>();
         } else {
@@ -78,18 +78,25 @@ namespace constructnative {
         return triangles;
     }
 
-    int verticesToPointCloud(jfloatArray vertices,
+    int verticesToPointCloud(jobject vertices, jint vertexCount,
                              const pcl::PointCloud<pcl::PointXYZ>::Ptr cloud, JNIEnv *env) {
-        int vertexCount = env->GetArrayLength(vertices) / 3;
-        jfloat *verticesData = env->GetFloatArrayElements(vertices, NULL);
-        cloud->points.resize(vertexCount);
-        for (int i = 0; i < vertexCount; ++i) {
-            pcl::PointXYZ point;
-            point.x = verticesData[i * 3];
-            point.y = verticesData[i * 3 + 1];
-            point.z = verticesData[i * 3 + 2];
-            cloud->points[i] = point;
+        // the direct buffer is read in place and copied once into the cloud
+        const jfloat *verticesData = static_cast<const jfloat *>(
+                env->GetDirectBufferAddress(vertices));
+        jlong capacity = env->GetDirectBufferCapacity(vertices);
+        if (verticesData == NULL || capacity < 0) {
+            LOGE("Vertices need a direct buffer");
+            return 0;
+        }
+        if (vertexCount > capacity / 3) {
+            vertexCount = capacity / 3;
         }
+        cloud->points.resize(vertexCount);
+        cloud->width = vertexCount;
+        cloud->height = 1;
+        // xyz of the padded pcl points as one strided matrix
+        cloud->getMatrixXfMap(3, 4, 0) =
+                Eigen::Map<const Eigen::MatrixXf>(verticesData, 3, vertexCount);
         return vertexCount;
     }
 
@@ -115,11 +122,11 @@ namespace constructnative {
         return array;
     }
 
-    jfloatArray GreedyApplication::reconstruct(JNIEnv *env, jfloatArray vertices) {
+    jfloatArray GreedyApplication::reconstruct(JNIEnv *env, jobject vertices, jint vertexCount) {
 
-        // transform jfloatArray vertices to pcl::PointCloud
+        // transform direct buffer vertices to pcl::PointCloud
         pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud <pcl::PointXYZ>);
-        verticesToPointCloud(vertices, cloud, env);
+        verticesToPointCloud(vertices, vertexCount, cloud, env);
         LOGE("PointCloud has %d points", cloud->points.size());
 
         // filter with voxel grid
@@ -149,11 +156,11 @@ namespace constructnative {
     }
 
 
-    jfloatArray PlaneApplication::reconstruct(JNIEnv *env, jfloatArray vertices) {
+    jfloatArray PlaneApplication::reconstruct(JNIEnv *env, jobject vertices, jint vertexCount) {
 
-        // transform jfloatArray vertices to pcl::PointCloud
+        // transform direct buffer vertices to pcl::PointCloud
         pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud <pcl::PointXYZ>);
-        verticesToPointCloud(vertices, cloud, env);
+        verticesToPointCloud(vertices, vertexCount, cloud, env);
         LOGE("PointCloud has %d points", cloud->points.size());
 
         // RANSAC Segmentation
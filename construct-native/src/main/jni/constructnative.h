@@ -24,7 +24,8 @@ namespace constructnative {
 
         ~GreedyApplication();
 
-        jfloatArray reconstruct(JNIEnv *env, jfloatArray vertices);
+        // vertices is a direct FloatBuffer with vertexCount xyz triples
+        jfloatArray reconstruct(JNIEnv *env, jobject vertices, jint vertexCount);
 
     };
 
@@ -34,7 +35,8 @@ namespace constructnative {
 
         ~PlaneApplication();
 
-        jfloatArray reconstruct(JNIEnv *env, jfloatArray vertices);
+        // vertices is a direct FloatBuffer with vertexCount xyz triples
+        jfloatArray reconstruct(JNIEnv *env, jobject vertices, jint vertexCount);
 
     };
 }
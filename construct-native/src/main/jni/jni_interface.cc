@@ -27,14 +27,14 @@ extern "C" {
 
 JNIEXPORT jfloatArray JNICALL
 Java_de_stetro_master_constructnative_JNIInterface_reconstructWithGreedy(
-    JNIEnv* env, jobject /*obj*/, jfloatArray vertices) {
-  return greedyApp.reconstruct(env, vertices);
+    JNIEnv* env, jobject /*obj*/, jobject vertices, jint vertexCount) {
+  return greedyApp.reconstruct(env, vertices, vertexCount);
 }
 
 JNIEXPORT jfloatArray JNICALL
 Java_de_stetro_master_constructnative_JNIInterface_reconstructPiecewisePlanes(
-        JNIEnv* env, jobject /*obj*/, jfloatArray vertices) {
-    return planeApp.reconstruct(env, vertices);
+        JNIEnv* env, jobject /*obj*/, jobject vertices, jint vertexCount) {
+    return planeApp.reconstruct(env, vertices, vertexCount);
 }
 
 #ifdef __cplusplus
@@ -0,0 +1,96 @@
+// Replays a recorded depth session for the TSDF parameter grid of the app and
+// writes the results as comma separated values, next to the session unless a
+// path is given. Sessions do not store the intrinsics, the depth camera of the
+// Tango development kit is assumed.
+//
+//   chisel_sweep session [csv] [depth_image|point_cloud]
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "tango-augmented-reality/chisel_benchmark.h"
+
+using tango_augmented_reality::ChiselBenchmark;
+using tango_augmented_reality::ChiselSweepResult;
+using tango_augmented_reality::DepthRasterizer;
+using tango_augmented_reality::DepthSession;
+using tango_augmented_reality::DepthSessionFrame;
+using tango_augmented_reality::IntegrationMode;
+using tango_augmented_reality::ParallelChisel;
+using tango_augmented_reality::WorkerPool;
+
+namespace {
+    // TSDF and camera of ChiselMesh
+    const int kChunkSize = 8;
+    const float kResolution = 0.04f;
+    const float kTruncationScale = 8.0f;
+    const float kWeighting = 0.5f;
+    const float kCarvingDistance = 0.3f;
+    const float kRayTruncation = 0.5f;
+    const float kNear = 0.1f;
+    const float kFar = 2.0f;
+
+    // depth camera of the Tango development kit
+    const int kWidth = 320;
+    const int kHeight = 180;
+    const float kFocal = 260.0f;
+
+    chisel::PinholeCamera createCamera() {
+        chisel::Intrinsics intrinsics;
+        intrinsics.SetFx(kFocal);
+        intrinsics.SetFy(kFocal);
+        intrinsics.SetCx(kWidth * 0.5f);
+        intrinsics.SetCy(kHeight * 0.5f);
+        chisel::PinholeCamera camera;
+        camera.SetIntrinsics(intrinsics);
+        camera.SetWidth(kWidth);
+        camera.SetHeight(kHeight);
+        camera.SetNearPlane(kNear);
+        camera.SetFarPlane(kFar);
+        return camera;
+    }
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s session [csv] [depth_image|point_cloud]\n", argv[0]);
+        return 2;
+    }
+    std::string session = argv[1];
+    std::string csv = argc > 2 ? argv[2] : session + ".csv";
+    IntegrationMode mode = tango_augmented_reality::DEPTH_IMAGE;
+    if (argc > 3 && std::strcmp(argv[3], "point_cloud") == 0) {
+        mode = tango_augmented_reality::POINT_CLOUD;
+    } else if (argc > 3 && std::strcmp(argv[3], "depth_image") != 0) {
+        std::fprintf(stderr, "unknown integration mode %s\n", argv[3]);
+        return 2;
+    }
+
+    std::vector <DepthSessionFrame> frames;
+    if (!DepthSession::load(session, frames) || frames.empty()) {
+        std::fprintf(stderr, "could not read depth frames from %s\n", session.c_str());
+        return 1;
+    }
+
+    WorkerPool pool;
+    ParallelChisel map(Eigen::Vector3i(kChunkSize, kChunkSize, kChunkSize), kResolution, false);
+    DepthRasterizer rasterizer;
+    rasterizer.setIntrinsics(kFocal, kFocal, kWidth * 0.5f, kHeight * 0.5f, kWidth, kHeight);
+    ChiselBenchmark benchmark(pool, map,
+                              map.createIntegrator(kTruncationScale, kWeighting,
+                                                   kCarvingDistance),
+                              createCamera(), rasterizer, kRayTruncation);
+
+    std::vector <ChiselSweepResult> results;
+    benchmark.sweep(frames, ChiselBenchmark::grid(kWeighting), mode, results);
+    for (const ChiselSweepResult &result : results) {
+        std::printf("%s\n", ChiselBenchmark::describe(result).c_str());
+    }
+    if (!ChiselBenchmark::write(csv, results)) {
+        std::fprintf(stderr, "could not write %s\n", csv.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,62 @@
+// Times DepthRasterizer on a synthetic depth frame of the size Tango
+// delivers, with the vectorized and the scalar projection.
+//
+//   depth_rasterizer_benchmark [points] [frames]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "tango-augmented-reality/depth_rasterizer.h"
+
+using tango_augmented_reality::DepthRasterizer;
+
+namespace {
+    // depth camera of the Tango development kit
+    const int kWidth = 320;
+    const int kHeight = 180;
+    const float kFocal = 260.0f;
+
+    double millisecondsPerFrame(DepthRasterizer &rasterizer, const std::vector <float> &xyz,
+                                std::vector <float> &depth, int frames) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; ++i) {
+            rasterizer.rasterize(xyz.data(), xyz.size() / 3, depth.data());
+        }
+        std::chrono::duration<double, std::milli> elapsed =
+                std::chrono::steady_clock::now() - start;
+        return elapsed.count() / frames;
+    }
+}  // namespace
+
+int main(int argc, char **argv) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 12000;
+    int frames = argc > 2 ? std::atoi(argv[2]) : 1000;
+
+    std::srand(1);
+    std::vector <float> xyz(count * 3);
+    for (int i = 0; i < count; ++i) {
+        float z = 0.5f + 3.5f * std::rand() / RAND_MAX;
+        float u = static_cast<float>(std::rand()) / RAND_MAX * kWidth;
+        float v = static_cast<float>(std::rand()) / RAND_MAX * kHeight;
+        xyz[i * 3] = (u - kWidth * 0.5f) * z / kFocal;
+        xyz[i * 3 + 1] = (v - kHeight * 0.5f) * z / kFocal;
+        xyz[i * 3 + 2] = z;
+    }
+
+    DepthRasterizer rasterizer;
+    rasterizer.setIntrinsics(kFocal, kFocal, kWidth * 0.5f, kHeight * 0.5f, kWidth, kHeight);
+    std::vector <float> depth(kWidth * kHeight);
+
+    for (int dilation = 0; dilation < 2; ++dilation) {
+        rasterizer.setDilation(dilation != 0);
+        for (int vectorized = 1; vectorized >= 0; --vectorized) {
+            rasterizer.setVectorized(vectorized != 0);
+            std::printf("%d points, %dx%d, dilation %s, %s: %.3f ms\n", count, kWidth, kHeight,
+                        dilation ? "on" : "off", vectorized ? "vectorized" : "scalar",
+                        millisecondsPerFrame(rasterizer, xyz, depth, frames));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,20 @@
+
+#ifndef TANGO_AUGMENTED_REALITY_TEST_CHECK_H_
+#define TANGO_AUGMENTED_REALITY_TEST_CHECK_H_
+
+#include <cstdio>
+#include <cstdlib>
+
+// minimal checks for the host tests, a failed check ends the test with a
+// non zero exit code, independent of NDEBUG
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            std::exit(1); \
+        } \
+    } while (0)
+
+#define CHECK_EQ(expected, actual) CHECK((expected) == (actual))
+
+#endif  // TANGO_AUGMENTED_REALITY_TEST_CHECK_H_
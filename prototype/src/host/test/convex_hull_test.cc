@@ -0,0 +1,128 @@
+#include "tango-augmented-reality/convex_hull.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "check.h"
+
+using tango_augmented_reality::ConvexHull;
+
+namespace {
+    float random(float min, float max) {
+        return min + (max - min) * std::rand() / RAND_MAX;
+    }
+
+    bool lexicographic(const glm::vec2 &a, const glm::vec2 &b) {
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
+    }
+
+    // std::sort and the monotone chain, as the hull was computed before the
+    // prefilter and the radix sort
+    std::vector <glm::vec2> referenceHull(std::vector <glm::vec2> points) {
+        ConvexHull hull;
+        std::sort(points.begin(), points.end(), lexicographic);
+        int n = points.size(), k = 0;
+        std::vector <glm::vec2> result(2 * n);
+        for (int i = 0; i < n; ++i) {
+            while (k >= 2 && hull.isLeft(result[k - 2], result[k - 1], points[i]) <= 0) k--;
+            result[k++] = points[i];
+        }
+        for (int i = n - 2, t = k + 1; i >= 0; i--) {
+            while (k >= t && hull.isLeft(result[k - 2], result[k - 1], points[i]) <= 0) k--;
+            result[k++] = points[i];
+        }
+        result.resize(k);
+        return result;
+    }
+
+    void checkHull(ConvexHull &hull, const std::vector <glm::vec2> &points) {
+        std::vector <glm::vec2> expected = referenceHull(points);
+        std::vector <glm::vec2> actual = hull.generateConvexHull(points);
+        CHECK_EQ(expected.size(), actual.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            CHECK_EQ(expected[i].x, actual[i].x);
+            CHECK_EQ(expected[i].y, actual[i].y);
+        }
+    }
+
+    void testRandomPoints() {
+        ConvexHull hull;
+        std::srand(13);
+        const int kSizes[] = {10, 63, 64, 65, 200, 1000, 20000};
+        for (int size : kSizes) {
+            std::vector <glm::vec2> square;
+            std::vector <glm::vec2> disk;
+            std::vector <glm::vec2> offset;
+            for (int i = 0; i < size; ++i) {
+                square.push_back(glm::vec2(random(-2.0f, 2.0f), random(-1.0f, 3.0f)));
+                float angle = random(0.0f, 6.2831853f);
+                float radius = std::sqrt(random(0.0f, 1.0f));
+                disk.push_back(glm::vec2(radius * std::cos(angle), radius * std::sin(angle)));
+                // far from the origin with a tiny extent, quantization cells
+                // hold many points
+                offset.push_back(glm::vec2(1000.0f + random(0.0f, 0.01f),
+                                           -500.0f + random(0.0f, 0.001f)));
+            }
+            checkHull(hull, square);
+            checkHull(hull, disk);
+            checkHull(hull, offset);
+        }
+    }
+
+    void testCollinearPoints() {
+        ConvexHull hull;
+        std::srand(17);
+        std::vector <glm::vec2> diagonal;
+        std::vector <glm::vec2> horizontal;
+        std::vector <glm::vec2> vertical;
+        for (int i = 0; i < 300; ++i) {
+            float t = static_cast<float>(std::rand() % 1000);
+            diagonal.push_back(glm::vec2(t, 2.0f * t));
+            horizontal.push_back(glm::vec2(t, 5.0f));
+            vertical.push_back(glm::vec2(-3.0f, t));
+        }
+        checkHull(hull, diagonal);
+        checkHull(hull, horizontal);
+        checkHull(hull, vertical);
+
+        // a grid has collinear points along every hull edge
+        std::vector <glm::vec2> grid;
+        for (int x = 0; x < 20; ++x) {
+            for (int y = 0; y < 15; ++y) {
+                grid.push_back(glm::vec2(x * 0.25f, y * 0.5f));
+            }
+        }
+        checkHull(hull, grid);
+    }
+
+    void testDuplicatePoints() {
+        ConvexHull hull;
+        std::srand(19);
+        std::vector <glm::vec2> corners;
+        for (int i = 0; i < 400; ++i) {
+            corners.push_back(glm::vec2(i % 2 ? 1.0f : -1.0f, i % 4 < 2 ? 1.0f : -1.0f));
+        }
+        checkHull(hull, corners);
+
+        std::vector <glm::vec2> same(100, glm::vec2(0.5f, -0.5f));
+        checkHull(hull, same);
+
+        // random points with every point repeated
+        std::vector <glm::vec2> repeated;
+        for (int i = 0; i < 150; ++i) {
+            glm::vec2 point(random(0.0f, 1.0f), random(0.0f, 1.0f));
+            repeated.push_back(point);
+            repeated.push_back(point);
+            repeated.push_back(point);
+        }
+        checkHull(hull, repeated);
+    }
+}  // namespace
+
+int main() {
+    testRandomPoints();
+    testCollinearPoints();
+    testDuplicatePoints();
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include "tango-augmented-reality/depth_rasterizer.h"
+
+#include <cstdlib>
+#include <vector>
+
+#include "check.h"
+
+using tango_augmented_reality::DepthRasterizer;
+
+namespace {
+    const int kWidth = 100;
+    const int kHeight = 80;
+    const float kFocal = 100.0f;
+    const float kCx = 50.0f;
+    const float kCy = 40.0f;
+
+    // value behind the image which must never be written
+    const float kGuard = -1.0f;
+
+    // appends a point which projects onto the center of pixel (u, v)
+    void addPoint(std::vector <float> &xyz, float u, float v, float z) {
+        xyz.push_back((u - kCx) * z / kFocal);
+        xyz.push_back((v - kCy) * z / kFocal);
+        xyz.push_back(z);
+    }
+
+    std::vector <float> rasterize(DepthRasterizer &rasterizer, const std::vector <float> &xyz) {
+        std::vector <float> depth(kWidth * kHeight + kWidth, kGuard);
+        rasterizer.rasterize(xyz.data(), xyz.size() / 3, depth.data());
+        for (size_t i = kWidth * kHeight; i < depth.size(); ++i) {
+            CHECK_EQ(kGuard, depth[i]);
+        }
+        depth.resize(kWidth * kHeight);
+        return depth;
+    }
+
+    float at(const std::vector <float> &depth, int u, int v) {
+        return depth[v * kWidth + u];
+    }
+
+    void setUp(DepthRasterizer &rasterizer) {
+        rasterizer.setIntrinsics(kFocal, kFocal, kCx, kCy, kWidth, kHeight);
+        rasterizer.setDilation(false);
+    }
+
+    void testClosestPointWins() {
+        DepthRasterizer rasterizer;
+        setUp(rasterizer);
+        for (int order = 0; order < 2; ++order) {
+            std::vector <float> xyz;
+            addPoint(xyz, 20, 20, order == 0 ? 1.0f : 2.0f);
+            addPoint(xyz, 20, 20, order == 0 ? 2.0f : 1.0f);
+            // splats of a far point overlap the near one by one pixel
+            addPoint(xyz, 21, 21, 3.0f);
+            std::vector <float> depth = rasterize(rasterizer, xyz);
+            CHECK_EQ(1.0f, at(depth, 20, 20));
+            CHECK_EQ(1.0f, at(depth, 21, 20));
+            CHECK_EQ(1.0f, at(depth, 21, 21));
+            CHECK_EQ(3.0f, at(depth, 22, 22));
+            CHECK_EQ(0.0f, at(depth, 19, 20));
+        }
+    }
+
+    void testSplatsAreClipped() {
+        DepthRasterizer rasterizer;
+        setUp(rasterizer);
+        std::vector <float> xyz;
+        addPoint(xyz, kWidth - 1, kHeight - 1, 1.0f);
+        addPoint(xyz, kWidth - 1, 10, 1.5f);
+        addPoint(xyz, 10, kHeight - 1, 2.0f);
+        // outside of the image or behind the camera
+        addPoint(xyz, kWidth, 10, 1.0f);
+        addPoint(xyz, -1, 10, 1.0f);
+        addPoint(xyz, 10, kHeight, 1.0f);
+        xyz.push_back(0.0f);
+        xyz.push_back(0.0f);
+        xyz.push_back(-1.0f);
+        std::vector <float> depth = rasterize(rasterizer, xyz);
+
+        CHECK_EQ(1.0f, at(depth, kWidth - 1, kHeight - 1));
+        CHECK_EQ(1.5f, at(depth, kWidth - 1, 11));
+        CHECK_EQ(2.0f, at(depth, 11, kHeight - 1));
+        int written = 0;
+        for (size_t i = 0; i < depth.size(); ++i) {
+            written += depth[i] != 0.0f;
+        }
+        // one clipped corner pixel and two half splats
+        CHECK_EQ(5, written);
+    }
+
+    void testDilation() {
+        DepthRasterizer rasterizer;
+        setUp(rasterizer);
+        std::vector <float> xyz;
+        addPoint(xyz, 10, 10, 1.0f);
+        addPoint(xyz, 13, 10, 2.0f);
+
+        std::vector <float> sparse = rasterize(rasterizer, xyz);
+        CHECK_EQ(0.0f, at(sparse, 12, 10));
+
+        rasterizer.setDilation(true);
+        std::vector <float> dense = rasterize(rasterizer, xyz);
+        // holes take the closest neighbour
+        CHECK_EQ(1.0f, at(dense, 12, 10));
+        CHECK_EQ(1.0f, at(dense, 12, 11));
+        CHECK_EQ(1.0f, at(dense, 12, 9));
+        CHECK_EQ(2.0f, at(dense, 15, 10));
+        // filled holes do not spread any further
+        CHECK_EQ(0.0f, at(dense, 12, 8));
+        CHECK_EQ(0.0f, at(dense, 16, 10));
+        CHECK_EQ(0.0f, at(dense, 50, 50));
+        // existing depth is kept
+        CHECK_EQ(2.0f, at(dense, 13, 10));
+    }
+
+    void testVectorizedMatchesScalar() {
+        DepthRasterizer rasterizer;
+        rasterizer.setIntrinsics(kFocal, kFocal, kCx, kCy, kWidth, kHeight);
+        std::srand(7);
+        std::vector <float> xyz;
+        // not a multiple of four, so the scalar tail runs as well
+        for (int i = 0; i < 4003; ++i) {
+            float u = std::rand() % (kWidth + 20) - 10;
+            float v = std::rand() % (kHeight + 20) - 10;
+            float z = 0.3f + 4.0f * std::rand() / RAND_MAX;
+            if (i % 97 == 0) {
+                z = -z;
+            }
+            addPoint(xyz, u, v, z);
+        }
+
+        rasterizer.setVectorized(true);
+        std::vector <float> vectorized = rasterize(rasterizer, xyz);
+        rasterizer.setVectorized(false);
+        std::vector <float> scalar = rasterize(rasterizer, xyz);
+        for (size_t i = 0; i < scalar.size(); ++i) {
+            CHECK_EQ(scalar[i], vectorized[i]);
+        }
+    }
+}  // namespace
+
+int main() {
+    testClosestPointWins();
+    testSplatsAreClipped();
+    testDilation();
+    testVectorizedMatchesScalar();
+    return 0;
+}
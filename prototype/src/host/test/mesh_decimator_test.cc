@@ -0,0 +1,176 @@
+#include "tango-augmented-reality/mesh_decimator.h"
+
+#include <cmath>
+#include <vector>
+
+#include "check.h"
+
+using tango_augmented_reality::MeshDecimator;
+
+namespace {
+    const int kVoxels = 16;
+    const float kResolution = 0.04f;
+
+    // error bound of the Decimate TSDF checkbox
+    const float kMaxError = 0.01f;
+
+    struct Mesh {
+        std::vector <float> vertices;
+        std::vector <uint32_t> indices;
+        std::vector <float> colors;
+    };
+
+    float height(int x, int y, float amplitude) {
+        return 0.5f + amplitude * std::sin(x * 0.7f) * std::cos(y * 0.4f);
+    }
+
+    // triangle soup of a kVoxels x kVoxels height field facing +z, two
+    // triangles per voxel like marching cubes puts on a wall
+    Mesh createPatch(float amplitude, bool colors) {
+        Mesh mesh;
+        const int kCorners[6][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 1}, {0, 1}};
+        for (int y = 0; y < kVoxels; ++y) {
+            for (int x = 0; x < kVoxels; ++x) {
+                for (int i = 0; i < 6; ++i) {
+                    int cx = x + kCorners[i][0];
+                    int cy = y + kCorners[i][1];
+                    mesh.indices.push_back(mesh.vertices.size() / 3);
+                    mesh.vertices.push_back(cx * kResolution);
+                    mesh.vertices.push_back(cy * kResolution);
+                    mesh.vertices.push_back(height(cx, cy, amplitude));
+                    if (colors) {
+                        mesh.colors.push_back(static_cast<float>(cx) / kVoxels);
+                        mesh.colors.push_back(static_cast<float>(cy) / kVoxels);
+                        mesh.colors.push_back(0.5f);
+                    }
+                }
+            }
+        }
+        return mesh;
+    }
+
+    bool isBorder(float x, float y) {
+        const float kEnd = kVoxels * kResolution;
+        return x == 0.0f || y == 0.0f || x == kEnd || y == kEnd;
+    }
+
+    // the border vertices of the input, one per position
+    std::vector <float> borderVertices(const Mesh &mesh) {
+        std::vector <float> border;
+        for (size_t i = 0; i < mesh.vertices.size(); i += 3) {
+            if (!isBorder(mesh.vertices[i], mesh.vertices[i + 1])) {
+                continue;
+            }
+            bool known = false;
+            for (size_t j = 0; j < border.size() && !known; j += 3) {
+                known = border[j] == mesh.vertices[i] && border[j + 1] == mesh.vertices[i + 1];
+            }
+            if (!known) {
+                border.insert(border.end(), mesh.vertices.begin() + i,
+                              mesh.vertices.begin() + i + 3);
+            }
+        }
+        return border;
+    }
+
+    void checkIndexed(const Mesh &mesh) {
+        CHECK_EQ(0u, mesh.indices.size() % 3);
+        for (uint32_t index : mesh.indices) {
+            CHECK(index < mesh.vertices.size() / 3);
+        }
+    }
+
+    // the chunk border stays where the neighbouring chunk expects it
+    void checkBorderKept(const Mesh &input, const Mesh &output) {
+        std::vector <float> border = borderVertices(input);
+        size_t kept = 0;
+        for (size_t i = 0; i < output.vertices.size(); i += 3) {
+            if (isBorder(output.vertices[i], output.vertices[i + 1])) {
+                kept++;
+            }
+        }
+        CHECK_EQ(border.size() / 3, kept);
+        for (size_t j = 0; j < border.size(); j += 3) {
+            bool found = false;
+            for (size_t i = 0; i < output.vertices.size() && !found; i += 3) {
+                found = output.vertices[i] == border[j] && output.vertices[i + 1] == border[j + 1] &&
+                        output.vertices[i + 2] == border[j + 2];
+            }
+            CHECK(found);
+        }
+    }
+
+    // every triangle of a height field facing +z still faces +z
+    void checkNoFlips(const Mesh &mesh) {
+        for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+            const float *a = &mesh.vertices[mesh.indices[i] * 3];
+            const float *b = &mesh.vertices[mesh.indices[i + 1] * 3];
+            const float *c = &mesh.vertices[mesh.indices[i + 2] * 3];
+            float normal = (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+            CHECK(normal > 0.0f);
+        }
+    }
+
+    void testFlatPatch() {
+        MeshDecimator decimator;
+        decimator.setMaxError(kMaxError);
+        Mesh input = createPatch(0.0f, true);
+        Mesh output = input;
+        decimator.decimate(output.vertices, output.indices, output.colors);
+
+        // the 64 border vertices alone need 62 triangles
+        CHECK_EQ(512u, input.indices.size() / 3);
+        CHECK(output.indices.size() / 3 <= 86);
+        CHECK(output.indices.size() / 3 >= 62);
+        checkIndexed(output);
+        checkBorderKept(input, output);
+        checkNoFlips(output);
+        CHECK_EQ(output.vertices.size(), output.colors.size());
+        for (size_t i = 2; i < output.vertices.size(); i += 3) {
+            CHECK_EQ(0.5f, output.vertices[i]);
+        }
+    }
+
+    void testCurvedPatch() {
+        MeshDecimator decimator;
+        decimator.setMaxError(kMaxError);
+        Mesh input = createPatch(0.02f, true);
+        Mesh output = input;
+        decimator.decimate(output.vertices, output.indices, output.colors);
+
+        CHECK(output.indices.size() < input.indices.size());
+        CHECK(output.indices.size() > 86 * 3);
+        checkIndexed(output);
+        checkBorderKept(input, output);
+        checkNoFlips(output);
+        CHECK_EQ(output.vertices.size(), output.colors.size());
+    }
+
+    void testWithoutColors() {
+        MeshDecimator decimator;
+        decimator.setMaxError(kMaxError);
+        Mesh input = createPatch(0.0f, false);
+        Mesh output = input;
+        decimator.decimate(output.vertices, output.indices, output.colors);
+        checkIndexed(output);
+        CHECK(output.colors.empty());
+    }
+
+    void testDisabled() {
+        MeshDecimator decimator;
+        Mesh input = createPatch(0.0f, true);
+        Mesh output = input;
+        decimator.decimate(output.vertices, output.indices, output.colors);
+        CHECK(input.vertices == output.vertices);
+        CHECK(input.indices == output.indices);
+        CHECK(input.colors == output.colors);
+    }
+}  // namespace
+
+int main() {
+    testFlatPatch();
+    testCurvedPatch();
+    testWithoutColors();
+    testDisabled();
+    return 0;
+}
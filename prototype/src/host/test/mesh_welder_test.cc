@@ -0,0 +1,109 @@
+#include "tango-augmented-reality/mesh_welder.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "check.h"
+
+using tango_augmented_reality::MeshWelder;
+
+namespace {
+    const float kResolution = 0.04f;
+
+    // seam vertices of a chunk at the plane x = 0.32, computed the way the
+    // chunk on the given side interpolates them
+    std::vector <float> seamVertices(bool left) {
+        std::vector <float> vertices;
+        for (int i = 0; i < 8; ++i) {
+            float y0 = i * kResolution;
+            float y1 = (i + 1) * kResolution;
+            float t = 0.1f * (i + 1);
+            // the left chunk walks from its origin, the right one from its
+            // own, the positions differ in the last bits
+            float x = left ? 8 * kResolution : std::nextafter(8 * kResolution, 1.0f);
+            float y = left ? y0 + t * (y1 - y0) : y1 - (1.0f - t) * (y1 - y0);
+            float z = left ? -1.3f + 0.01f * i : -1.3f + 0.01f * i + 1e-7f;
+            vertices.push_back(x);
+            vertices.push_back(y);
+            vertices.push_back(z);
+        }
+        return vertices;
+    }
+
+    void testSeamsAreIdentical() {
+        std::vector <float> left = seamVertices(true);
+        std::vector <float> right = seamVertices(false);
+        CHECK(std::memcmp(left.data(), right.data(), left.size() * sizeof(float)) != 0);
+
+        // each chunk is welded on its own, with its interior vertices first
+        MeshWelder a;
+        MeshWelder b;
+        a.add(0.1f, 0.1f, -1.2f);
+        b.add(0.5f, 0.1f, -1.2f);
+        b.add(0.6f, 0.2f, -1.2f);
+        std::vector <uint32_t> seam_a, seam_b;
+        for (size_t i = 0; i < left.size(); i += 3) {
+            seam_a.push_back(a.add(left[i], left[i + 1], left[i + 2]));
+            seam_b.push_back(b.add(right[i], right[i + 1], right[i + 2]));
+        }
+        for (size_t i = 0; i < seam_a.size(); ++i) {
+            const float *vertex_a = &a.getVertices()[seam_a[i] * 3];
+            const float *vertex_b = &b.getVertices()[seam_b[i] * 3];
+            CHECK_EQ(0, std::memcmp(vertex_a, vertex_b, 3 * sizeof(float)));
+        }
+    }
+
+    void testNegativeAndFarCoordinates() {
+        MeshWelder welder;
+        // both sides of the origin round to the same cell
+        uint32_t origin = welder.add(0.0f, 0.0f, 0.0f);
+        CHECK_EQ(origin, welder.add(-0.00004f, 0.00004f, -0.00004f));
+        CHECK(welder.add(-0.0001f, 0.0f, 0.0f) != origin);
+
+        // cells of a few hundred meters overflow signed products in the hash
+        const float kFar[][3] = {{-200.0f, 0.0f, 0.0f}, {200.0f, 0.0f, 0.0f},
+                                 {0.0f, -200.0f, 150.0f}, {-150.0f, 180.0f, -199.5f},
+                                 {199.9999f, -199.9999f, 199.9999f}};
+        std::vector <uint32_t> indices;
+        for (const float *vertex : kFar) {
+            indices.push_back(welder.add(vertex[0], vertex[1], vertex[2]));
+        }
+        for (size_t i = 0; i < indices.size(); ++i) {
+            for (size_t j = i + 1; j < indices.size(); ++j) {
+                CHECK(indices[i] != indices[j]);
+            }
+            const float *vertex = kFar[i];
+            CHECK_EQ(indices[i], welder.add(vertex[0], vertex[1], vertex[2]));
+            CHECK_EQ(indices[i], welder.add(vertex[0] + 0.00002f, vertex[1], vertex[2]));
+            CHECK(std::fabs(welder.getVertices()[indices[i] * 3] - vertex[0]) < 0.0001f);
+        }
+        CHECK_EQ(2u + 5u, welder.getVertexCount());
+    }
+
+    void testVerticesWithinPrecisionShareAnIndex() {
+        MeshWelder welder(0.001f);
+        uint32_t a = welder.add(0.1f, 0.2f, 0.3f);
+        CHECK_EQ(a, welder.add(0.1003f, 0.1998f, 0.3004f));
+        uint32_t b = welder.add(0.102f, 0.2f, 0.3f);
+        CHECK(a != b);
+        CHECK_EQ(b, welder.add(0.1019f, 0.2001f, 0.3f));
+        CHECK_EQ(2u, welder.getVertexCount());
+        CHECK_EQ(6u, welder.getVertices().size());
+
+        // indices follow the order of the first add
+        CHECK_EQ(0u, a);
+        CHECK_EQ(1u, b);
+
+        welder.clear();
+        CHECK_EQ(0u, welder.getVertexCount());
+        CHECK_EQ(0u, welder.add(0.102f, 0.2f, 0.3f));
+    }
+}  // namespace
+
+int main() {
+    testSeamsAreIdentical();
+    testNegativeAndFarCoordinates();
+    testVerticesWithinPrecisionShareAnIndex();
+    return 0;
+}
@@ -0,0 +1,211 @@
+// Replays a depth session into a serial chisel::Chisel and a ParallelChisel
+// and checks that both end up with the same chunks and voxels.
+//
+//   parallel_chisel_test [session]
+//
+// Without a session a synthetic one is recorded and replayed.
+
+#include "tango-augmented-reality/parallel_chisel.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "tango-augmented-reality/depth_rasterizer.h"
+#include "tango-augmented-reality/depth_session.h"
+
+#include "check.h"
+
+using tango_augmented_reality::DepthRasterizer;
+using tango_augmented_reality::DepthSession;
+using tango_augmented_reality::DepthSessionFrame;
+using tango_augmented_reality::ParallelChisel;
+using tango_augmented_reality::WorkerPool;
+
+namespace {
+    // TSDF and camera of ChiselMesh
+    const int kChunkSize = 8;
+    const float kResolution = 0.04f;
+    const float kTruncationScale = 8.0f;
+    const float kWeighting = 0.5f;
+    const float kCarvingDistance = 0.3f;
+    const float kRayTruncation = 0.5f;
+    const float kNear = 0.1f;
+    const float kFar = 2.0f;
+
+    // depth camera of the Tango development kit
+    const int kWidth = 320;
+    const int kHeight = 180;
+    const float kFocal = 260.0f;
+
+    const char kSyntheticSession[] = "parallel_chisel_test.session";
+
+    float random(float min, float max) {
+        return min + (max - min) * std::rand() / RAND_MAX;
+    }
+
+    // the floats of a frame are the rows of the extrinsic
+    chisel::Transform toTransform(const float *transformation) {
+        chisel::Transform extrinsic = chisel::Transform();
+        for (int row = 0; row < 4; ++row) {
+            for (int column = 0; column < 4; ++column) {
+                extrinsic(row, column) = transformation[row * 4 + column];
+            }
+        }
+        return extrinsic;
+    }
+
+    // a camera walking sideways along a bumpy wall while turning a bit
+    bool recordSession(const std::string &path) {
+        DepthSession session;
+        if (!session.create(path)) {
+            return false;
+        }
+        std::srand(11);
+        for (int i = 0; i < 10; ++i) {
+            float angle = 0.04f * i;
+            chisel::Transform extrinsic(Eigen::AngleAxisf(angle, chisel::Vec3::UnitY()));
+            extrinsic.translation() = chisel::Vec3(0.08f * i, 0.01f * i, 0.03f * i);
+
+            DepthSessionFrame frame;
+            frame.timestamp = i * 0.2;
+            for (int row = 0; row < 4; ++row) {
+                for (int column = 0; column < 4; ++column) {
+                    frame.transformation[row * 4 + column] = extrinsic(row, column);
+                }
+            }
+            for (int v = 0; v < kHeight; v += 3) {
+                for (int u = 0; u < kWidth; u += 3) {
+                    chisel::Vec3 ray((u - kWidth * 0.5f) / kFocal, (v - kHeight * 0.5f) / kFocal,
+                                     1.0f);
+                    chisel::Vec3 direction = extrinsic.linear() * ray;
+                    chisel::Vec3 origin = extrinsic.translation();
+                    float t = (1.6f - origin(2)) / direction(2);
+                    chisel::Vec3 hit = origin + direction * t;
+                    float depth = t + 0.15f * std::sin(hit(0) * 4.0f) * std::cos(hit(1) * 3.0f) +
+                                  random(-0.005f, 0.005f);
+                    chisel::Vec3 point = ray * depth;
+                    frame.points.push_back(point(0));
+                    frame.points.push_back(point(1));
+                    frame.points.push_back(point(2));
+                }
+            }
+            if (!session.append(frame)) {
+                return false;
+            }
+        }
+        session.close();
+        return true;
+    }
+
+    chisel::PinholeCamera createCamera() {
+        chisel::Intrinsics intrinsics;
+        intrinsics.SetFx(kFocal);
+        intrinsics.SetFy(kFocal);
+        intrinsics.SetCx(kWidth * 0.5f);
+        intrinsics.SetCy(kHeight * 0.5f);
+        chisel::PinholeCamera camera;
+        camera.SetIntrinsics(intrinsics);
+        camera.SetWidth(kWidth);
+        camera.SetHeight(kHeight);
+        camera.SetNearPlane(kNear);
+        camera.SetFarPlane(kFar);
+        return camera;
+    }
+
+    // compares the chunks and, if voxels is set, every voxel of them
+    void checkEqual(const chisel::Chisel &serial, const chisel::Chisel &parallel, bool voxels) {
+        const chisel::ChunkManager &expected = serial.GetChunkManager();
+        const chisel::ChunkManager &actual = parallel.GetChunkManager();
+        CHECK(!expected.GetChunks().empty());
+        CHECK_EQ(expected.GetChunks().size(), actual.GetChunks().size());
+        for (const std::pair <const chisel::ChunkID, chisel::ChunkPtr> &chunk :
+                expected.GetChunks()) {
+            CHECK(actual.HasChunk(chunk.first));
+            if (!voxels) {
+                continue;
+            }
+            const chisel::Chunk &other = *actual.GetChunk(chunk.first);
+            for (int i = 0; i < chunk.second->GetTotalNumVoxels(); ++i) {
+                CHECK_EQ(chunk.second->GetDistVoxel(i).GetSDF(), other.GetDistVoxel(i).GetSDF());
+                CHECK_EQ(chunk.second->GetDistVoxel(i).GetWeight(),
+                         other.GetDistVoxel(i).GetWeight());
+            }
+        }
+    }
+
+    // points of a frame as ChiselMesh passes them, the serial integration
+    // only collects chunks for points up to the far plane
+    chisel::PointCloud toPointCloud(const DepthSessionFrame &frame) {
+        chisel::PointCloud cloud;
+        for (size_t i = 0; i + 2 < frame.points.size(); i += 3) {
+            chisel::Vec3 point(frame.points[i], frame.points[i + 1], frame.points[i + 2]);
+            if (point(2) >= kNear && point.norm() <= kFar) {
+                cloud.AddPoint(point);
+            }
+        }
+        return cloud;
+    }
+
+    void testPointClouds(WorkerPool &pool, const std::vector <DepthSessionFrame> &frames,
+                         float carving_distance) {
+        const Eigen::Vector3i size(kChunkSize, kChunkSize, kChunkSize);
+        chisel::Chisel serial(size, kResolution, false);
+        ParallelChisel parallel(size, kResolution, false);
+        chisel::ProjectionIntegrator integrator =
+                parallel.createIntegrator(kTruncationScale, kWeighting, carving_distance);
+        for (const DepthSessionFrame &frame : frames) {
+            chisel::PointCloud cloud = toPointCloud(frame);
+            chisel::Transform extrinsic = toTransform(frame.transformation);
+            serial.IntegratePointCloud(integrator, cloud, extrinsic, kRayTruncation, kFar);
+            parallel.integratePointCloud(pool, integrator, cloud, extrinsic, kRayTruncation,
+                                         kFar);
+        }
+        // carving additionally reaches existing chunks in front of the band
+        checkEqual(serial, parallel, carving_distance == 0.0f);
+    }
+
+    void testDepthScans(WorkerPool &pool, const std::vector <DepthSessionFrame> &frames,
+                        float carving_distance) {
+        const Eigen::Vector3i size(kChunkSize, kChunkSize, kChunkSize);
+        chisel::Chisel serial(size, kResolution, false);
+        ParallelChisel parallel(size, kResolution, false);
+        chisel::ProjectionIntegrator integrator =
+                parallel.createIntegrator(kTruncationScale, kWeighting, carving_distance);
+        chisel::PinholeCamera camera = createCamera();
+        DepthRasterizer rasterizer;
+        rasterizer.setIntrinsics(kFocal, kFocal, kWidth * 0.5f, kHeight * 0.5f, kWidth, kHeight);
+        boost::shared_ptr <chisel::DepthImage<float>> depth(
+                new chisel::DepthImage<float>(kWidth, kHeight));
+        for (const DepthSessionFrame &frame : frames) {
+            rasterizer.rasterize(frame.points.data(), frame.points.size() / 3,
+                                 depth->GetMutableData());
+            chisel::Transform extrinsic = toTransform(frame.transformation);
+            serial.IntegrateDepthScan<float>(integrator, depth, extrinsic, camera);
+            parallel.integrateDepthScan(pool, integrator, depth, extrinsic, camera);
+        }
+        checkEqual(serial, parallel, true);
+    }
+}  // namespace
+
+int main(int argc, char **argv) {
+    std::string path = argc > 1 ? argv[1] : kSyntheticSession;
+    if (argc <= 1) {
+        CHECK(recordSession(path));
+    }
+    std::vector <DepthSessionFrame> frames;
+    CHECK(DepthSession::load(path, frames));
+    CHECK(!frames.empty());
+    if (argc <= 1) {
+        std::remove(path.c_str());
+    }
+
+    WorkerPool pool;
+    testPointClouds(pool, frames, 0.0f);
+    testPointClouds(pool, frames, kCarvingDistance);
+    testDepthScans(pool, frames, 0.0f);
+    testDepthScans(pool, frames, kCarvingDistance);
+    return 0;
+}
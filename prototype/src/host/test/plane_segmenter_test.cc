@@ -0,0 +1,107 @@
+#include "tango-augmented-reality/plane_segmenter.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "check.h"
+
+using tango_augmented_reality::OrganizedPlaneSegmenter;
+using tango_augmented_reality::PlaneSegment;
+
+namespace {
+    // depth camera of the Tango development kit
+    const int kWidth = 320;
+    const int kHeight = 180;
+    const float kFocal = 260.0f;
+
+    // floor below the camera and a wall in front of it, y points down
+    const float kFloorHeight = 0.4f;
+    const float kWallDistance = 2.5f;
+
+    // uniform depth noise in meters, below the noise model of the segmenter
+    const float kNoise = 0.002f;
+
+    float noise() {
+        return kNoise * (2.0f * std::rand() / RAND_MAX - 1.0f);
+    }
+
+    // casts a ray through every pixel and keeps the nearer of both planes
+    std::vector <float> createFrame() {
+        std::vector <float> vertices;
+        for (int v = 0; v < kHeight; ++v) {
+            for (int u = 0; u < kWidth; ++u) {
+                glm::vec3 ray((u + 0.5f - kWidth * 0.5f) / kFocal,
+                              (v + 0.5f - kHeight * 0.5f) / kFocal, 1.0f);
+                float t = kWallDistance;
+                if (ray.y > 0.0f) {
+                    t = std::min(t, kFloorHeight / ray.y);
+                }
+                glm::vec3 point = ray * (t + noise());
+                vertices.push_back(point.x);
+                vertices.push_back(point.y);
+                vertices.push_back(point.z);
+            }
+        }
+        return vertices;
+    }
+
+    // segment of the plane with the given camera facing normal and distance
+    const PlaneSegment *findSegment(const std::vector <PlaneSegment> &segments,
+                                    const glm::vec3 &normal, float distance) {
+        for (const PlaneSegment &segment : segments) {
+            if (glm::dot(segment.normal, normal) > 0.99f &&
+                std::fabs(segment.distance - distance) < 0.02f) {
+                return &segment;
+            }
+        }
+        return nullptr;
+    }
+
+    // the points lie within three sigmas of the noise model of the segmenter
+    void checkPoints(const PlaneSegment &segment, const glm::vec3 &normal, float distance) {
+        for (const glm::vec3 &point : segment.points) {
+            float sigma = 0.005f * point.z * point.z + 0.005f;
+            CHECK(std::fabs(glm::dot(normal, point) - distance) < 3.0f * sigma);
+        }
+    }
+
+    void testTwoPlanes() {
+        OrganizedPlaneSegmenter segmenter;
+        segmenter.setIntrinsics(kFocal, kFocal, kWidth * 0.5f, kHeight * 0.5f, kWidth, kHeight);
+        std::srand(3);
+        std::vector <float> vertices = createFrame();
+        std::vector <PlaneSegment> segments;
+        segmenter.segment(vertices, segments);
+        CHECK_EQ(2u, segments.size());
+
+        // both normals face the camera in the origin
+        glm::vec3 floor_normal(0.0f, -1.0f, 0.0f);
+        glm::vec3 wall_normal(0.0f, 0.0f, -1.0f);
+        const PlaneSegment *floor = findSegment(segments, floor_normal, -kFloorHeight);
+        const PlaneSegment *wall = findSegment(segments, wall_normal, -kWallDistance);
+        CHECK(floor != nullptr);
+        CHECK(wall != nullptr);
+        checkPoints(*floor, floor_normal, -kFloorHeight);
+        checkPoints(*wall, wall_normal, -kWallDistance);
+
+        // only the cells along the edge between the planes are lost
+        size_t points = vertices.size() / 3;
+        CHECK(floor->points.size() + wall->points.size() > points * 8 / 10);
+        CHECK(floor->points.size() > points / 8);
+        CHECK(wall->points.size() > points / 2);
+    }
+
+    void testWithoutIntrinsics() {
+        OrganizedPlaneSegmenter segmenter;
+        std::vector <PlaneSegment> segments(1);
+        segmenter.segment(createFrame(), segments);
+        CHECK(segments.empty());
+    }
+}  // namespace
+
+int main() {
+    testTwoPlanes();
+    testWithoutIntrinsics();
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include "tango-augmented-reality/range_allocator.h"
+
+#include "check.h"
+
+using tango_augmented_reality::RangeAllocator;
+
+namespace {
+    void testFirstFit() {
+        RangeAllocator ranges(100);
+        size_t a, b, c;
+        CHECK(ranges.allocate(10, a));
+        CHECK(ranges.allocate(20, b));
+        CHECK(ranges.allocate(30, c));
+        CHECK_EQ(0u, a);
+        CHECK_EQ(10u, b);
+        CHECK_EQ(30u, c);
+        CHECK_EQ(60u, ranges.getUsed());
+
+        // a hole of 20 in front of the tail of 40, the smaller request takes
+        // the first range which fits, the larger one the tail
+        ranges.release(b, 20);
+        size_t small, large;
+        CHECK(ranges.allocate(15, small));
+        CHECK_EQ(10u, small);
+        CHECK(ranges.allocate(25, large));
+        CHECK_EQ(60u, large);
+
+        size_t none;
+        CHECK(!ranges.allocate(20, none));
+        CHECK(ranges.allocate(15, none));
+        CHECK_EQ(85u, none);
+        CHECK_EQ(95u, ranges.getUsed());
+    }
+
+    void testCoalescing() {
+        RangeAllocator ranges(30);
+        size_t a, b, c;
+        ranges.allocate(10, a);
+        ranges.allocate(10, b);
+        ranges.allocate(10, c);
+        CHECK_EQ(0u, ranges.getFreeRangeCount());
+
+        ranges.release(a, 10);
+        ranges.release(c, 10);
+        CHECK_EQ(2u, ranges.getFreeRangeCount());
+
+        // the middle range joins both neighbours into one
+        ranges.release(b, 10);
+        CHECK_EQ(1u, ranges.getFreeRangeCount());
+        CHECK_EQ(0u, ranges.getUsed());
+
+        size_t all;
+        CHECK(ranges.allocate(30, all));
+        CHECK_EQ(0u, all);
+    }
+
+    void testReuseAfterFree() {
+        RangeAllocator ranges(40);
+        size_t a, b;
+        ranges.allocate(20, a);
+        ranges.allocate(20, b);
+        ranges.release(a, 20);
+
+        size_t reused;
+        CHECK(ranges.allocate(20, reused));
+        CHECK_EQ(a, reused);
+
+        // growing appends to the free tail instead of adding a new range
+        ranges.release(b, 20);
+        ranges.grow(80);
+        CHECK_EQ(80u, ranges.getCapacity());
+        CHECK_EQ(1u, ranges.getFreeRangeCount());
+        size_t grown;
+        CHECK(ranges.allocate(60, grown));
+        CHECK_EQ(20u, grown);
+
+        ranges.clear();
+        CHECK_EQ(0u, ranges.getUsed());
+        CHECK_EQ(80u, ranges.getCapacity());
+        CHECK(ranges.allocate(80, grown));
+    }
+
+    void testDirtyMerging() {
+        RangeAllocator ranges(100);
+        std::vector <RangeAllocator::Range> dirty;
+
+        ranges.markDirty(10, 5);
+        ranges.markDirty(30, 10);
+        // adjacent to the first, overlapping the second
+        ranges.markDirty(15, 5);
+        ranges.markDirty(35, 10);
+        ranges.markDirty(60, 0);
+        ranges.takeDirtyRanges(dirty);
+        CHECK_EQ(2u, dirty.size());
+        CHECK_EQ(10u, dirty[0].offset);
+        CHECK_EQ(10u, dirty[0].size);
+        CHECK_EQ(30u, dirty[1].offset);
+        CHECK_EQ(15u, dirty[1].size);
+
+        ranges.takeDirtyRanges(dirty);
+        CHECK(dirty.empty());
+
+        // a range covering several dirty ranges swallows them
+        ranges.markDirty(0, 2);
+        ranges.markDirty(5, 2);
+        ranges.markDirty(10, 2);
+        ranges.markDirty(1, 10);
+        ranges.takeDirtyRanges(dirty);
+        CHECK_EQ(1u, dirty.size());
+        CHECK_EQ(0u, dirty[0].offset);
+        CHECK_EQ(12u, dirty[0].size);
+    }
+}  // namespace
+
+int main() {
+    testFirstFit();
+    testCoalescing();
+    testReuseAfterFree();
+    testDirtyMerging();
+    return 0;
+}
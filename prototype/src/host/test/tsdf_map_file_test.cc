@@ -0,0 +1,128 @@
+#include "tango-augmented-reality/tsdf_map_file.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "check.h"
+
+using tango_augmented_reality::PackedChunk;
+using tango_augmented_reality::TsdfMapFile;
+using tango_augmented_reality::VoxelRun;
+
+namespace {
+    const Eigen::Vector3i kChunkSize(8, 8, 8);
+    const float kResolution = 0.04f;
+
+    const char kPath[] = "tsdf_map_file_test.tsdf";
+
+    // chunk with the given number of runs, the values follow seed
+    PackedChunk createChunk(int runs, int seed) {
+        PackedChunk chunk;
+        chunk.count = 0;
+        chunk.colors = 0;
+        chunk.weight_step = 0.5f;
+        for (int i = 0; i < runs; ++i) {
+            VoxelRun run = {static_cast<uint32_t>(1 + i % 3), static_cast<int16_t>(seed * 7 + i),
+                            static_cast<uint8_t>(seed + i), {0, 0, 0, 0}};
+            chunk.runs.push_back(run);
+            chunk.count += run.length;
+        }
+        return chunk;
+    }
+
+    void checkChunk(TsdfMapFile &map, const chisel::ChunkID &id, const PackedChunk &expected) {
+        PackedChunk chunk;
+        CHECK(map.read(id, chunk));
+        CHECK_EQ(expected.count, chunk.count);
+        CHECK_EQ(expected.runs.size(), chunk.runs.size());
+        for (size_t i = 0; i < chunk.runs.size(); ++i) {
+            CHECK_EQ(expected.runs[i].length, chunk.runs[i].length);
+            CHECK_EQ(expected.runs[i].sdf, chunk.runs[i].sdf);
+            CHECK_EQ(expected.runs[i].weight, chunk.runs[i].weight);
+        }
+    }
+
+    void testRemovedRecordsAreReused() {
+        TsdfMapFile map;
+        CHECK(map.create(kPath, kChunkSize, kResolution));
+        PackedChunk a = createChunk(10, 1);
+        PackedChunk b = createChunk(20, 2);
+        PackedChunk c = createChunk(10, 3);
+        CHECK(map.write(chisel::ChunkID(0, 0, 0), a));
+        CHECK(map.write(chisel::ChunkID(1, 0, 0), b));
+        CHECK(map.write(chisel::ChunkID(2, 0, 0), c));
+        uint64_t bytes = map.getRecordBytes();
+
+        // a smaller chunk fits into the record of b, the rest stays free
+        map.remove(chisel::ChunkID(1, 0, 0));
+        CHECK_EQ(bytes, map.getRecordBytes());
+        PackedChunk d = createChunk(5, 4);
+        CHECK(map.write(chisel::ChunkID(3, 0, 0), d));
+        CHECK_EQ(bytes, map.getRecordBytes());
+        CHECK(map.getFreeBytes() > 0);
+
+        // rewriting a chunk frees its old record
+        PackedChunk e = createChunk(12, 5);
+        CHECK(map.write(chisel::ChunkID(0, 0, 0), e));
+        checkChunk(map, chisel::ChunkID(0, 0, 0), e);
+        checkChunk(map, chisel::ChunkID(2, 0, 0), c);
+        checkChunk(map, chisel::ChunkID(3, 0, 0), d);
+
+        // freeing the last record shrinks the records instead
+        map.remove(chisel::ChunkID(0, 0, 0));
+        map.remove(chisel::ChunkID(2, 0, 0));
+        map.remove(chisel::ChunkID(3, 0, 0));
+        CHECK_EQ(0u, map.getRecordBytes());
+        CHECK_EQ(0u, map.getFreeBytes());
+        map.close();
+        std::remove(kPath);
+    }
+
+    // chunks leaving memory and coming back, like a camera walking between
+    // two rooms, keep the file at the size of the chunks in it
+    void testEvictionCyclesDoNotGrow() {
+        TsdfMapFile map;
+        CHECK(map.create(kPath, kChunkSize, kResolution));
+        std::srand(7);
+        const int kChunks = 64;
+        std::vector <PackedChunk> chunks;
+        uint64_t live = 0;
+        for (int i = 0; i < kChunks; ++i) {
+            chunks.push_back(createChunk(1 + std::rand() % 40, i));
+            CHECK(map.write(chisel::ChunkID(i, 0, 0), chunks.back()));
+            live = map.getRecordBytes();
+        }
+        for (int cycle = 0; cycle < 50; ++cycle) {
+            // half of the chunks are loaded, integrated and evicted again
+            for (int i = cycle % 2; i < kChunks; i += 2) {
+                map.remove(chisel::ChunkID(i, 0, 0));
+            }
+            for (int i = cycle % 2; i < kChunks; i += 2) {
+                chunks[i] = createChunk(1 + std::rand() % 40, cycle * kChunks + i);
+                CHECK(map.write(chisel::ChunkID(i, 0, 0), chunks[i]));
+            }
+            CHECK(map.getRecordBytes() <= 2 * live);
+        }
+        for (int i = 0; i < kChunks; ++i) {
+            checkChunk(map, chisel::ChunkID(i, 0, 0), chunks[i]);
+        }
+
+        // the index still finds every record after reopening
+        CHECK(map.flush());
+        map.close();
+        CHECK(map.open(kPath, kChunkSize, kResolution));
+        CHECK_EQ(static_cast<size_t>(kChunks), map.getChunkCount());
+        for (int i = 0; i < kChunks; ++i) {
+            checkChunk(map, chisel::ChunkID(i, 0, 0), chunks[i]);
+        }
+        map.close();
+        std::remove(kPath);
+    }
+}  // namespace
+
+int main() {
+    testRemovedRecordsAreReused();
+    testEvictionCyclesDoNotGrow();
+    return 0;
+}
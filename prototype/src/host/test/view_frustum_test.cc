@@ -0,0 +1,96 @@
+#include "tango-augmented-reality/view_frustum.h"
+
+#include "check.h"
+
+using tango_augmented_reality::ViewFrustum;
+
+namespace {
+    // OpenGL projection with a 90 degree field of view, square aspect, near
+    // plane at 1 and far plane at 10, so the side planes are |x| = -z and
+    // |y| = -z in camera coordinates
+    glm::mat4 projection() {
+        const float near = 1.0f;
+        const float far = 10.0f;
+        glm::mat4 matrix(0.0f);
+        matrix[0][0] = 1.0f;
+        matrix[1][1] = 1.0f;
+        matrix[2][2] = -(far + near) / (far - near);
+        matrix[2][3] = -1.0f;
+        matrix[3][2] = -2.0f * far * near / (far - near);
+        return matrix;
+    }
+
+    // view of a camera at position looking down -z
+    glm::mat4 view(const glm::vec3 &position) {
+        glm::mat4 matrix(1.0f);
+        matrix[3] = glm::vec4(-position.x, -position.y, -position.z, 1.0f);
+        return matrix;
+    }
+
+    void testPlaneExtraction() {
+        ViewFrustum frustum(projection());
+        CHECK(frustum.contains(glm::vec3(0.0f, 0.0f, -5.0f)));
+        CHECK(frustum.contains(glm::vec3(4.9f, 0.0f, -5.0f)));
+        CHECK(frustum.contains(glm::vec3(0.0f, -4.9f, -5.0f)));
+        CHECK(frustum.contains(glm::vec3(0.0f, 0.0f, -1.1f)));
+        CHECK(frustum.contains(glm::vec3(0.0f, 0.0f, -9.9f)));
+
+        CHECK(!frustum.contains(glm::vec3(5.1f, 0.0f, -5.0f)));
+        CHECK(!frustum.contains(glm::vec3(-5.1f, 0.0f, -5.0f)));
+        CHECK(!frustum.contains(glm::vec3(0.0f, 5.1f, -5.0f)));
+        CHECK(!frustum.contains(glm::vec3(0.0f, -5.1f, -5.0f)));
+        CHECK(!frustum.contains(glm::vec3(0.0f, 0.0f, -0.9f)));
+        CHECK(!frustum.contains(glm::vec3(0.0f, 0.0f, -10.1f)));
+        CHECK(!frustum.contains(glm::vec3(0.0f, 0.0f, 5.0f)));
+    }
+
+    void testPlanesAreNormalized() {
+        ViewFrustum frustum(projection());
+        // the right plane x = -z is 0.5 / sqrt(2) = 0.354 away from the center
+        CHECK(!frustum.intersectsSphere(glm::vec3(5.5f, 0.0f, -5.0f), 0.3f));
+        CHECK(frustum.intersectsSphere(glm::vec3(5.5f, 0.0f, -5.0f), 0.4f));
+        // the far plane is 0.5 away
+        CHECK(!frustum.intersectsSphere(glm::vec3(0.0f, 0.0f, -10.5f), 0.45f));
+        CHECK(frustum.intersectsSphere(glm::vec3(0.0f, 0.0f, -10.5f), 0.55f));
+    }
+
+    void testBoxes() {
+        ViewFrustum frustum(projection());
+        // inside
+        CHECK(frustum.intersects(glm::vec3(-1.0f, -1.0f, -6.0f), glm::vec3(1.0f, 1.0f, -4.0f)));
+        // outside of a single plane each
+        CHECK(!frustum.intersects(glm::vec3(6.5f, -1.0f, -6.0f), glm::vec3(8.0f, 1.0f, -4.0f)));
+        CHECK(!frustum.intersects(glm::vec3(-1.0f, 6.5f, -6.0f), glm::vec3(1.0f, 8.0f, -4.0f)));
+        CHECK(!frustum.intersects(glm::vec3(-1.0f, -1.0f, 1.0f), glm::vec3(1.0f, 1.0f, 3.0f)));
+        CHECK(!frustum.intersects(glm::vec3(-1.0f, -1.0f, -14.0f), glm::vec3(1.0f, 1.0f, -11.0f)));
+        // straddling a side, the near and the far plane
+        CHECK(frustum.intersects(glm::vec3(4.0f, -1.0f, -6.0f), glm::vec3(7.0f, 1.0f, -4.0f)));
+        CHECK(frustum.intersects(glm::vec3(-0.1f, -0.1f, -1.5f), glm::vec3(0.1f, 0.1f, -0.5f)));
+        CHECK(frustum.intersects(glm::vec3(-1.0f, -1.0f, -12.0f), glm::vec3(1.0f, 1.0f, -9.0f)));
+        // enclosing the whole frustum
+        CHECK(frustum.intersects(glm::vec3(-100.0f), glm::vec3(100.0f)));
+    }
+
+    void testViewTransformation() {
+        ViewFrustum frustum(projection() * view(glm::vec3(10.0f, 0.0f, 0.0f)));
+        CHECK(frustum.contains(glm::vec3(10.0f, 0.0f, -5.0f)));
+        CHECK(!frustum.contains(glm::vec3(0.0f, 0.0f, -5.0f)));
+        CHECK(frustum.intersects(glm::vec3(9.0f, -1.0f, -6.0f), glm::vec3(11.0f, 1.0f, -4.0f)));
+        CHECK(!frustum.intersects(glm::vec3(-1.0f, -1.0f, -6.0f), glm::vec3(1.0f, 1.0f, -4.0f)));
+    }
+
+    void testDefaultContainsEverything() {
+        ViewFrustum frustum;
+        CHECK(frustum.contains(glm::vec3(1000.0f, -1000.0f, 1000.0f)));
+        CHECK(frustum.intersects(glm::vec3(-1.0f), glm::vec3(1.0f)));
+    }
+}  // namespace
+
+int main() {
+    testPlaneExtraction();
+    testPlanesAreNormalized();
+    testBoxes();
+    testViewTransformation();
+    testDefaultContainsEverything();
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include "tango-augmented-reality/voxel_codec.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "check.h"
+
+using tango_augmented_reality::CompactVoxels;
+using tango_augmented_reality::VoxelCodec;
+
+namespace {
+    const float kResolution = 0.04f;
+    const float kWeightStep = 0.5f;
+
+    // distance of the largest fixed point value, 128 voxels
+    const float kRange = 32767.0f * kResolution / 256.0f;
+
+    float random(float min, float max) {
+        return min + (max - min) * std::rand() / RAND_MAX;
+    }
+
+    struct Decoded {
+        std::vector <float> sdf;
+        std::vector <float> weight;
+    };
+
+    Decoded roundTrip(const VoxelCodec &codec, const std::vector <float> &sdf,
+                      const std::vector <float> &weight) {
+        std::vector <int16_t> compact_sdf(sdf.size());
+        std::vector <uint8_t> compact_weight(sdf.size());
+        codec.encode(sdf.data(), weight.data(), sdf.size(), compact_sdf.data(),
+                     compact_weight.data());
+        Decoded decoded;
+        decoded.sdf.resize(sdf.size());
+        decoded.weight.resize(sdf.size());
+        codec.decode(compact_sdf.data(), compact_weight.data(), sdf.size(), decoded.sdf.data(),
+                     decoded.weight.data());
+        return decoded;
+    }
+
+    void testErrorInsideRange() {
+        VoxelCodec codec = VoxelCodec::forResolution(kResolution, kWeightStep);
+        CHECK(codec.getMaxError() < kResolution * 0.01f);
+        std::srand(3);
+        std::vector <float> sdf(10000);
+        std::vector <float> weight(sdf.size());
+        for (size_t i = 0; i < sdf.size(); ++i) {
+            sdf[i] = random(-kRange, kRange);
+            weight[i] = random(kWeightStep, 200.0f * kWeightStep);
+        }
+        Decoded decoded = roundTrip(codec, sdf, weight);
+        // float rounding of the scaling on top of the half step
+        float max_error = codec.getMaxError() * 1.001f;
+        for (size_t i = 0; i < sdf.size(); ++i) {
+            CHECK(std::fabs(decoded.sdf[i] - sdf[i]) <= max_error);
+            CHECK(std::fabs(decoded.weight[i] - weight[i]) <= kWeightStep * 0.5f);
+        }
+    }
+
+    void testDistancesSaturate() {
+        VoxelCodec codec = VoxelCodec::forResolution(kResolution, kWeightStep);
+        // the default distance of unobserved chisel voxels is far out of range
+        std::vector <float> sdf = {kRange * 1.5f, -kRange * 1.5f, 99999.0f, -99999.0f};
+        std::vector <float> weight(sdf.size(), kWeightStep);
+        Decoded decoded = roundTrip(codec, sdf, weight);
+        float max_error = codec.getMaxError() * 1.001f;
+        CHECK(std::fabs(decoded.sdf[0] - kRange) <= max_error);
+        CHECK(std::fabs(decoded.sdf[1] + kRange) <= max_error);
+        CHECK(std::fabs(decoded.sdf[2] - kRange) <= max_error);
+        CHECK(std::fabs(decoded.sdf[3] + kRange) <= max_error);
+    }
+
+    void testObservedVoxelsKeepWeight() {
+        VoxelCodec codec = VoxelCodec::forResolution(kResolution, kWeightStep);
+        std::vector <float> sdf(4, 0.01f);
+        // below half a step would round to nothing
+        std::vector <float> weight = {0.0f, kWeightStep * 0.01f, kWeightStep * 0.49f,
+                                      kWeightStep * 1.4f};
+        Decoded decoded = roundTrip(codec, sdf, weight);
+        CHECK_EQ(0.0f, decoded.weight[0]);
+        CHECK_EQ(kWeightStep, decoded.weight[1]);
+        CHECK_EQ(kWeightStep, decoded.weight[2]);
+        CHECK_EQ(kWeightStep, decoded.weight[3]);
+    }
+
+    void testWeightsSaturate() {
+        VoxelCodec codec = VoxelCodec::forResolution(kResolution, kWeightStep);
+        std::vector <float> sdf(3, 0.0f);
+        // a voxel observed more than 255 times loses the count silently
+        std::vector <float> weight = {254.0f * kWeightStep, 255.0f * kWeightStep,
+                                      1000.0f * kWeightStep};
+        Decoded decoded = roundTrip(codec, sdf, weight);
+        CHECK_EQ(254.0f * kWeightStep, decoded.weight[0]);
+        CHECK_EQ(255.0f * kWeightStep, decoded.weight[1]);
+        CHECK_EQ(255.0f * kWeightStep, decoded.weight[2]);
+    }
+
+    void testChunkRoundTrip() {
+        VoxelCodec codec = VoxelCodec::forResolution(kResolution, kWeightStep);
+        const Eigen::Vector3i size(8, 8, 8);
+        chisel::Chunk chunk(chisel::ChunkID(1, -2, 3), size, kResolution, false);
+        std::srand(5);
+        for (int i = 0; i < chunk.GetTotalNumVoxels(); i += 3) {
+            chisel::DistVoxel &voxel = chunk.GetDistVoxelMutable(i);
+            voxel.SetSDF(random(-4.0f * kResolution, 4.0f * kResolution));
+            voxel.SetWeight(random(kWeightStep, 20.0f * kWeightStep));
+        }
+        CompactVoxels voxels;
+        codec.encode(chunk, voxels);
+        CHECK_EQ(static_cast<size_t>(chunk.GetTotalNumVoxels()), voxels.sdf.size());
+        CHECK_EQ(voxels.sdf.size(), voxels.weight.size());
+
+        // voxels without weight keep whatever the target chunk holds
+        const float kUntouchedSdf = 7.0f;
+        const float kUntouchedWeight = 3.0f;
+        chisel::Chunk decoded(chunk.GetID(), size, kResolution, false);
+        for (int i = 0; i < decoded.GetTotalNumVoxels(); ++i) {
+            decoded.GetDistVoxelMutable(i).SetSDF(kUntouchedSdf);
+            decoded.GetDistVoxelMutable(i).SetWeight(kUntouchedWeight);
+        }
+        codec.decode(voxels, decoded);
+        float max_error = codec.getMaxError() * 1.001f;
+        for (int i = 0; i < chunk.GetTotalNumVoxels(); ++i) {
+            const chisel::DistVoxel &original = chunk.GetDistVoxel(i);
+            const chisel::DistVoxel &voxel = decoded.GetDistVoxel(i);
+            if (original.GetWeight() > 0.0f) {
+                CHECK(voxel.GetWeight() >= kWeightStep);
+                CHECK(std::fabs(voxel.GetSDF() - original.GetSDF()) <= max_error);
+                CHECK(std::fabs(voxel.GetWeight() - original.GetWeight()) <= kWeightStep * 0.5f);
+            } else {
+                CHECK_EQ(kUntouchedSdf, voxel.GetSDF());
+                CHECK_EQ(kUntouchedWeight, voxel.GetWeight());
+            }
+        }
+
+        // a fresh chunk keeps the default distance of its unobserved voxels
+        chisel::Chunk fresh(chunk.GetID(), size, kResolution, false);
+        float default_sdf = fresh.GetDistVoxel(1).GetSDF();
+        codec.decode(voxels, fresh);
+        CHECK_EQ(default_sdf, fresh.GetDistVoxel(1).GetSDF());
+        CHECK_EQ(0.0f, fresh.GetDistVoxel(1).GetWeight());
+    }
+}  // namespace
+
+int main() {
+    testErrorInsideRange();
+    testDistancesSaturate();
+    testObservedVoxelsKeepWeight();
+    testWeightsSaturate();
+    testChunkRoundTrip();
+    return 0;
+}
@@ -39,6 +39,8 @@ import android.widget.Toast;
 
 import com.erz.joysticklibrary.JoyStick;
 
+import java.io.File;
+
 // The main activity of the application which shows debug information and a
 // glSurfaceView that renders graphic content.
 public class MainActivity extends Activity implements
@@ -56,6 +58,13 @@ public class MainActivity extends Activity implements
     private static final String TANGO_PACKAGE_NAME = "com.projecttango.tango";
     // Tag for debug logging.
     private static final String TAG = MainActivity.class.getSimpleName();
+    // memory for TSDF voxels before distant chunks are spilled to storage
+    private static final int TSDF_MEMORY_BUDGET_MB = 128;
+    // surface deviation allowed by the TSDF mesh decimation in meters
+    private static final float TSDF_DECIMATION_ERROR = 0.01f;
+    // resolution of the occlusion depth ray cast from the TSDF
+    private static final int TSDF_RAYCAST_WIDTH = 160;
+    private static final int TSDF_RAYCAST_HEIGHT = 90;
     // guided filter flag
     boolean do_filtering = false;
     // initial guided filter values
@@ -83,6 +92,10 @@ public class MainActivity extends Activity implements
     private TapGestureDetector tapGestureDetector;
     private Button placeObjectButton;
     private Button clearButton;
+    private Button benchmarkButton;
+    private Button sweepButton;
+    private Button saveButton;
+    private Button loadButton;
     private SeekBar sigmaSeekBar;
     private SeekBar diameterSeekBar;
     private TextView diameterTextView;
@@ -112,6 +125,14 @@ public class MainActivity extends Activity implements
         findViewById(R.id.top_down_button).setOnClickListener(this);
         findViewById(R.id.show_occlusion).setOnClickListener(this);
         findViewById(R.id.depth_fullscreen).setOnClickListener(this);
+        findViewById(R.id.organized_planes).setOnClickListener(this);
+        findViewById(R.id.plane_completion).setOnClickListener(this);
+        findViewById(R.id.pointcloud_integration).setOnClickListener(this);
+        findViewById(R.id.tsdf_color).setOnClickListener(this);
+        findViewById(R.id.tsdf_decimation).setOnClickListener(this);
+        findViewById(R.id.tsdf_multi_resolution).setOnClickListener(this);
+        findViewById(R.id.tsdf_raycast).setOnClickListener(this);
+        findViewById(R.id.tsdf_record_session).setOnClickListener(this);
 
         // init the joystick and listener
         JoyStick joyStick = (JoyStick) findViewById(R.id.joystick);
@@ -127,6 +148,24 @@ public class MainActivity extends Activity implements
         clearButton.setVisibility(View.INVISIBLE);
         clearButton.setOnClickListener(this);
 
+        // benchmark the TSDF integration modes
+        benchmarkButton = (Button) findViewById(R.id.benchmark_reconstruction);
+        benchmarkButton.setVisibility(View.INVISIBLE);
+        benchmarkButton.setOnClickListener(this);
+
+        // sweep the TSDF parameters on the recorded depth session
+        sweepButton = (Button) findViewById(R.id.sweep_reconstruction);
+        sweepButton.setVisibility(View.INVISIBLE);
+        sweepButton.setOnClickListener(this);
+
+        // save the TSDF and start from the saved one
+        saveButton = (Button) findViewById(R.id.save_reconstruction);
+        saveButton.setVisibility(View.INVISIBLE);
+        saveButton.setOnClickListener(this);
+        loadButton = (Button) findViewById(R.id.load_reconstruction);
+        loadButton.setVisibility(View.INVISIBLE);
+        loadButton.setOnClickListener(this);
+
         // init the guided filter options
         sigmaSeekBar = (SeekBar) findViewById(R.id.sigma_seek_bar);
         sigmaSeekBar.setOnSeekBarChangeListener(this);
@@ -177,6 +216,10 @@ public class MainActivity extends Activity implements
         // between the application and Tango Service.
         // The activity object is used for checking if the API version is outdated.
         TangoJNINative.initialize(this);
+
+        // spill distant parts of large TSDF maps into the cache
+        TangoJNINative.setTsdfStreaming(new File(getCacheDir(), "tsdf").getAbsolutePath(),
+                TSDF_MEMORY_BUDGET_MB);
     }
 
     @Override
@@ -249,6 +292,39 @@ public class MainActivity extends Activity implements
             case R.id.depth_fullscreen:
                 TangoJNINative.setDepthFullscreen(((CheckBox) v).isChecked());
                 break;
+            case R.id.organized_planes:
+                TangoJNINative.setPlaneEngine(((CheckBox) v).isChecked() ? 1 : 0);
+                break;
+            case R.id.plane_completion:
+                TangoJNINative.setPlaneCompletion(((CheckBox) v).isChecked());
+                break;
+            case R.id.pointcloud_integration:
+                TangoJNINative.setIntegrationMode(((CheckBox) v).isChecked() ? 1 : 0);
+                break;
+            case R.id.tsdf_color:
+                TangoJNINative.setTsdfColor(((CheckBox) v).isChecked());
+                break;
+            case R.id.tsdf_decimation:
+                TangoJNINative.setTsdfDecimation(
+                        ((CheckBox) v).isChecked() ? TSDF_DECIMATION_ERROR : 0.0f);
+                break;
+            case R.id.tsdf_multi_resolution:
+                TangoJNINative.setTsdfMultiResolution(((CheckBox) v).isChecked());
+                break;
+            case R.id.tsdf_raycast:
+                if (((CheckBox) v).isChecked()) {
+                    TangoJNINative.setTsdfRaycast(TSDF_RAYCAST_WIDTH, TSDF_RAYCAST_HEIGHT);
+                } else {
+                    TangoJNINative.setTsdfRaycast(0, 0);
+                }
+                break;
+            case R.id.tsdf_record_session:
+                if (((CheckBox) v).isChecked()) {
+                    TangoJNINative.setSessionRecording(getDepthSessionFile().getAbsolutePath());
+                } else {
+                    TangoJNINative.setSessionRecording("");
+                }
+                break;
             case R.id.show_occlusion:
                 TangoJNINative.setShowOcclusion(((CheckBox) v).isChecked());
                 break;
@@ -259,6 +335,25 @@ public class MainActivity extends Activity implements
             case R.id.clear_reconstruction:
                 TangoJNINative.clearReconstruction();
                 break;
+            case R.id.benchmark_reconstruction:
+                TangoJNINative.benchmarkReconstruction();
+                break;
+            case R.id.sweep_reconstruction:
+                // without a recorded session the last frames are replayed
+                if (getDepthSessionFile().exists()) {
+                    TangoJNINative.sweepReconstruction(getDepthSessionFile().getAbsolutePath());
+                } else {
+                    TangoJNINative.sweepReconstruction("");
+                }
+                break;
+            case R.id.save_reconstruction:
+                TangoJNINative.saveTsdf(getTsdfMapFile().getAbsolutePath());
+                break;
+            case R.id.load_reconstruction:
+                if (getTsdfMapFile().exists()) {
+                    TangoJNINative.loadTsdf(getTsdfMapFile().getAbsolutePath());
+                }
+                break;
             default:
                 Log.w(TAG, "Unknown button click");
         }
@@ -330,20 +425,42 @@ public class MainActivity extends Activity implements
         return (minVersion <= versionNumber);
     }
 
+    // the TSDF map kept between sessions
+    private File getTsdfMapFile() {
+        return new File(getFilesDir(), "map.tsdf");
+    }
+
+    // the recorded depth frames for the parameter sweep
+    private File getDepthSessionFile() {
+        return new File(getFilesDir(), "session.depth");
+    }
+
     public void onRadioButtonClicked(View view) {
         // Check which radio button was clicked and change mode
         switch (view.getId()) {
             case R.id.pointclouds:
                 mode = ARMode.POINTCLOUD;
                 clearButton.setVisibility(View.INVISIBLE);
+                benchmarkButton.setVisibility(View.INVISIBLE);
+                sweepButton.setVisibility(View.INVISIBLE);
+                saveButton.setVisibility(View.INVISIBLE);
+                loadButton.setVisibility(View.INVISIBLE);
                 break;
             case R.id.tsdf:
                 mode = ARMode.TSDF;
                 clearButton.setVisibility(View.VISIBLE);
+                benchmarkButton.setVisibility(View.VISIBLE);
+                sweepButton.setVisibility(View.VISIBLE);
+                saveButton.setVisibility(View.VISIBLE);
+                loadButton.setVisibility(View.VISIBLE);
                 break;
             case R.id.plane:
                 mode = ARMode.PLANE;
                 clearButton.setVisibility(View.VISIBLE);
+                benchmarkButton.setVisibility(View.INVISIBLE);
+                sweepButton.setVisibility(View.INVISIBLE);
+                saveButton.setVisibility(View.INVISIBLE);
+                loadButton.setVisibility(View.INVISIBLE);
                 break;
         }
         Log.i(TAG, "onRadioButtonClicked: mode is now " + mode);
@@ -91,6 +91,55 @@ public class TangoJNINative {
     // clear the current reconstruction
     public static native void clearReconstruction();
 
+    // select the plane reconstruction, 0 octree RANSAC, 1 organized segmentation
+    public static native void setPlaneEngine(int engine);
+
+    // complete the depth map with the reconstructed planes
+    public static native void setPlaneCompletion(boolean enabled);
+
+    // select the TSDF integration, 0 depth image, 1 point cloud
+    public static native void setIntegrationMode(int integrationMode);
+
+    // benchmark the TSDF integration modes on the last frames of the session
+    // recording, results are written to the log
+    public static native void benchmarkReconstruction();
+
+    // sweep the TSDF parameters on a recorded depth session, or the last
+    // recorded frames for an empty path, results are written to the log and
+    // path.csv
+    public static native void sweepReconstruction(String path);
+
+    // record the integrated depth frames to path, an empty path stops it
+    public static native void setSessionRecording(String path);
+
+    // save the TSDF to a map file
+    public static native void saveTsdf(String path);
+
+    // replace the TSDF by a saved map, its chunks load around the camera
+    public static native void loadTsdf(String path);
+
+    // spill distant TSDF chunks to the directory once they exceed the budget
+    public static native void setTsdfStreaming(String directory, int budgetMegabytes);
+
+    // color the TSDF with the color camera, toggling clears the reconstruction
+    public static native void setTsdfColor(boolean enabled);
+
+    // decimate the TSDF mesh with an error bound in meters, 0 disables it
+    public static native void setTsdfDecimation(float maxError);
+
+    // coarse TSDF voxels for distant depth, toggling clears the reconstruction
+    public static native void setTsdfMultiResolution(boolean enabled);
+
+    // occlusion depth ray cast from the TSDF at width x height, 0 renders the mesh
+    public static native void setTsdfRaycast(int width, int height);
+
+    // integrate depth in a mode after moving or turning (degrees) far enough or
+    // seeing enough new space, limited to one frame per minInterval seconds and
+    // forced after maxInterval seconds (0 never)
+    public static native void setKeyframeSettings(int mode, float translation, float rotation,
+                                                  float novelty, double minInterval,
+                                                  double maxInterval);
+
     // changing filter properties
     public static native void setFilterSettings(int diameter, double sigma);
 
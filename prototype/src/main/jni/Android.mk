@@ -76,8 +76,28 @@ LOCAL_SRC_FILES += $(TANGO_GL)/axis.cc \
                    pose_data.cc \
                    scene.cc \
                    chisel_mesh.cc \
+                   parallel_chisel.cc \
+                   color_integrator.cc \
+                   mesh_decimator.cc \
+                   mesh_welder.cc \
+                   chisel_benchmark.cc \
+                   depth_session.cc \
+                   chunk_streamer.cc \
+                   tsdf_map_file.cc \
+                   voxel_codec.cc \
+                   depth_rasterizer.cc \
+                   tsdf_raycaster.cc \
+                   worker_pool.cc \
+                   keyframe_scheduler.cc \
                    plane_mesh.cc \
                    reconstruction_octree.cc \
+                   range_allocator.cc \
+                   mesh_buffer_manager.cc \
+                   reconstruction_scheduler.cc \
+                   plane_statistics.cc \
+                   plane_segmenter.cc \
+                   plane_map.cc \
+                   view_frustum.cc \
                    reconstructor.cc \
                    convex_hull.cc \
                    point_cloud_drawable.cc \
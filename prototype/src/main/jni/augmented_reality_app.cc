@@ -257,6 +257,8 @@ namespace tango_augmented_reality {
                 TANGO_CAMERA_COLOR, &color_camera_intrinsics_);
         if (ret != TANGO_SUCCESS) {
             LOGE("Failed to get camera intrinsics with error code: %d", ret);
+        } else {
+            main_scene_.SetColorIntrinsics(color_camera_intrinsics_);
         }
 
         ret = TangoService_getCameraIntrinsics(
@@ -437,6 +439,67 @@ namespace tango_augmented_reality {
         main_scene_.ClearReconstruction();
     }
 
+    void AugmentedRealityApp::setPlaneEngine(int engine) {
+        main_scene_.SetPlaneEngine(engine);
+    }
+
+    void AugmentedRealityApp::setPlaneCompletion(bool enabled) {
+        main_scene_.SetPlaneCompletion(enabled);
+    }
+
+    void AugmentedRealityApp::setIntegrationMode(int integration_mode) {
+        main_scene_.SetIntegrationMode(integration_mode);
+    }
+
+    void AugmentedRealityApp::benchmarkReconstruction() {
+        main_scene_.BenchmarkReconstruction();
+    }
+
+    void AugmentedRealityApp::sweepReconstruction(const std::string &path) {
+        main_scene_.SweepReconstruction(path);
+    }
+
+    void AugmentedRealityApp::setSessionRecording(const std::string &path) {
+        main_scene_.SetSessionRecording(path);
+    }
+
+    void AugmentedRealityApp::saveTsdf(const std::string &path) {
+        main_scene_.SaveTsdf(path);
+    }
+
+    void AugmentedRealityApp::loadTsdf(const std::string &path) {
+        main_scene_.LoadTsdf(path);
+    }
+
+    void AugmentedRealityApp::setTsdfStreaming(const std::string &directory,
+                                               int budget_megabytes) {
+        main_scene_.SetTsdfStreaming(directory, budget_megabytes);
+    }
+
+    void AugmentedRealityApp::setTsdfColor(bool enabled) {
+        main_scene_.SetTsdfColor(enabled);
+    }
+
+    void AugmentedRealityApp::setTsdfDecimation(float max_error) {
+        main_scene_.SetTsdfDecimation(max_error);
+    }
+
+    void AugmentedRealityApp::setTsdfMultiResolution(bool enabled) {
+        main_scene_.SetTsdfMultiResolution(enabled);
+    }
+
+    void AugmentedRealityApp::setTsdfRaycast(int width, int height) {
+        main_scene_.SetTsdfRaycast(width, height);
+    }
+
+    void AugmentedRealityApp::setKeyframeSettings(int mode, float translation, float rotation,
+                                                  float novelty, double min_interval,
+                                                  double max_interval) {
+        KeyframeSettings settings = {translation, glm::radians(rotation), novelty, min_interval,
+                                     max_interval};
+        main_scene_.SetKeyframeSettings(mode, settings);
+    }
+
     void AugmentedRealityApp::setFilterSettings(int diameter, double sigma) {
         main_scene_.SetFilterSettings(diameter, sigma);
     }
@@ -0,0 +1,243 @@
+#include "tango-augmented-reality/chisel_benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+    // point densities of the replay, every n-th point is kept
+    const int kStrides[] = {1, 2, 4};
+
+    // values of the parameter sweep
+    const int kChunkSizes[] = {8, 16};
+    const float kResolutions[] = {0.03f, 0.04f, 0.06f};
+    const float kTruncationScales[] = {4.0f, 8.0f};
+    const float kCarvingDistances[] = {0.0f, 0.3f};
+
+    double elapsedMilliseconds(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+    }
+}  // namespace
+
+namespace tango_augmented_reality {
+
+    ChiselBenchmark::ChiselBenchmark(WorkerPool &pool, const ParallelChisel &map,
+                                     const chisel::ProjectionIntegrator &integrator,
+                                     const chisel::PinholeCamera &camera,
+                                     const DepthRasterizer &rasterizer, float ray_truncation)
+            : pool_(pool), chunk_size_(map.GetChunkManager().GetChunkSize()),
+              resolution_(map.GetChunkManager().GetResolution()), integrator_(integrator),
+              camera_(camera), rasterizer_(rasterizer), ray_truncation_(ray_truncation),
+              depth_(new chisel::DepthImage<float>(rasterizer.getWidth(),
+                                                   rasterizer.getHeight())) { }
+
+    void ChiselBenchmark::run(const std::vector <DepthSessionFrame> &frames,
+                              std::vector <ChiselBenchmarkResult> &results) {
+        results.clear();
+        if (frames.empty()) {
+            return;
+        }
+        for (int stride : kStrides) {
+            results.push_back(replay(frames, DEPTH_IMAGE, stride));
+            results.push_back(replay(frames, POINT_CLOUD, stride));
+        }
+    }
+
+    int ChiselBenchmark::integrate(ParallelChisel &map, const DepthSessionFrame &frame,
+                                   IntegrationMode mode,
+                                   const chisel::ProjectionIntegrator &integrator, int stride) {
+        // the floats of a frame are the rows of the extrinsic
+        chisel::Transform extrinsic = chisel::Transform();
+        for (int row = 0; row < 4; ++row) {
+            for (int column = 0; column < 4; ++column) {
+                extrinsic(row, column) = frame.transformation[row * 4 + column];
+            }
+        }
+
+        const std::vector <float> *points = &frame.points;
+        if (stride > 1) {
+            points_.clear();
+            for (size_t i = 0; i + 2 < frame.points.size(); i += 3 * stride) {
+                points_.insert(points_.end(), &frame.points[i], &frame.points[i] + 3);
+            }
+            points = &points_;
+        }
+
+        float near = camera_.GetNearPlane();
+        float far = camera_.GetFarPlane();
+        if (mode == POINT_CLOUD) {
+            cloud_.Clear();
+            for (size_t i = 0; i + 2 < points->size(); i += 3) {
+                if ((*points)[i + 2] >= near && (*points)[i + 2] <= far) {
+                    cloud_.AddPoint(chisel::Vec3((*points)[i], (*points)[i + 1],
+                                                 (*points)[i + 2]));
+                }
+            }
+            map.integratePointCloud(pool_, integrator, cloud_, extrinsic, ray_truncation_, far);
+            return points->size() / 3;
+        }
+
+        float *depth = depth_->GetMutableData();
+        rasterizer_.rasterize(points->data(), points->size() / 3, depth);
+        int pixels = rasterizer_.getWidth() * rasterizer_.getHeight();
+        for (int i = 0; i < pixels; ++i) {
+            if (depth[i] < near || depth[i] > far) {
+                depth[i] = 0.0f;
+            }
+        }
+        map.integrateDepthScan(pool_, integrator, depth_, extrinsic, camera_);
+        return points->size() / 3;
+    }
+
+    ChiselBenchmarkResult ChiselBenchmark::replay(const std::vector <DepthSessionFrame> &frames,
+                                                  IntegrationMode mode, int stride) {
+        ChiselBenchmarkResult result = ChiselBenchmarkResult();
+        result.mode = mode;
+        result.stride = stride;
+        result.frames = frames.size();
+
+        ParallelChisel map(chunk_size_, resolution_, false);
+        for (const DepthSessionFrame &frame : frames) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            result.points += integrate(map, frame, mode, integrator_, stride);
+            result.integration_ms += elapsedMilliseconds(start);
+
+            result.touched_chunks += map.GetMeshesToUpdate().size();
+            start = std::chrono::steady_clock::now();
+            map.UpdateMeshes();
+            result.meshing_ms += elapsedMilliseconds(start);
+        }
+
+        const chisel::MeshMap &meshMap = map.GetChunkManager().GetAllMeshes();
+        for (const std::pair <const chisel::ChunkID, chisel::MeshPtr> &mesh : meshMap) {
+            const chisel::Vec3List &vertices = mesh.second->vertices;
+            const std::vector <size_t> &indices = mesh.second->indices;
+            for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+                chisel::Vec3 a = vertices[indices[i + 1]] - vertices[indices[i]];
+                chisel::Vec3 b = vertices[indices[i + 2]] - vertices[indices[i]];
+                result.area += 0.5f * a.cross(b).norm();
+                result.triangles++;
+            }
+        }
+        return result;
+    }
+
+    std::string ChiselBenchmark::describe(const ChiselBenchmarkResult &result) {
+        char line[256];
+        std::snprintf(line, sizeof(line),
+                      "TSDF benchmark %s 1/%d: %d frames, %d points, integration %.2f ms/frame, "
+                              "meshing %.2f ms/frame, %d touched chunks, %d triangles, %.2f m^2",
+                      result.mode == DEPTH_IMAGE ? "depth image" : "point cloud", result.stride,
+                      result.frames, result.points, result.integration_ms / result.frames,
+                      result.meshing_ms / result.frames, result.touched_chunks,
+                      result.triangles, result.area);
+        return line;
+    }
+
+    void ChiselBenchmark::sweep(const std::vector <DepthSessionFrame> &frames,
+                                const std::vector <ChiselParameters> &grid, IntegrationMode mode,
+                                std::vector <ChiselSweepResult> &results) {
+        results.clear();
+        if (frames.empty()) {
+            return;
+        }
+        for (const ChiselParameters &parameters : grid) {
+            results.push_back(replay(frames, parameters, mode));
+        }
+    }
+
+    ChiselSweepResult ChiselBenchmark::replay(const std::vector <DepthSessionFrame> &frames,
+                                              const ChiselParameters &parameters,
+                                              IntegrationMode mode) {
+        ChiselSweepResult result = ChiselSweepResult();
+        result.parameters = parameters;
+        result.frames = frames.size();
+
+        ParallelChisel map(Eigen::Vector3i(parameters.chunk_size, parameters.chunk_size,
+                                           parameters.chunk_size),
+                           parameters.resolution, false);
+        chisel::ProjectionIntegrator integrator = map.createIntegrator(
+                parameters.truncation_scale, parameters.weighting, parameters.carving_distance);
+        size_t chunk_bytes = parameters.chunk_size * parameters.chunk_size *
+                             parameters.chunk_size * sizeof(chisel::DistVoxel);
+        for (const DepthSessionFrame &frame : frames) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            integrate(map, frame, mode, integrator, 1);
+            result.integration_ms += elapsedMilliseconds(start);
+
+            start = std::chrono::steady_clock::now();
+            map.UpdateMeshes();
+            result.meshing_ms += elapsedMilliseconds(start);
+
+            // chisel keeps vertices, normals and colors per corner
+            const chisel::ChunkManager &chunks = map.GetChunkManager();
+            size_t bytes = chunks.GetChunks().size() * chunk_bytes;
+            for (const std::pair <const chisel::ChunkID, chisel::MeshPtr> &mesh :
+                    chunks.GetAllMeshes()) {
+                bytes += (mesh.second->vertices.size() + mesh.second->normals.size() +
+                          mesh.second->colors.size()) * sizeof(chisel::Vec3) +
+                         mesh.second->indices.size() * sizeof(size_t);
+            }
+            result.estimated_peak_bytes = std::max(result.estimated_peak_bytes, bytes);
+        }
+
+        const chisel::ChunkManager &chunks = map.GetChunkManager();
+        result.chunks = chunks.GetChunks().size();
+        for (const std::pair <const chisel::ChunkID, chisel::MeshPtr> &mesh :
+                chunks.GetAllMeshes()) {
+            result.triangles += mesh.second->indices.size() / 3;
+        }
+        return result;
+    }
+
+    std::vector <ChiselParameters> ChiselBenchmark::grid(float weighting) {
+        std::vector <ChiselParameters> grid;
+        for (int chunk_size : kChunkSizes) {
+            for (float resolution : kResolutions) {
+                for (float truncation_scale : kTruncationScales) {
+                    for (float carving_distance : kCarvingDistances) {
+                        ChiselParameters parameters = {chunk_size, resolution, truncation_scale,
+                                                       weighting, carving_distance};
+                        grid.push_back(parameters);
+                    }
+                }
+            }
+        }
+        return grid;
+    }
+
+    std::string ChiselBenchmark::describe(const ChiselSweepResult &result) {
+        const ChiselParameters &parameters = result.parameters;
+        char line[256];
+        std::snprintf(line, sizeof(line),
+                      "TSDF sweep chunk %d, voxel %.3f m, truncation %.1f, weight %.2f, carving "
+                              "%.2f m: integration %.2f ms/frame, meshing %.2f ms/frame, "
+                              "estimated peak %.1f MB, %d chunks, %d triangles",
+                      parameters.chunk_size, parameters.resolution, parameters.truncation_scale,
+                      parameters.weighting, parameters.carving_distance,
+                      result.integration_ms / result.frames, result.meshing_ms / result.frames,
+                      result.estimated_peak_bytes / (1024.0 * 1024.0), result.chunks,
+                      result.triangles);
+        return line;
+    }
+
+    bool ChiselBenchmark::write(const std::string &path,
+                                const std::vector <ChiselSweepResult> &results) {
+        std::ofstream file(path.c_str());
+        file << "chunk_size,resolution,truncation_scale,weighting,carving_distance,frames,"
+                "integration_ms,meshing_ms,estimated_peak_bytes,chunks,triangles\n";
+        for (const ChiselSweepResult &result : results) {
+            const ChiselParameters &parameters = result.parameters;
+            file << parameters.chunk_size << ',' << parameters.resolution << ','
+            << parameters.truncation_scale << ',' << parameters.weighting << ','
+            << parameters.carving_distance << ',' << result.frames << ','
+            << result.integration_ms / result.frames << ','
+            << result.meshing_ms / result.frames << ',' << result.estimated_peak_bytes << ','
+            << result.chunks << ',' << result.triangles << '\n';
+        }
+        return static_cast<bool>(file);
+    }
+
+}  // namespace tango_augmented_reality
@@ -17,8 +17,100 @@
 #include "tango-augmented-reality/chisel_mesh.h"
 #include <tango-gl/shaders.h>
 
+#include <cmath>
+#include <cstring>
+
+
+namespace {
+    // depth frames waiting for the worker, older ones get dropped
+    const size_t kFrameQueueCapacity = 2;
+
+    // time the worker waits for a frame before it checks for shutdown
+    const int kIdleWaitMs = 100;
+
+    // frames kept for the benchmark replay
+    const size_t kRecordedFrames = 30;
+
+    // time each level spends on meshing, welding and decimating before the
+    // worker moves on, the remaining chunks are meshed on the next calls
+    const double kMeshingBudgetMs = 8.0;
+
+    // shader with vertex colors and a global alpha
+    const std::string kColorVertexShader =
+            "precision highp float;\n"
+                    "uniform mat4 mvp;\n"
+                    "attribute vec4 vertex;\n"
+                    "attribute vec3 color;\n"
+                    "varying vec3 v_color;\n"
+                    "void main() {\n"
+                    "  v_color = color;\n"
+                    "  gl_Position = mvp * vertex;\n"
+                    "}\n";
+
+    const std::string kColorFragmentShader =
+            "precision highp float;\n"
+                    "uniform float alpha;\n"
+                    "varying vec3 v_color;\n"
+                    "void main() {\n"
+                    "  gl_FragColor = vec4(v_color, alpha);\n"
+                    "}\n";
+
+    // the ray cast stops behind the far plane of the TSDF levels
+    const float kRaycastMargin = 0.5f;
+
+    // the fine level integrates depth up to this distance plus the overlap,
+    // the coarse level from this distance minus the overlap
+    const float kLevelSwitchDistance = 1.5f;
+
+    // both levels integrate this band, their surfaces overlap instead of
+    // leaving a gap at the switch distance
+    const float kLevelOverlap = 0.25f;
+
+    // voxel size factor of the coarse level, a coarse chunk covers exactly
+    // 2 x 2 x 2 fine chunks
+    const double kCoarseScale = 2.0;
+
+    // the coarse level reaches further than the single resolution TSDF
+    const float kCoarseFarClipping = 4.0f;
+
+    // share of the streaming budget for the voxels of the coarse level
+    const size_t kCoarseBudgetDivisor = 4;
+
+    // the coarse level is saved next to the map with this suffix
+    const char kCoarseSuffix[] = ".coarse";
+
+    // marks the slice keys of the coarse level, chunk keys use 63 bits
+    const uint64_t kCoarseKey = 1ull << 63;
+
+    // packs the chunk coordinates into a slice key, 21 bits per axis
+    uint64_t chunkKey(const chisel::ChunkID &id) {
+        const uint64_t mask = (1 << 21) - 1;
+        return ((static_cast<uint64_t>(id(0)) & mask) << 42) |
+               ((static_cast<uint64_t>(id(1)) & mask) << 21) |
+               (static_cast<uint64_t>(id(2)) & mask);
+    }
+
+    // unpacks a slice key, the axes are sign extended from 21 bits
+    chisel::ChunkID chunkID(uint64_t key) {
+        chisel::ChunkID id;
+        for (int axis = 0; axis < 3; ++axis) {
+            int value = static_cast<int>((key >> (42 - axis * 21)) & ((1 << 21) - 1));
+            id(axis) = value >= (1 << 20) ? value - (1 << 21) : value;
+        }
+        return id;
+    }
+}  // namespace
+
 namespace tango_augmented_reality {
-    ChiselMesh::ChiselMesh() {
+    ChiselMesh::ChiselMesh() : frames_(kFrameQueueCapacity), raycast_width_(0),
+                               raycast_height_(0), buffers_(true), initialized_(false),
+                               running_(true), clear_requested_(false),
+                               benchmark_requested_(false), raycast_requested_(false),
+                               save_requested_(false), load_requested_(false),
+                               session_changed_(false), sweep_requested_(false),
+                               integration_mode_(DEPTH_IMAGE),
+                               color_enabled_(false), multi_resolution_(false),
+                               map_colors_(false) {
         render_mode_ = GL_TRIANGLES;
         SetShader();
 
@@ -32,73 +124,423 @@ namespace tango_augmented_reality {
         rayTruncation = 0.5;
 
 
-        chiselMap = chisel::ChiselPtr(
-                new chisel::Chisel(Eigen::Vector3i(chunkSize, chunkSize, chunkSize),
-                                   chunkResolution, false));
-        // float quadratic, float linear, float constant, float scale
-        chisel::TruncatorPtr truncator(new chisel::QuadraticTruncator(0.0030, 0.00152, 0.001504, 8.0));
-        chisel::ConstantWeighterPtr weighter(new chisel::ConstantWeighter(weighting));
+        chiselMap = createMap();
+        // packed voxel weights count observations
+        streamer_.setWeightStep(weighting);
+        coarse_streamer_.setWeightStep(weighting);
+        float carving = enableCarving ? carvingDistance : 0.0f;
+        projectionIntegrator = chiselMap->createIntegrator(truncationDistScale, weighting,
+                                                           carving);
 
-        chisel::Vec3List centroids;
-        projectionIntegrator = chisel::ProjectionIntegrator(truncator, weighter, carvingDistance,
-                                                            enableCarving, centroids);
-        projectionIntegrator.SetCentroids(chiselMap->GetChunkManager().GetCentroids());
+        // the centroids depend on the voxel size, so each level has its integrator
+        coarseIntegrator = createMap(false, kCoarseScale)->createIntegrator(truncationDistScale,
+                                                                            weighting, carving);
         LOGI("chisel container was created in native environment");
+
+        worker_ = std::thread(&ChiselMesh::run, this);
     }
 
-    void ChiselMesh::addPoints(glm::mat4 transformation, TangoCameraIntrinsics intrinsics,
-                               TangoXYZij *XYZij) {
+    ChiselMesh::~ChiselMesh() {
+        running_ = false;
+        frames_.notify();
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+    }
 
-        LOGE("Interpolating depth %d x %d", intrinsics.width, intrinsics.height);
+    void ChiselMesh::addFrame(glm::mat4 transformation, const TangoXYZij *XYZij,
+                              const uint8_t *nv21, int color_width, int color_height) {
+        ChiselFrame frame;
+        frame.transformation = transformation;
+        frame.timestamp = XYZij->timestamp;
+        frame.points.assign(&XYZij->xyz[0][0], &XYZij->xyz[0][0] + XYZij->xyz_count * 3);
+        frame.color_width = color_width;
+        frame.color_height = color_height;
+        if (color_enabled_ && nv21 != nullptr) {
+            frame.color.assign(nv21, nv21 + color_width * color_height * 3 / 2);
+        }
+        if (frames_.push(std::move(frame))) {
+            LOGI("TSDF integration is behind, dropped a depth frame");
+        }
+    }
 
-        TangoSupportDepthInterpolator *depth_interpolator;
-        TangoSupport_createDepthInterpolator(&intrinsics, &depth_interpolator);
+    void ChiselMesh::run() {
+        while (running_) {
+            ChiselFrame frame;
+            // without frames the pending chunks are still meshed
+            bool has_frame = frames_.pop(frame, meshes_pending_ ? 0 : kIdleWaitMs);
 
-        TangoSupportDepthBuffer depth_buffer;
-        TangoSupport_initializeDepthBuffer(intrinsics.width, intrinsics.height, &depth_buffer);
+            if (clear_requested_.exchange(false)) {
+                reset();
+                continue;
+            }
+            if (load_requested_.exchange(false)) {
+                reset();
+                std::string path = getMapPath();
+                streamer_.open(chiselMap->GetChunkManager(), path);
+                if (coarseMap) {
+                    coarse_streamer_.open(coarseMap->GetChunkManager(), path + kCoarseSuffix);
+                }
+                continue;
+            }
+            if (save_requested_.exchange(false)) {
+                std::string path = getMapPath();
+                streamer_.save(chiselMap->GetChunkManager(), path);
+                if (coarseMap) {
+                    coarse_streamer_.save(coarseMap->GetChunkManager(), path + kCoarseSuffix);
+                }
+            }
+            if (benchmark_requested_.exchange(false)) {
+                std::vector <DepthSessionFrame> frames(recorded_.begin(), recorded_.end());
+                std::vector <ChiselBenchmarkResult> results;
+                createBenchmark().run(frames, results);
+                if (results.empty()) {
+                    LOGE("No recorded frames to benchmark, record a depth session first");
+                }
+                for (const ChiselBenchmarkResult &result : results) {
+                    LOGI("%s", ChiselBenchmark::describe(result).c_str());
+                }
+            }
+            if (session_changed_.exchange(false)) {
+                updateSession();
+            }
+            if (sweep_requested_.exchange(false)) {
+                sweepParameters();
+            }
+            if (raycast_requested_.exchange(false)) {
+                raycastDepth();
+            }
+            if (has_frame && initialized_) {
+                // chunks the frame can reach have to be in memory before integrating
+                chisel::Vec3 camera(frame.transformation[0][3], frame.transformation[1][3],
+                                    frame.transformation[2][3]);
+                // the depth camera looks along its z axis
+                meshing_camera_ = camera;
+                meshing_forward_ = chisel::Vec3(frame.transformation[0][2],
+                                                frame.transformation[1][2],
+                                                frame.transformation[2][2]);
+                // point cloud rays reach rayTruncation behind the farthest point
+                float behind = getIntegrationMode() == POINT_CLOUD ? rayTruncation : 0.0f;
+                stream(streamer_, *chiselMap, slices_, camera, farClipping + behind);
+                if (coarseMap) {
+                    stream(coarse_streamer_, *coarseMap, coarse_slices_, camera,
+                           kCoarseFarClipping + behind);
+                }
+                addPoints(frame);
+                updateVertices();
+                if (session_.isOpen()) {
+                    recordFrame(frame);
+                }
+            } else if (meshes_pending_ && initialized_) {
+                updateVertices();
+            }
+        }
+    }
 
+    void ChiselMesh::reset() {
+        if (map_colors_ != color_enabled_) {
+            // color voxels are allocated with the chunks, so the map is rebuilt
+            map_colors_ = color_enabled_;
+            chiselMap = createMap(map_colors_);
+        } else {
+            chiselMap->Reset();
+        }
+        coarseMap = multi_resolution_ ? createMap(map_colors_, kCoarseScale) : nullptr;
+        {
+            // the fine level stops at the switch distance with a coarse level
+            std::lock_guard <std::mutex> lock(camera_mutex_);
+            pinHoleCamera.SetFarPlane(coarseMap ? kLevelSwitchDistance + kLevelOverlap
+                                                : farClipping);
+        }
+        streamer_.clear();
+        coarse_streamer_.clear();
+        recorded_.clear();
+        slices_.clear();
+        coarse_slices_.clear();
+        meshes_pending_ = false;
+        meshes_.back().clear();
+        meshes_.publish();
+    }
 
-        TangoPoseData pose;
+    std::string ChiselMesh::getMapPath() {
+        std::lock_guard <std::mutex> lock(map_path_mutex_);
+        return map_path_;
+    }
 
-        pose.orientation[0] = 0;
-        pose.orientation[1] = 0;
-        pose.orientation[2] = 0;
-        pose.orientation[3] = 0;
+    void ChiselMesh::save(const std::string &path) {
+        {
+            std::lock_guard <std::mutex> lock(map_path_mutex_);
+            map_path_ = path;
+        }
+        save_requested_ = true;
+        frames_.notify();
+    }
 
-        pose.translation[0] = 0;
-        pose.translation[1] = 0;
-        pose.translation[2] = 0;
+    void ChiselMesh::load(const std::string &path) {
+        {
+            std::lock_guard <std::mutex> lock(map_path_mutex_);
+            map_path_ = path;
+        }
+        // frames of the old map must not end up in the loaded one
+        frames_.clear();
+        load_requested_ = true;
+        frames_.notify();
+    }
 
+    void ChiselMesh::addPoints(const ChiselFrame &frame) {
+        IntegrationMode mode = getIntegrationMode();
+        integrate(*chiselMap, frame, mode);
+        integrateColor(*chiselMap, frame);
+        if (coarseMap) {
+            integrate(*coarseMap, frame, mode, coarseIntegrator, coarseCamera);
+            integrateColor(*coarseMap, frame);
+        }
+    }
 
-        if (TangoSupport_upsampleImageNearestNeighbor(depth_interpolator, XYZij, &pose, &depth_buffer) !=
-            TANGO_SUCCESS) {
-            LOGE("Error upsampling the image.");
+    void ChiselMesh::integrateColor(ParallelChisel &map, const ChiselFrame &frame) {
+        if (!map_colors_ || frame.color.empty()) {
             return;
         }
+        // only the chunks touched by this frame are colored
+        const chisel::ChunkIDList &integrated = map.getIntegratedChunks();
+        std::vector <chisel::ChunkID> touched(integrated.begin(), integrated.end());
+        std::lock_guard <std::mutex> lock(camera_mutex_);
+        color_integrator_.integrate(map.GetMutableChunkManager(), touched, frame.transformation,
+                                    frame.color.data(), frame.color_width, frame.color_height);
+    }
 
-        lastDepthImage->SetData(depth_buffer.depths);
+    void ChiselMesh::integrate(ParallelChisel &map, const ChiselFrame &frame,
+                               IntegrationMode mode) {
+        integrate(map, frame, mode, projectionIntegrator, pinHoleCamera);
+    }
 
+    void ChiselMesh::integrate(ParallelChisel &map, const ChiselFrame &frame,
+                               IntegrationMode mode, chisel::ProjectionIntegrator &integrator,
+                               const chisel::PinholeCamera &camera) {
         chisel::Transform extrinsic = chisel::Transform();
         for (int j = 0; j < 4; ++j) {
             for (int k = 0; k < 4; ++k) {
-                extrinsic(k, j) = transformation[k][j];
+                extrinsic(k, j) = frame.transformation[k][j];
+            }
+        }
+
+        std::lock_guard <std::mutex> lock(camera_mutex_);
+        float near = camera.GetNearPlane();
+        float far = camera.GetFarPlane();
+
+        if (mode == POINT_CLOUD) {
+            lastPointCloud.Clear();
+            for (size_t i = 0; i + 2 < frame.points.size(); i += 3) {
+                if (frame.points[i + 2] >= near && frame.points[i + 2] <= far) {
+                    lastPointCloud.AddPoint(chisel::Vec3(frame.points[i], frame.points[i + 1],
+                                                         frame.points[i + 2]));
+                }
+            }
+            map.integratePointCloud(pool_, integrator, lastPointCloud, extrinsic, rayTruncation,
+                                    far);
+            return;
+        }
+
+        // the depth image is reused for every frame, chisel only reads it
+        float *depth = lastDepthImage->GetMutableData();
+        rasterizer_.rasterize(frame.points.data(), frame.points.size() / 3, depth);
+
+        // depth outside of the range of the level counts as missing
+        int pixels = rasterizer_.getWidth() * rasterizer_.getHeight();
+        for (int i = 0; i < pixels; ++i) {
+            if (depth[i] < near || depth[i] > far) {
+                depth[i] = 0.0f;
+            }
+        }
+
+        // the chunks of the frustum are integrated on all cores
+        map.integrateDepthScan(pool_, integrator, lastDepthImage, extrinsic, camera);
+    }
+
+    ParallelChiselPtr ChiselMesh::createMap(bool colors, double scale) const {
+        return ParallelChiselPtr(
+                new ParallelChisel(Eigen::Vector3i(chunkSize, chunkSize, chunkSize),
+                                   chunkResolution * scale, colors));
+    }
+
+    void ChiselMesh::setRaycastResolution(int width, int height) {
+        std::lock_guard <std::mutex> lock(raycast_mutex_);
+        raycast_width_ = width;
+        raycast_height_ = height;
+    }
+
+    void ChiselMesh::requestDepth(const glm::mat4 &view_projection) {
+        {
+            std::lock_guard <std::mutex> lock(raycast_mutex_);
+            if (raycast_width_ == 0 || raycast_height_ == 0) {
+                return;
             }
+            raycast_view_projection_ = view_projection;
+        }
+        // requests coming in faster than the worker casts are merged
+        raycast_requested_ = true;
+        frames_.notify();
+    }
+
+    void ChiselMesh::raycastDepth() {
+        glm::mat4 view_projection;
+        {
+            std::lock_guard <std::mutex> lock(raycast_mutex_);
+            view_projection = raycast_view_projection_;
+            raycaster_.setResolution(raycast_width_, raycast_height_);
         }
+        RaycastDepth &image = depths_.back();
+        image.width = raycaster_.getWidth();
+        image.height = raycaster_.getHeight();
+        image.depth.assign(image.width * image.height, 1.0f);
+
+        // both levels are cast, the closer surface wins in the overlap
+        float distance = (coarseMap ? kCoarseFarClipping : farClipping) + kRaycastMargin;
+        raycaster_.raycast(chiselMap->GetChunkManager(), view_projection, distance, pool_,
+                           image.depth);
+        if (coarseMap) {
+            raycaster_.raycast(coarseMap->GetChunkManager(), view_projection, distance, pool_,
+                               image.depth);
+        }
+        depths_.publish();
+    }
 
+    void ChiselMesh::setMultiResolution(bool enabled) {
+        multi_resolution_ = enabled;
+        clear();
+    }
 
-        chiselMap->IntegrateDepthScan<float>(
-                projectionIntegrator,
-                lastDepthImage,
-                extrinsic,
-                pinHoleCamera
-        );
+    void ChiselMesh::setColorIntegration(bool enabled) {
+        color_enabled_ = enabled;
+        clear();
+    }
 
-        TangoSupport_freeDepthBuffer(&depth_buffer);
-        TangoSupport_freeDepthInterpolator(depth_interpolator);
+    void ChiselMesh::setDecimation(float max_error) {
+        decimator_.setMaxError(max_error);
+    }
 
+    void ChiselMesh::setStreaming(const std::string &directory, size_t budget) {
+        streamer_.setDirectory(directory);
+        streamer_.setBudget(budget - budget / kCoarseBudgetDivisor);
+        // the coarse level has its own spill map inside the directory
+        coarse_streamer_.setDirectory(directory.empty() ? directory : directory + "/coarse");
+        coarse_streamer_.setBudget(budget / kCoarseBudgetDivisor);
+    }
+
+    void ChiselMesh::stream(ChunkStreamer &streamer, ParallelChisel &map, MeshSliceMap &slices,
+                            const chisel::Vec3 &camera, float reach) {
+        const chisel::ChunkManager &chunks = map.GetChunkManager();
+        float diagonal = std::sqrt(3.0f) * chunks.GetChunkSize()(0) * chunks.GetResolution();
+        std::vector <chisel::ChunkID> loaded;
+        std::vector <chisel::ChunkID> merged;
+        streamer.update(map.GetMutableChunkManager(), camera, reach + diagonal, &loaded, &merged);
+        for (const chisel::ChunkID &id : loaded) {
+            // chunks of a loaded map have no slice yet
+            if (slices.find(chunkKey(id)) == slices.end()) {
+                map.remeshChunk(id);
+            }
+        }
+        for (const chisel::ChunkID &id : merged) {
+            map.remeshChunk(id);
+        }
+    }
+
+    void ChiselMesh::benchmark() {
+        benchmark_requested_ = true;
+        frames_.notify();
+    }
+
+    void ChiselMesh::sweep(const std::string &path) {
+        {
+            std::lock_guard <std::mutex> lock(session_mutex_);
+            sweep_path_ = path;
+        }
+        sweep_requested_ = true;
+        frames_.notify();
+    }
+
+    void ChiselMesh::setSessionRecording(const std::string &path) {
+        {
+            std::lock_guard <std::mutex> lock(session_mutex_);
+            session_path_ = path;
+        }
+        session_changed_ = true;
+        frames_.notify();
+    }
+
+    void ChiselMesh::updateSession() {
+        std::string path;
+        {
+            std::lock_guard <std::mutex> lock(session_mutex_);
+            path = session_path_;
+        }
+        session_.close();
+        if (path.empty()) {
+            // the last frames stay for the benchmark until the next recording
+            return;
+        }
+        recorded_.clear();
+        if (session_.create(path)) {
+            LOGI("Recording the depth session %s", path.c_str());
+        } else {
+            LOGE("Could not create the depth session %s", path.c_str());
+        }
+    }
+
+    void ChiselMesh::recordFrame(ChiselFrame &frame) {
+        // the benchmark only replays depth
+        DepthSessionFrame recorded;
+        recorded.timestamp = frame.timestamp;
+        std::memcpy(recorded.transformation, glm::value_ptr(frame.transformation),
+                    sizeof(recorded.transformation));
+        recorded.points.swap(frame.points);
+        if (!session_.append(recorded)) {
+            LOGE("Could not record the depth frame, the recording stops");
+            session_.close();
+        }
+        recorded_.push_back(std::move(recorded));
+        if (recorded_.size() > kRecordedFrames) {
+            recorded_.pop_front();
+        }
+    }
+
+    void ChiselMesh::sweepParameters() {
+        std::string path;
+        {
+            std::lock_guard <std::mutex> lock(session_mutex_);
+            path = sweep_path_;
+        }
+        std::vector <DepthSessionFrame> frames;
+        if (path.empty()) {
+            frames.assign(recorded_.begin(), recorded_.end());
+        } else if (!DepthSession::load(path, frames)) {
+            LOGE("Could not read the depth session %s", path.c_str());
+            return;
+        }
+        std::vector <ChiselSweepResult> results;
+        createBenchmark().sweep(frames, ChiselBenchmark::grid(weighting), getIntegrationMode(),
+                                results);
+        if (results.empty()) {
+            LOGE("No recorded frames to sweep the TSDF parameters");
+        }
+        for (const ChiselSweepResult &result : results) {
+            LOGI("%s", ChiselBenchmark::describe(result).c_str());
+        }
+        if (!path.empty() && !ChiselBenchmark::write(path + ".csv", results)) {
+            LOGE("Could not write the sweep results next to %s", path.c_str());
+        }
+    }
+
+    ChiselBenchmark ChiselMesh::createBenchmark() {
+        std::lock_guard <std::mutex> lock(camera_mutex_);
+        return ChiselBenchmark(pool_, *chiselMap, projectionIntegrator, pinHoleCamera, rasterizer_,
+                               rayTruncation);
     }
 
     void ChiselMesh::init(TangoCameraIntrinsics intrinsics) {
+        std::lock_guard <std::mutex> lock(camera_mutex_);
+        rasterizer_.setIntrinsics(intrinsics.fx, intrinsics.fy, intrinsics.cx, intrinsics.cy,
+                                  intrinsics.width, intrinsics.height);
 
         lastDepthImage.reset(new chisel::DepthImage<float>(intrinsics.width, intrinsics.height));
 
@@ -113,38 +555,153 @@ namespace tango_augmented_reality {
         pinHoleCamera.SetFarPlane(2.0);
         pinHoleCamera.SetIntrinsics(chiselIntrinsics);
 
+        coarseCamera.SetWidth(intrinsics.width);
+        coarseCamera.SetHeight(intrinsics.height);
+        coarseCamera.SetNearPlane(kLevelSwitchDistance - kLevelOverlap);
+        coarseCamera.SetFarPlane(kCoarseFarClipping);
+        coarseCamera.SetIntrinsics(chiselIntrinsics);
+        initialized_ = true;
+    }
+
+    void ChiselMesh::setColorIntrinsics(TangoCameraIntrinsics intrinsics) {
+        std::lock_guard <std::mutex> lock(camera_mutex_);
+        color_integrator_.setIntrinsics(intrinsics.fx, intrinsics.fy, intrinsics.cx,
+                                        intrinsics.cy, intrinsics.width, intrinsics.height);
     }
 
     void ChiselMesh::updateVertices() {
-        chiselMap->UpdateMeshes();
-        LOGI("Generating Mesh ...");
-        chisel::MeshMap meshMap = chiselMap->GetChunkManager().GetAllMeshes();
-        LOGI("Map with %d items", meshMap.size());
+        meshes_pending_ = false;
+        bool changed = remesh(*chiselMap, slices_);
+        if (coarseMap && remesh(*coarseMap, coarse_slices_)) {
+            changed = true;
+        }
+        if (!changed) {
+            return;
+        }
 
-        std::vector <GLfloat> mesh;
-        for (const std::pair <chisel::ChunkID, chisel::MeshPtr> &meshes : meshMap) {
-            for (size_t &index: meshes.second->indices) {
-                mesh.push_back(meshes.second->vertices[index](0));
-                mesh.push_back(meshes.second->vertices[index](1));
-                mesh.push_back(meshes.second->vertices[index](2));
+        // the published map only copies slice pointers, unchanged slices keep
+        // their place in the GPU buffers
+        MeshSliceMap &published = meshes_.back();
+        published = slices_;
+        for (const std::pair <const uint64_t, MeshSlicePtr> &slice : coarse_slices_) {
+            // coarse chunks are only drawn where the fine level has not been
+            if (!isCoveredByFineLevel(chunkID(slice.first), *slice.second)) {
+                published[slice.first | kCoarseKey] = slice.second;
             }
         }
-        LOGI("Got %d polygons", mesh.size() / 3);
+        meshes_.publish();
+    }
 
-        {
-            std::lock_guard <std::mutex> lock(render_mutex);
-            SetVertices(mesh);
+    bool ChiselMesh::remesh(ParallelChisel &map, MeshSliceMap &slices) {
+        // a fast sweep marks hundreds of chunks, they drain over several calls.
+        // Welding and decimation run per chunk inside the budget, decimation
+        // takes longer than marching cubes.
+        size_t remeshed = 0;
+        size_t indexCount = 0;
+        size_t pending = map.updateMeshes(
+                meshing_camera_, meshing_forward_, kMeshingBudgetMs,
+                [&](const chisel::ChunkID &id) {
+                    indexCount += updateSlice(map, slices, id);
+                    remeshed++;
+                });
+        if (pending > 0) {
+            meshes_pending_ = true;
+        }
+        if (remeshed == 0) {
+            return false;
+        }
+        LOGI("Remeshed %d of %d chunks with %d polygons, %d chunks pending", remeshed,
+             slices.size(), indexCount / 3, pending);
+        return true;
+    }
+
+    size_t ChiselMesh::updateSlice(ParallelChisel &map, MeshSliceMap &slices,
+                                   const chisel::ChunkID &id) {
+        // only the slices of remeshed chunks are rebuilt, the others are shared
+        const chisel::MeshMap &meshMap = map.GetChunkManager().GetAllMeshes();
+        chisel::MeshMap::const_iterator mesh = meshMap.find(id);
+        if (mesh == meshMap.end() || mesh->second->indices.empty()) {
+            slices.erase(chunkKey(id));
+            return 0;
         }
+        // chisel emits a triangle soup, shared vertices are stored once
+        std::shared_ptr <MeshSlice> slice = std::make_shared<MeshSlice>();
+        bool colors = mesh->second->colors.size() == mesh->second->vertices.size();
+        welder_.clear();
+        slice->indices.reserve(mesh->second->indices.size());
+        for (const size_t &index : mesh->second->indices) {
+            const chisel::Vec3 &vertex = mesh->second->vertices[index];
+            GLuint welded = welder_.add(vertex(0), vertex(1), vertex(2));
+            if (colors && welded == slice->colors.size() / 3) {
+                const chisel::Vec3 &color = mesh->second->colors[index];
+                slice->colors.push_back(color(0));
+                slice->colors.push_back(color(1));
+                slice->colors.push_back(color(2));
+            }
+            slice->indices.push_back(welded);
+        }
+        slice->vertices = welder_.getVertices();
+        // flat walls collapse into a few large triangles, chunk borders are kept
+        decimator_.decimate(slice->vertices, slice->indices, slice->colors);
+        slice->updateBounds();
+        if (&map == coarseMap.get()) {
+            updateFineCells(id, *slice);
+        }
+        slices[chunkKey(id)] = slice;
+        return slice->indices.size();
+    }
+
+    void ChiselMesh::updateFineCells(const chisel::ChunkID &coarse, MeshSlice &slice) const {
+        float extent = static_cast<float>(chunkSize * chunkResolution);
+        glm::vec3 origin(coarse(0) * 2 * extent, coarse(1) * 2 * extent, coarse(2) * 2 * extent);
+        slice.fine_cells = 0;
+        for (size_t i = 0; i + 2 < slice.vertices.size() && slice.fine_cells != 0xff; i += 3) {
+            int index = 0;
+            for (int axis = 0; axis < 3; ++axis) {
+                float offset = (slice.vertices[i + axis] - origin[axis]) / extent;
+                index = index * 2 + (offset < 1.0f ? 0 : 1);
+            }
+            slice.fine_cells |= 1 << index;
+        }
+    }
+
+    bool ChiselMesh::isCoveredByFineLevel(const chisel::ChunkID &coarse,
+                                          const MeshSlice &slice) const {
+        // every fine chunk the coarse surface passes through needs a surface of
+        // its own, evicted fine chunks keep their slice
+        for (int index = 0; index < 8; ++index) {
+            if (!(slice.fine_cells & (1 << index))) {
+                continue;
+            }
+            chisel::ChunkID fine(coarse(0) * 2 + (index >> 2), coarse(1) * 2 + ((index >> 1) & 1),
+                                 coarse(2) * 2 + (index & 1));
+            if (slices_.find(chunkKey(fine)) == slices_.end()) {
+                return false;
+            }
+        }
+        return true;
     }
 
     void ChiselMesh::clear() {
-        std::lock_guard <std::mutex> lock(render_mutex);
-        std::vector <GLfloat> mesh;
-        SetVertices(mesh);
-        chiselMap->Reset();
+        // the worker owns the TSDF, it resets it and publishes an empty mesh
+        frames_.clear();
+        clear_requested_ = true;
+        frames_.notify();
     }
 
-    ChiselMesh::ChiselMesh(GLenum render_mode) {
+    ChiselMesh::ChiselMesh(GLenum render_mode) : frames_(kFrameQueueCapacity),
+                                                 raycast_width_(0), raycast_height_(0),
+                                                 buffers_(true), initialized_(false),
+                                                 running_(false), clear_requested_(false),
+                                                 benchmark_requested_(false),
+                                                 raycast_requested_(false),
+                                                 save_requested_(false),
+                                                 load_requested_(false),
+                                                 session_changed_(false),
+                                                 sweep_requested_(false),
+                                                 integration_mode_(DEPTH_IMAGE),
+                                                 color_enabled_(false),
+                                                 multi_resolution_(false), map_colors_(false) {
         render_mode_ = render_mode;
     }
 
@@ -161,31 +718,48 @@ namespace tango_augmented_reality {
 
         SetColor(1.0, 0.0, 0.0);
         SetAlpha(0.4);
+
+        color_program_ = tango_gl::util::CreateProgram(kColorVertexShader.c_str(),
+                                                       kColorFragmentShader.c_str());
+        if (!color_program_) {
+            LOGE("Could not create color program.");
+        }
+        uniform_color_mvp_ = glGetUniformLocation(color_program_, "mvp");
+        uniform_color_alpha_ = glGetUniformLocation(color_program_, "alpha");
+        attrib_color_vertices_ = glGetAttribLocation(color_program_, "vertex");
+        attrib_colors_ = glGetAttribLocation(color_program_, "color");
     }
 
     void ChiselMesh::Render(const glm::mat4 &projection_mat,
                             const glm::mat4 &view_mat) const {
-        glUseProgram(shader_program_);
         glm::mat4 model_mat = GetTransformationMatrix();
         glm::mat4 mv_mat = view_mat * model_mat;
         glm::mat4 mvp_mat = projection_mat * mv_mat;
-        glUniformMatrix4fv(uniform_mvp_mat_, 1, GL_FALSE, glm::value_ptr(mvp_mat));
-        glUniform4f(uniform_color_, red_, green_, blue_, alpha_);
 
-        glEnableVertexAttribArray(attrib_vertices_);
+        // take over the newest slices of the worker and upload the changed ones
+        if (meshes_.update()) {
+            buffers_.update(meshes_.front());
+        }
 
-        if (!indices_.empty()) {
-            glVertexAttribPointer(attrib_vertices_, 3, GL_FLOAT, GL_FALSE,
-                                  3 * sizeof(GLfloat), vertices_.data());
-            glDrawElements(render_mode_, indices_.size(), GL_UNSIGNED_SHORT,
-                           indices_.data());
+        // chunks outside of the camera frustum are skipped
+        if (color_enabled_) {
+            glUseProgram(color_program_);
+            glUniformMatrix4fv(uniform_color_mvp_, 1, GL_FALSE, glm::value_ptr(mvp_mat));
+            glUniform1f(uniform_color_alpha_, alpha_);
+            glEnableVertexAttribArray(attrib_color_vertices_);
+            glEnableVertexAttribArray(attrib_colors_);
+            buffers_.draw(render_mode_, attrib_color_vertices_, attrib_colors_,
+                          ViewFrustum(mvp_mat));
+            glDisableVertexAttribArray(attrib_colors_);
+            glDisableVertexAttribArray(attrib_color_vertices_);
         } else {
-            glVertexAttribPointer(attrib_vertices_, 3, GL_FLOAT, GL_FALSE,
-                                  3 * sizeof(GLfloat), &vertices_[0]);
-            glDrawArrays(render_mode_, 0, vertices_.size() / 3);
+            glUseProgram(shader_program_);
+            glUniformMatrix4fv(uniform_mvp_mat_, 1, GL_FALSE, glm::value_ptr(mvp_mat));
+            glUniform4f(uniform_color_, red_, green_, blue_, alpha_);
+            glEnableVertexAttribArray(attrib_vertices_);
+            buffers_.draw(render_mode_, attrib_vertices_, ViewFrustum(mvp_mat));
+            glDisableVertexAttribArray(attrib_vertices_);
         }
-
-        glDisableVertexAttribArray(attrib_vertices_);
         glUseProgram(0);
     }
 }  // namespace tango_augmented_reality
@@ -0,0 +1,345 @@
+#include "tango-augmented-reality/chunk_streamer.h"
+
+#include <android/log.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+
+// the chisel module builds the streamer as well, which has no tango-gl
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO   , "Native",__VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR  , "Native",__VA_ARGS__)
+
+namespace {
+    // chunks are evicted this far behind the radius, so a camera moving along
+    // the border does not load and evict the same chunks over and over
+    const float kEvictionMargin = 0.5f;
+
+    // name of the spill map inside the directory
+    const char kSpillFile[] = "/spill.tsdf";
+
+    // folds the voxels of an evicted copy into the chunk which was created
+    // again in its place, as if both had been integrated into one chunk
+    void mergeChunk(const chisel::Chunk &evicted, chisel::Chunk &chunk) {
+        bool colors = evicted.HasColors() && chunk.HasColors();
+        for (int i = 0; i < chunk.GetTotalNumVoxels(); ++i) {
+            const chisel::DistVoxel &old_voxel = evicted.GetDistVoxel(i);
+            float old_weight = old_voxel.GetWeight();
+            if (old_weight <= 0.0f) {
+                continue;
+            }
+            chisel::DistVoxel &voxel = chunk.GetDistVoxelMutable(i);
+            float weight = voxel.GetWeight() + old_weight;
+            voxel.SetSDF((voxel.GetSDF() * voxel.GetWeight() + old_voxel.GetSDF() * old_weight) /
+                         weight);
+            voxel.SetWeight(weight);
+
+            if (!colors) {
+                continue;
+            }
+            const chisel::ColorVoxel &old_color = evicted.GetColorVoxel(i);
+            chisel::ColorVoxel &color = chunk.GetColorVoxelMutable(i);
+            int old_samples = old_color.GetWeight();
+            if (old_samples == 0) {
+                continue;
+            }
+            int samples = color.GetWeight() + old_samples;
+            color.SetRed(static_cast<uint8_t>(
+                    (color.GetRed() * color.GetWeight() + old_color.GetRed() * old_samples) /
+                    samples));
+            color.SetGreen(static_cast<uint8_t>(
+                    (color.GetGreen() * color.GetWeight() + old_color.GetGreen() * old_samples) /
+                    samples));
+            color.SetBlue(static_cast<uint8_t>(
+                    (color.GetBlue() * color.GetWeight() + old_color.GetBlue() * old_samples) /
+                    samples));
+            color.SetWeight(static_cast<uint8_t>(std::min(samples, 255)));
+        }
+    }
+}  // namespace
+
+namespace tango_augmented_reality {
+
+    ChunkStreamer::ChunkStreamer() : budget_(0), radius_(4.0f), weight_step_(1.0f) { }
+
+    ChunkStreamer::~ChunkStreamer() {
+        clear();
+    }
+
+    void ChunkStreamer::setDirectory(const std::string &directory) {
+        std::lock_guard <std::mutex> lock(settings_mutex_);
+        if (!directory.empty() && mkdir(directory.c_str(), 0700) != 0 && errno != EEXIST) {
+            LOGE("Could not create the chunk directory %s", directory.c_str());
+            return;
+        }
+        directory_ = directory;
+    }
+
+    void ChunkStreamer::setBudget(size_t bytes) {
+        std::lock_guard <std::mutex> lock(settings_mutex_);
+        budget_ = bytes;
+    }
+
+    void ChunkStreamer::setRadius(float radius) {
+        std::lock_guard <std::mutex> lock(settings_mutex_);
+        radius_ = radius;
+    }
+
+    void ChunkStreamer::setWeightStep(float weight_step) {
+        std::lock_guard <std::mutex> lock(settings_mutex_);
+        weight_step_ = weight_step;
+    }
+
+    void ChunkStreamer::update(chisel::ChunkManager &chunks, const chisel::Vec3 &camera,
+                               float keep_radius, std::vector <chisel::ChunkID> *loaded,
+                               std::vector <chisel::ChunkID> *merged) {
+        std::string directory;
+        size_t budget;
+        float radius;
+        float weight_step;
+        {
+            std::lock_guard <std::mutex> lock(settings_mutex_);
+            directory = directory_;
+            budget = budget_;
+            radius = std::max(radius_, keep_radius);
+            weight_step = weight_step_;
+        }
+        if (directory != active_directory_) {
+            if (spill_.getChunkCount() == 0 && packed_.empty()) {
+                spill_.close();
+                active_directory_ = directory;
+            } else {
+                LOGE("Chunks are evicted to %s, keeping the directory", active_directory_.c_str());
+            }
+        }
+        if (active_directory_.empty() && budget == 0 && evicted_.empty()) {
+            return;
+        }
+        const Eigen::Vector3i &size = chunks.GetChunkSize();
+        const size_t chunk_bytes = size(0) * size(1) * size(2) * sizeof(chisel::DistVoxel);
+        size_t resident = chunks.GetChunks().size() * chunk_bytes;
+
+        // load the nearest evicted chunks inside the radius while the budget allows
+        std::vector <Candidate> candidates;
+        for (const std::pair <const chisel::ChunkID, Store> &chunk : evicted_) {
+            float distance = getDistance(chunks, chunk.first, camera);
+            if (distance <= radius) {
+                Candidate candidate = {distance, chunk.first};
+                candidates.push_back(candidate);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const Candidate &a, const Candidate &b) { return a.distance < b.distance; });
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            if (candidates[i].distance > keep_radius && budget > 0 &&
+                resident + chunk_bytes > budget) {
+                break;
+            }
+            bool exists = chunks.HasChunk(candidates[i].id);
+            if (!load(chunks, candidates[i].id)) {
+                continue;
+            }
+            if (exists) {
+                if (merged != nullptr) {
+                    merged->push_back(candidates[i].id);
+                }
+            } else {
+                resident += chunk_bytes;
+                if (loaded != nullptr) {
+                    loaded->push_back(candidates[i].id);
+                }
+            }
+        }
+
+        if (active_directory_.empty() && budget == 0) {
+            // streaming was disabled, the evicted chunks only come back
+            return;
+        }
+
+        // evict chunks outside of the radius and the farthest ones above the budget
+        candidates.clear();
+        for (const std::pair <const chisel::ChunkID, chisel::ChunkPtr> &chunk :
+                chunks.GetChunks()) {
+            float distance = getDistance(chunks, chunk.first, camera);
+            if (distance > keep_radius) {
+                Candidate candidate = {distance, chunk.first};
+                candidates.push_back(candidate);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const Candidate &a, const Candidate &b) { return a.distance > b.distance; });
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            if (candidates[i].distance <= radius + kEvictionMargin &&
+                (budget == 0 || resident <= budget)) {
+                break;
+            }
+            if (evict(chunks, candidates[i].id, weight_step)) {
+                resident -= chunk_bytes;
+            }
+        }
+    }
+
+    bool ChunkStreamer::evict(chisel::ChunkManager &chunks, const chisel::ChunkID &id,
+                              float weight_step) {
+        PackedChunk packed;
+        packed.pack(*chunks.GetChunk(id), chunks.GetResolution(), weight_step);
+
+        if (active_directory_.empty()) {
+            packed_[id] = std::move(packed);
+            evicted_[id] = PACKED;
+        } else {
+            std::string path = active_directory_ + kSpillFile;
+            if (!spill_.isOpen() &&
+                !spill_.create(path, chunks.GetChunkSize(), chunks.GetResolution())) {
+                LOGE("Could not create the spill map %s", path.c_str());
+                return false;
+            }
+            if (!spill_.write(id, packed)) {
+                LOGE("Could not evict chunk %d %d %d", id(0), id(1), id(2));
+                return false;
+            }
+            evicted_[id] = SPILLED;
+        }
+        chunks.RemoveChunk(id);
+        return true;
+    }
+
+    bool ChunkStreamer::load(chisel::ChunkManager &chunks, const chisel::ChunkID &id) {
+        std::unordered_map <chisel::ChunkID, Store, chisel::ChunkHasher>::iterator evicted =
+                evicted_.find(id);
+        if (evicted == evicted_.end()) {
+            return false;
+        }
+        Store store = evicted->second;
+        evicted_.erase(evicted);
+
+        PackedChunk packed;
+        bool valid = read(id, store, packed, true);
+        chisel::ChunkPtr chunk(new chisel::Chunk(id, chunks.GetChunkSize(),
+                                                 chunks.GetResolution(),
+                                                 valid && packed.colors != 0));
+        if (!valid || !packed.unpack(*chunk, chunks.GetResolution())) {
+            LOGE("Could not load chunk %d %d %d", id(0), id(1), id(2));
+            return false;
+        }
+        if (chunks.HasChunk(id)) {
+            // integration created the chunk again while it was evicted, both
+            // copies hold observations, so neither of them may be dropped
+            mergeChunk(*chunk, *chunks.GetChunk(id));
+            return true;
+        }
+        chunks.AddChunk(chunk);
+        return true;
+    }
+
+    bool ChunkStreamer::read(const chisel::ChunkID &id, Store store, PackedChunk &chunk,
+                             bool take) {
+        switch (store) {
+            case PACKED: {
+                std::unordered_map <chisel::ChunkID, PackedChunk, chisel::ChunkHasher>::iterator
+                        packed = packed_.find(id);
+                if (packed == packed_.end()) {
+                    return false;
+                }
+                if (take) {
+                    chunk = std::move(packed->second);
+                    packed_.erase(packed);
+                } else {
+                    chunk = packed->second;
+                }
+                return true;
+            }
+            case SPILLED: {
+                bool valid = spill_.read(id, chunk);
+                if (take) {
+                    spill_.remove(id);
+                }
+                if (spill_.getChunkCount() == 0) {
+                    // freed records are reused, but an unused spill map is dropped
+                    std::string path = spill_.getPath();
+                    spill_.close();
+                    std::remove(path.c_str());
+                }
+                return valid;
+            }
+            case SITE:
+                return site_.read(id, chunk);
+        }
+        return false;
+    }
+
+    bool ChunkStreamer::save(const chisel::ChunkManager &chunks, const std::string &path) {
+        // the opened map might be the target, it is replaced once complete
+        std::string temporary = path + ".tmp";
+        TsdfMapFile map;
+        if (!map.create(temporary, chunks.GetChunkSize(), chunks.GetResolution())) {
+            LOGE("Could not create the map %s", temporary.c_str());
+            return false;
+        }
+        float weight_step;
+        {
+            std::lock_guard <std::mutex> lock(settings_mutex_);
+            weight_step = weight_step_;
+        }
+        bool valid = true;
+        PackedChunk packed;
+        for (const std::pair <const chisel::ChunkID, chisel::ChunkPtr> &chunk :
+                chunks.GetChunks()) {
+            packed.pack(*chunk.second, chunks.GetResolution(), weight_step);
+            valid = valid && map.write(chunk.first, packed);
+        }
+        for (const std::pair <const chisel::ChunkID, Store> &chunk : evicted_) {
+            valid = valid && read(chunk.first, chunk.second, packed, false) &&
+                    map.write(chunk.first, packed);
+        }
+        valid = valid && map.flush();
+        map.close();
+        if (!valid || std::rename(temporary.c_str(), path.c_str()) != 0) {
+            LOGE("Could not save the map %s", path.c_str());
+            std::remove(temporary.c_str());
+            return false;
+        }
+        LOGI("Saved %d chunks to %s", chunks.GetChunks().size() + evicted_.size(), path.c_str());
+        return true;
+    }
+
+    bool ChunkStreamer::open(const chisel::ChunkManager &chunks, const std::string &path) {
+        clear();
+        if (!site_.open(path, chunks.GetChunkSize(), chunks.GetResolution())) {
+            LOGE("Could not open the map %s", path.c_str());
+            return false;
+        }
+        // nothing is decoded yet, update loads the chunks around the camera
+        std::vector <chisel::ChunkID> ids = site_.getChunkIDs();
+        for (const chisel::ChunkID &id : ids) {
+            if (!chunks.HasChunk(id)) {
+                evicted_[id] = SITE;
+            }
+        }
+        LOGI("Opened %d chunks of %s", ids.size(), path.c_str());
+        return true;
+    }
+
+    void ChunkStreamer::clear() {
+        if (spill_.isOpen()) {
+            std::string path = spill_.getPath();
+            spill_.close();
+            std::remove(path.c_str());
+        }
+        site_.close();
+        evicted_.clear();
+        packed_.clear();
+    }
+
+    float ChunkStreamer::getDistance(const chisel::ChunkManager &chunks,
+                                     const chisel::ChunkID &id, const chisel::Vec3 &camera) const {
+        const Eigen::Vector3i &size = chunks.GetChunkSize();
+        float resolution = chunks.GetResolution();
+        chisel::Vec3 center((id(0) + 0.5f) * size(0) * resolution,
+                            (id(1) + 0.5f) * size(1) * resolution,
+                            (id(2) + 0.5f) * size(2) * resolution);
+        return (center - camera).norm();
+    }
+
+}  // namespace tango_augmented_reality
@@ -0,0 +1,94 @@
+#include "tango-augmented-reality/color_integrator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // voxels further away from the surface than this many voxel sizes get no color
+    const float kSurfaceBand = 2.0f;
+
+    // weight of a single color observation
+    const uint8_t kColorWeight = 1;
+
+    uint8_t clampColor(float value) {
+        return static_cast<uint8_t>(std::min(std::max(value, 0.0f), 255.0f));
+    }
+}  // namespace
+
+namespace tango_augmented_reality {
+
+    ColorIntegrator::ColorIntegrator() : fx_(0), fy_(0), cx_(0), cy_(0), width_(0), height_(0) { }
+
+    void ColorIntegrator::setIntrinsics(float fx, float fy, float cx, float cy,
+                                        int width, int height) {
+        fx_ = fx;
+        fy_ = fy;
+        cx_ = cx;
+        cy_ = cy;
+        width_ = width;
+        height_ = height;
+    }
+
+    void ColorIntegrator::integrate(chisel::ChunkManager &chunks,
+                                    const std::vector <chisel::ChunkID> &ids,
+                                    const glm::mat4 &transformation, const uint8_t *nv21,
+                                    int width, int height) {
+        if (width_ == 0 || height_ == 0) {
+            return;
+        }
+        // the buffer might be delivered in a different size than the intrinsics
+        float scale_x = static_cast<float>(width) / width_;
+        float scale_y = static_cast<float>(height) / height_;
+        glm::mat4 inverse = glm::inverse(transformation);
+
+        const Eigen::Vector3i &size = chunks.GetChunkSize();
+        float resolution = chunks.GetResolution();
+        float band = kSurfaceBand * resolution;
+        for (const chisel::ChunkID &id : ids) {
+            chisel::ChunkPtr chunk = chunks.GetChunk(id);
+            if (!chunk || !chunk->HasColors()) {
+                continue;
+            }
+            const chisel::Vec3 &origin = chunk->GetOrigin();
+            int voxel = 0;
+            for (int z = 0; z < size(2); ++z) {
+                for (int y = 0; y < size(1); ++y) {
+                    for (int x = 0; x < size(0); ++x, ++voxel) {
+                        const chisel::DistVoxel &distance = chunk->GetDistVoxel(voxel);
+                        if (distance.GetWeight() <= 0.0f || std::fabs(distance.GetSDF()) > band) {
+                            continue;
+                        }
+                        glm::vec4 world(origin(0) + (x + 0.5f) * resolution,
+                                        origin(1) + (y + 0.5f) * resolution,
+                                        origin(2) + (z + 0.5f) * resolution, 1.0f);
+                        glm::vec4 point = world * inverse;
+                        if (point.z <= 0.0f) {
+                            continue;
+                        }
+                        int u = static_cast<int>((fx_ * point.x / point.z + cx_) * scale_x);
+                        int v = static_cast<int>((fy_ * point.y / point.z + cy_) * scale_y);
+                        if (u < 0 || v < 0 || u >= width || v >= height) {
+                            continue;
+                        }
+                        uint8_t r, g, b;
+                        sample(nv21, width, height, u, v, &r, &g, &b);
+                        chunk->GetColorVoxelMutable(voxel).Integrate(r, g, b, kColorWeight);
+                    }
+                }
+            }
+        }
+    }
+
+    void ColorIntegrator::sample(const uint8_t *nv21, int width, int height, int x, int y,
+                                 uint8_t *r, uint8_t *g, uint8_t *b) {
+        // chroma is stored as interleaved v, u for every 2x2 block
+        const uint8_t *chroma = nv21 + width * height + (y / 2) * width + (x & ~1);
+        float luma = nv21[y * width + x];
+        float v = chroma[0] - 128.0f;
+        float u = chroma[1] - 128.0f;
+        *r = clampColor(luma + 1.370705f * v);
+        *g = clampColor(luma - 0.698001f * v - 0.337633f * u);
+        *b = clampColor(luma + 1.732446f * u);
+    }
+
+}  // namespace tango_augmented_reality
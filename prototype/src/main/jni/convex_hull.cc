@@ -1,7 +1,14 @@
 #include "tango-augmented-reality/convex_hull.h"
 
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 
 namespace {
+    // below this size the prefilter and the radix sort do not pay off
+    const int kMinimumPointsForPrefilter = 64;
+
     // less_equal operator for std::sort function
     bool less_equal(const glm::vec2 p1, const glm::vec2 p2) {
         return p1.x < p2.x || (p1.x == p2.x && p1.y < p2.y);
@@ -13,14 +20,21 @@ namespace tango_augmented_reality {
         return (P1.x - P0.x) * (P2.y - P0.y) - (P2.x - P0.x) * (P1.y - P0.y);
     }
 
-    std::vector <glm::vec2> ConvexHull::generateConvexHull(std::vector < glm::vec2 > &points) {
+    std::vector <glm::vec2> ConvexHull::generateConvexHull(const std::vector <glm::vec2> &input) {
+
+        std::vector <glm::vec2> &points = sorted_;
+        if (input.size() < kMinimumPointsForPrefilter) {
+            points = input;
+            std::sort(points.begin(), points.end(), less_equal);
+        } else {
+            // Drop interior points and sort the remaining ones lexicographically
+            discardInteriorPoints(input, points);
+            sortPoints(points);
+        }
 
         int n = points.size(), k = 0;
         std::vector <glm::vec2> hull(2 * n);
 
-        // Sort points lexicographically
-        std::sort(points.begin(), points.end(), less_equal);
-
         // Build lower hull
         for (int i = 0; i < n; ++i) {
             while (k >= 2 && isLeft(hull[k - 2], hull[k - 1], points[i]) <= 0) k--;
@@ -36,4 +50,147 @@ namespace tango_augmented_reality {
         hull.resize(k);
         return hull;
     }
-}
\ No newline at end of file
+
+    void ConvexHull::discardInteriorPoints(const std::vector <glm::vec2> &points,
+                                           std::vector <glm::vec2> &candidates) {
+        int n = points.size();
+
+        // extreme points along x, y and both diagonals
+        int extreme[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+        for (int i = 1; i < n; ++i) {
+            const glm::vec2 &p = points[i];
+            if (p.x < points[extreme[0]].x) extreme[0] = i;
+            if (p.x + p.y < points[extreme[1]].x + points[extreme[1]].y) extreme[1] = i;
+            if (p.y < points[extreme[2]].y) extreme[2] = i;
+            if (p.x - p.y > points[extreme[3]].x - points[extreme[3]].y) extreme[3] = i;
+            if (p.x > points[extreme[4]].x) extreme[4] = i;
+            if (p.x + p.y > points[extreme[5]].x + points[extreme[5]].y) extreme[5] = i;
+            if (p.y > points[extreme[6]].y) extreme[6] = i;
+            if (p.x - p.y < points[extreme[7]].x - points[extreme[7]].y) extreme[7] = i;
+        }
+
+        // counter clockwise octagon without repeated corners
+        float edge_x[8], edge_y[8], edge_dx[8], edge_dy[8];
+        int edges = 0;
+        for (int i = 0; i < 8; ++i) {
+            const glm::vec2 &a = points[extreme[i]];
+            const glm::vec2 &b = points[extreme[(i + 1) % 8]];
+            if (a.x == b.x && a.y == b.y) {
+                continue;
+            }
+            edge_x[edges] = a.x;
+            edge_y[edges] = a.y;
+            edge_dx[edges] = b.x - a.x;
+            edge_dy[edges] = b.y - a.y;
+            edges++;
+        }
+        if (edges < 3) {
+            candidates = points;
+            return;
+        }
+
+        // a point is kept unless it lies strictly left of every octagon edge
+        outside_.resize(n);
+        int i = 0;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+        const float *data = &points[0].x;
+        for (; i + 4 <= n; i += 4) {
+            float32x4x2_t xy = vld2q_f32(data + i * 2);
+            float32x4_t min_cross = vdupq_n_f32(1.0f);
+            for (int e = 0; e < edges; ++e) {
+                float32x4_t px = vsubq_f32(xy.val[0], vdupq_n_f32(edge_x[e]));
+                float32x4_t py = vsubq_f32(xy.val[1], vdupq_n_f32(edge_y[e]));
+                float32x4_t cross = vmlsq_n_f32(vmulq_n_f32(py, edge_dx[e]), px, edge_dy[e]);
+                min_cross = vminq_f32(min_cross, cross);
+            }
+            uint32x4_t keep = vcleq_f32(min_cross, vdupq_n_f32(0.0f));
+            outside_[i] = vgetq_lane_u32(keep, 0) != 0;
+            outside_[i + 1] = vgetq_lane_u32(keep, 1) != 0;
+            outside_[i + 2] = vgetq_lane_u32(keep, 2) != 0;
+            outside_[i + 3] = vgetq_lane_u32(keep, 3) != 0;
+        }
+#endif
+        for (; i < n; ++i) {
+            float min_cross = 1.0f;
+            for (int e = 0; e < edges; ++e) {
+                float cross = edge_dx[e] * (points[i].y - edge_y[e]) -
+                              edge_dy[e] * (points[i].x - edge_x[e]);
+                min_cross = std::min(min_cross, cross);
+            }
+            outside_[i] = min_cross <= 0.0f;
+        }
+
+        candidates.clear();
+        for (int j = 0; j < n; ++j) {
+            if (outside_[j]) {
+                candidates.push_back(points[j]);
+            }
+        }
+    }
+
+    void ConvexHull::sortPoints(std::vector <glm::vec2> &points) {
+        int n = points.size();
+        if (n < 2) {
+            return;
+        }
+
+        glm::vec2 min = points[0];
+        glm::vec2 max = points[0];
+        for (int i = 1; i < n; ++i) {
+            min.x = std::min(min.x, points[i].x);
+            min.y = std::min(min.y, points[i].y);
+            max.x = std::max(max.x, points[i].x);
+            max.y = std::max(max.y, points[i].y);
+        }
+        float scale_x = max.x > min.x ? 65535.0f / (max.x - min.x) : 0.0f;
+        float scale_y = max.y > min.y ? 65535.0f / (max.y - min.y) : 0.0f;
+
+        // 16 bit x in the upper half, 16 bit y in the lower half of the key
+        keys_.resize(n);
+        order_.resize(n);
+        key_buffer_.resize(n);
+        order_buffer_.resize(n);
+        for (int i = 0; i < n; ++i) {
+            uint32_t qx = static_cast<uint32_t>((points[i].x - min.x) * scale_x);
+            uint32_t qy = static_cast<uint32_t>((points[i].y - min.y) * scale_y);
+            keys_[i] = (std::min(qx, 65535u) << 16) | std::min(qy, 65535u);
+            order_[i] = i;
+        }
+
+        // least significant digit first, 4 passes with 8 bit digits
+        for (int shift = 0; shift < 32; shift += 8) {
+            int count[257] = {0};
+            for (int i = 0; i < n; ++i) {
+                count[((keys_[i] >> shift) & 0xFF) + 1]++;
+            }
+            for (int d = 0; d < 256; ++d) {
+                count[d + 1] += count[d];
+            }
+            for (int i = 0; i < n; ++i) {
+                int slot = count[(keys_[i] >> shift) & 0xFF]++;
+                key_buffer_[slot] = keys_[i];
+                order_buffer_[slot] = order_[i];
+            }
+            keys_.swap(key_buffer_);
+            order_.swap(order_buffer_);
+        }
+
+        std::vector <glm::vec2> sorted(n);
+        for (int i = 0; i < n; ++i) {
+            sorted[i] = points[order_[i]];
+        }
+
+        // points sharing a quantization cell may still be out of order, an
+        // insertion sort fixes them in linear time on the almost sorted input
+        for (int i = 1; i < n; ++i) {
+            glm::vec2 point = sorted[i];
+            int j = i - 1;
+            while (j >= 0 && less_equal(point, sorted[j])) {
+                sorted[j + 1] = sorted[j];
+                j--;
+            }
+            sorted[j + 1] = point;
+        }
+        points.swap(sorted);
+    }
+}
@@ -0,0 +1,132 @@
+#include "tango-augmented-reality/depth_rasterizer.h"
+
+#include <algorithm>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+    // edge length of the square every point is splatted into in pixels
+    const int kSplatSize = 2;
+}  // namespace
+
+namespace tango_augmented_reality {
+
+    DepthRasterizer::DepthRasterizer() : fx_(0), fy_(0), cx_(0), cy_(0), width_(0), height_(0),
+                                         dilation_(true), vectorized_(true) { }
+
+    void DepthRasterizer::setIntrinsics(float fx, float fy, float cx, float cy,
+                                        int width, int height) {
+        fx_ = fx;
+        fy_ = fy;
+        cx_ = cx;
+        cy_ = cy;
+        width_ = width;
+        height_ = height;
+        holes_.resize(width * height);
+    }
+
+    void DepthRasterizer::rasterize(const float *xyz, int count, float *depth) {
+        std::fill(depth, depth + width_ * height_, 0.0f);
+        project(xyz, count);
+
+        // z-buffered splats, the splat grows to the right and to the bottom
+        for (int i = 0; i < count; ++i) {
+            int pixel = pixels_[i];
+            if (pixel < 0) {
+                continue;
+            }
+            float z = xyz[i * 3 + 2];
+            int u = pixel % width_;
+            int v = pixel / width_;
+            int u_end = std::min(u + kSplatSize, width_);
+            int v_end = std::min(v + kSplatSize, height_);
+            for (int y = v; y < v_end; ++y) {
+                float *row = depth + y * width_;
+                for (int x = u; x < u_end; ++x) {
+                    if (row[x] == 0.0f || z < row[x]) {
+                        row[x] = z;
+                    }
+                }
+            }
+        }
+
+        if (dilation_) {
+            dilate(depth);
+        }
+    }
+
+    void DepthRasterizer::project(const float *xyz, int count) {
+        pixels_.resize(count);
+        int i = 0;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+        const float32x4_t fx = vdupq_n_f32(fx_);
+        const float32x4_t fy = vdupq_n_f32(fy_);
+        // rounds to the nearest pixel when converted with truncation
+        const float32x4_t cx = vdupq_n_f32(cx_ + 0.5f);
+        const float32x4_t cy = vdupq_n_f32(cy_ + 0.5f);
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+        const float32x4_t width = vdupq_n_f32(static_cast<float>(width_));
+        const float32x4_t height = vdupq_n_f32(static_cast<float>(height_));
+        const int32x4_t stride = vdupq_n_s32(width_);
+        const int32x4_t invalid = vdupq_n_s32(-1);
+        for (; vectorized_ && i + 4 <= count; i += 4) {
+            float32x4x3_t point = vld3q_f32(xyz + i * 3);
+            // reciprocal estimate refined by two newton steps
+            float32x4_t inverse_z = vrecpeq_f32(point.val[2]);
+            inverse_z = vmulq_f32(vrecpsq_f32(point.val[2], inverse_z), inverse_z);
+            inverse_z = vmulq_f32(vrecpsq_f32(point.val[2], inverse_z), inverse_z);
+            float32x4_t px = vmlaq_f32(cx, vmulq_f32(point.val[0], inverse_z), fx);
+            float32x4_t py = vmlaq_f32(cy, vmulq_f32(point.val[1], inverse_z), fy);
+
+            uint32x4_t valid = vcgtq_f32(point.val[2], zero);
+            valid = vandq_u32(valid, vcgeq_f32(px, zero));
+            valid = vandq_u32(valid, vcgeq_f32(py, zero));
+            valid = vandq_u32(valid, vcltq_f32(px, width));
+            valid = vandq_u32(valid, vcltq_f32(py, height));
+
+            int32x4_t pixel = vmlaq_s32(vcvtq_s32_f32(px), vcvtq_s32_f32(py), stride);
+            vst1q_s32(&pixels_[i], vbslq_s32(valid, pixel, invalid));
+        }
+#endif
+        for (; i < count; ++i) {
+            float z = xyz[i * 3 + 2];
+            pixels_[i] = -1;
+            if (!(z > 0.0f)) {
+                continue;
+            }
+            float px = fx_ * xyz[i * 3] / z + cx_ + 0.5f;
+            float py = fy_ * xyz[i * 3 + 1] / z + cy_ + 0.5f;
+            if (px < 0.0f || py < 0.0f || px >= width_ || py >= height_) {
+                continue;
+            }
+            pixels_[i] = static_cast<int>(py) * width_ + static_cast<int>(px);
+        }
+    }
+
+    void DepthRasterizer::dilate(float *depth) {
+        // reads from a copy so filled holes do not spread further
+        std::copy(depth, depth + width_ * height_, holes_.begin());
+        for (int y = 1; y + 1 < height_; ++y) {
+            for (int x = 1; x + 1 < width_; ++x) {
+                int pixel = y * width_ + x;
+                if (holes_[pixel] != 0.0f) {
+                    continue;
+                }
+                float closest = 0.0f;
+                for (int dy = -1; dy <= 1; ++dy) {
+                    const float *row = &holes_[pixel + dy * width_];
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        float z = row[dx];
+                        if (z != 0.0f && (closest == 0.0f || z < closest)) {
+                            closest = z;
+                        }
+                    }
+                }
+                depth[pixel] = closest;
+            }
+        }
+    }
+
+}  // namespace tango_augmented_reality
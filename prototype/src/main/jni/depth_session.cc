@@ -0,0 +1,87 @@
+#include "tango-augmented-reality/depth_session.h"
+
+#include <stdint.h>
+#include <cstring>
+#include <utility>
+
+namespace {
+    const char kMagic[4] = {'D', 'S', 'E', 'S'};
+    const uint32_t kVersion = 1;
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+    };
+
+    struct FrameHeader {
+        double timestamp;
+        float transformation[16];
+        uint32_t count;
+        uint32_t reserved;
+    };
+}  // namespace
+
+namespace tango_augmented_reality {
+
+    bool DepthSession::create(const std::string &path) {
+        close();
+        file_.open(path.c_str(), std::ios::binary | std::ios::trunc);
+        FileHeader header;
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        file_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        if (!file_) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    bool DepthSession::append(const DepthSessionFrame &frame) {
+        if (!file_.is_open()) {
+            return false;
+        }
+        FrameHeader header;
+        header.timestamp = frame.timestamp;
+        std::memcpy(header.transformation, frame.transformation, sizeof(header.transformation));
+        header.count = static_cast<uint32_t>(frame.points.size() / 3);
+        header.reserved = 0;
+        file_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file_.write(reinterpret_cast<const char *>(frame.points.data()),
+                    header.count * 3 * sizeof(float));
+        return static_cast<bool>(file_);
+    }
+
+    void DepthSession::close() {
+        if (file_.is_open()) {
+            file_.close();
+        }
+        file_.clear();
+    }
+
+    bool DepthSession::load(const std::string &path, std::vector <DepthSessionFrame> &frames) {
+        frames.clear();
+        std::ifstream file(path.c_str(), std::ios::binary);
+        FileHeader header;
+        if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+            std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+            header.version != kVersion) {
+            return false;
+        }
+        FrameHeader frame_header;
+        while (file.read(reinterpret_cast<char *>(&frame_header), sizeof(frame_header))) {
+            DepthSessionFrame frame;
+            frame.timestamp = frame_header.timestamp;
+            std::memcpy(frame.transformation, frame_header.transformation,
+                        sizeof(frame.transformation));
+            frame.points.resize(frame_header.count * 3);
+            if (!file.read(reinterpret_cast<char *>(frame.points.data()),
+                           frame.points.size() * sizeof(float))) {
+                break;
+            }
+            frames.push_back(std::move(frame));
+        }
+        return true;
+    }
+
+}  // namespace tango_augmented_reality
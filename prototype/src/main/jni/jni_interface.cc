@@ -117,6 +117,101 @@ Java_de_stetro_master_prototype_TangoJNINative_setFilterSettings(
   app.setFilterSettings(diameter, sigma);
 }
 
+JNIEXPORT void JNICALL
+Java_de_stetro_master_prototype_TangoJNINative_setPlaneEngine(
+    JNIEnv*, jobject, jint engine) {
+  app.setPlaneEngine(engine);
+}
+
+JNIEXPORT void JNICALL
+Java_de_stetro_master_prototype_TangoJNINative_setPlaneCompletion(
+    JNIEnv*, jobject, jboolean enabled) {
+  app.setPlaneCompletion(enabled);
+}
+
+JNIEXPORT void JNICALL
+Java_de_stetro_master_prototype_TangoJNINative_setIntegrationMode(
+    JNIEnv*, jobject, jint integration_mode) {
+  app.setIntegrationMode(integration_mode);
+}
+
+JNIEXPORT void JNICALL
+Java_de_stetro_master_prototype_TangoJNINative_benchmarkReconstruction(
+    JNIEnv*, jobject) {
+  app.benchmarkReconstruction();
+}
+
+JNIEXPORT void JNICALL
+Java_de_stetro_master_prototype_TangoJNINative_sweepReconstruction(
+    JNIEnv* env, jobject, jstring file) {
+  const char* path = env->GetStringUTFChars(file, nullptr);
+  app.sweepReconstruction(path);
+  env->ReleaseStringUTFChars(file, path);
+}
+
+JNIEXPORT void JNICALL
+Java_de_stetro_master_prototype_TangoJNINative_setSessionRecording(
+    JNIEnv* env, jobject, jstring file) {
+  const char* path = env->GetStringUTFChars(file, nullptr);
+  app.setSessionRecording(path);
+  env->ReleaseStringUTFChars(file, path);
+}
+
+JNIEXPORT void JNICALL
+Java_de_stetro_master_prototype_TangoJNINative_saveTsdf(
+    JNIEnv* env, jobject, jstring file) {
+  const char* path = env->GetStringUTFChars(file, nullptr);
+  app.saveTsdf(path);
+  env->ReleaseStringUTFChars(file, path);
+}
+
+JNIEXPORT void JNICALL
+Java_de_stetro_master_prototype_TangoJNINative_loadTsdf(
+    JNIEnv* env, jobject, jstring file) {
+  const char* path = env->GetStringUTFChars(file, nullptr);
+  app.loadTsdf(path);
+  env->ReleaseStringUTFChars(file, path);
+}
+
+JNIEXPORT void JNICALL
+Java_de_stetro_master_prototype_TangoJNINative_setTsdfStreaming(
+    JNIEnv* env, jobject, jstring directory, jint budget_megabytes) {
+  const char* path = env->GetStringUTFChars(directory, nullptr);
+  app.setTsdfStreaming(path, budget_megabytes);
+  env->ReleaseStringUTFChars(directory, path);
+}
+
+JNIEXPORT void JNICALL
+Java_de_stetro_master_prototype_TangoJNINative_setTsdfColor(
+    JNIEnv*, jobject, jboolean enabled) {
+  app.setTsdfColor(enabled);
+}
+
+JNIEXPORT void JNICALL
+Java_de_stetro_master_prototype_TangoJNINative_setTsdfDecimation(
+    JNIEnv*, jobject, jfloat max_error) {
+  app.setTsdfDecimation(max_error);
+}
+
+JNIEXPORT void JNICALL
+Java_de_stetro_master_prototype_TangoJNINative_setTsdfMultiResolution(
+    JNIEnv*, jobject, jboolean enabled) {
+  app.setTsdfMultiResolution(enabled);
+}
+
+JNIEXPORT void JNICALL
+Java_de_stetro_master_prototype_TangoJNINative_setTsdfRaycast(
+    JNIEnv*, jobject, jint width, jint height) {
+  app.setTsdfRaycast(width, height);
+}
+
+JNIEXPORT void JNICALL
+Java_de_stetro_master_prototype_TangoJNINative_setKeyframeSettings(
+    JNIEnv*, jobject, jint mode, jfloat translation, jfloat rotation, jfloat novelty,
+    jdouble min_interval, jdouble max_interval) {
+  app.setKeyframeSettings(mode, translation, rotation, novelty, min_interval, max_interval);
+}
+
 JNIEXPORT void JNICALL
 Java_de_stetro_master_prototype_TangoJNINative_clearReconstruction(
     JNIEnv*, jobject) {
@@ -0,0 +1,94 @@
+#include "tango-augmented-reality/keyframe_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // edge length of the cells which remember the covered space, meters
+    const float kCellSize = 0.25f;
+
+    // points of a frame tested for novelty, the rest is skipped
+    const size_t kNoveltySamples = 512;
+
+    // cell coordinates are packed into 21 bits per axis
+    const int64_t kCellOffset = 1 << 20;
+    const int64_t kCellMask = (1 << 21) - 1;
+}  // namespace
+
+namespace tango_augmented_reality {
+
+    KeyframeScheduler::KeyframeScheduler(const KeyframeSettings &settings)
+            : settings_(settings), has_keyframe_(false), last_timestamp_(0),
+              last_transformation_(1.0f) { }
+
+    bool KeyframeScheduler::isKeyframe(double timestamp, const glm::mat4 &transformation,
+                                       const std::vector <float> &points) const {
+        if (!has_keyframe_) {
+            return true;
+        }
+        double elapsed = timestamp - last_timestamp_;
+        if (elapsed < settings_.min_interval) {
+            return false;
+        }
+        if (settings_.max_interval > 0.0 && elapsed >= settings_.max_interval) {
+            return true;
+        }
+        glm::vec3 movement = glm::vec3(transformation[3]) - glm::vec3(last_transformation_[3]);
+        if (glm::length(movement) > settings_.translation) {
+            return true;
+        }
+        // angle of the relative rotation from the trace of its matrix
+        glm::mat3 relative = glm::transpose(glm::mat3(last_transformation_)) *
+                             glm::mat3(transformation);
+        float cosine = (relative[0][0] + relative[1][1] + relative[2][2] - 1.0f) * 0.5f;
+        if (std::acos(std::min(std::max(cosine, -1.0f), 1.0f)) > settings_.rotation) {
+            return true;
+        }
+        return novelty(transformation, points) > settings_.novelty;
+    }
+
+    void KeyframeScheduler::addKeyframe(double timestamp, const glm::mat4 &transformation,
+                                        const std::vector <float> &points) {
+        has_keyframe_ = true;
+        last_timestamp_ = timestamp;
+        last_transformation_ = transformation;
+        size_t count = points.size() / 3;
+        size_t stride = std::max(count / kNoveltySamples, static_cast<size_t>(1));
+        for (size_t i = 0; i < count; i += stride) {
+            covered_.insert(cell(transformation *
+                                 glm::vec4(points[i * 3], points[i * 3 + 1], points[i * 3 + 2], 1.0f)));
+        }
+    }
+
+    void KeyframeScheduler::reset() {
+        has_keyframe_ = false;
+        covered_.clear();
+    }
+
+    int64_t KeyframeScheduler::cell(const glm::vec4 &point) {
+        int64_t x = static_cast<int64_t>(std::floor(point.x / kCellSize)) + kCellOffset;
+        int64_t y = static_cast<int64_t>(std::floor(point.y / kCellSize)) + kCellOffset;
+        int64_t z = static_cast<int64_t>(std::floor(point.z / kCellSize)) + kCellOffset;
+        return ((x & kCellMask) << 42) | ((y & kCellMask) << 21) | (z & kCellMask);
+    }
+
+    float KeyframeScheduler::novelty(const glm::mat4 &transformation,
+                                     const std::vector <float> &points) const {
+        size_t count = points.size() / 3;
+        if (count == 0) {
+            return 0.0f;
+        }
+        size_t stride = std::max(count / kNoveltySamples, static_cast<size_t>(1));
+        size_t sampled = 0;
+        size_t uncovered = 0;
+        for (size_t i = 0; i < count; i += stride, ++sampled) {
+            glm::vec4 point = transformation *
+                              glm::vec4(points[i * 3], points[i * 3 + 1], points[i * 3 + 2], 1.0f);
+            if (covered_.find(cell(point)) == covered_.end()) {
+                ++uncovered;
+            }
+        }
+        return static_cast<float>(uncovered) / sampled;
+    }
+
+}  // namespace tango_augmented_reality
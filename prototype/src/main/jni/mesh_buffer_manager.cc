@@ -0,0 +1,229 @@
+#include "tango-augmented-reality/mesh_buffer_manager.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    bool byOffset(const tango_augmented_reality::RangeAllocator::Range &a,
+                  const tango_augmented_reality::RangeAllocator::Range &b) {
+        return a.offset < b.offset;
+    }
+
+    // initial element capacity of the buffers
+    const size_t kMinimumCapacity = 4096;
+
+    // capacity which fits at least size more elements, doubled to keep the
+    // count of reallocations low
+    size_t grownCapacity(size_t capacity, size_t size) {
+        return std::max(std::max(capacity * 2, capacity + size), kMinimumCapacity);
+    }
+}  // namespace
+
+namespace tango_augmented_reality {
+
+    void MeshSlice::updateBounds() {
+        min = glm::vec3(INFINITY, INFINITY, INFINITY);
+        max = glm::vec3(-INFINITY, -INFINITY, -INFINITY);
+        for (size_t i = 0; i + 2 < vertices.size(); i += 3) {
+            glm::vec3 vertex(vertices[i], vertices[i + 1], vertices[i + 2]);
+            min = glm::min(min, vertex);
+            max = glm::max(max, vertex);
+        }
+    }
+
+    MeshBufferManager::MeshBufferManager(bool colors) : vertex_buffer_(0), index_buffer_(0),
+                                                        color_buffer_(0),
+                                                        vertex_buffer_capacity_(0),
+                                                        index_buffer_capacity_(0),
+                                                        color_buffer_capacity_(0),
+                                                        colors_(colors) { }
+
+    MeshBufferManager::~MeshBufferManager() {
+        clear();
+    }
+
+    void MeshBufferManager::update(const MeshSliceMap &slices) {
+        std::map <uint64_t, Allocation>::iterator it = allocations_.begin();
+        while (it != allocations_.end()) {
+            MeshSliceMap::const_iterator slice = slices.find(it->first);
+            if (slice == slices.end() || slice->second != it->second.slice) {
+                std::map <uint64_t, Allocation>::iterator removed = it++;
+                remove(removed);
+            } else {
+                ++it;
+            }
+        }
+        for (MeshSliceMap::const_iterator slice = slices.begin(); slice != slices.end(); ++slice) {
+            if (allocations_.find(slice->first) == allocations_.end()) {
+                insert(slice->first, slice->second);
+            }
+        }
+        flush();
+    }
+
+    void MeshBufferManager::insert(uint64_t key, const MeshSlicePtr &slice) {
+        size_t vertex_count = slice->vertices.size() / 3;
+        size_t index_count = slice->indices.size();
+
+        Allocation allocation;
+        allocation.slice = slice;
+        if (!vertex_ranges_.allocate(vertex_count, allocation.vertex_offset)) {
+            vertex_ranges_.grow(grownCapacity(vertex_ranges_.getCapacity(), vertex_count));
+            vertex_data_.resize(vertex_ranges_.getCapacity() * 3);
+            if (colors_) {
+                color_data_.resize(vertex_ranges_.getCapacity() * 3);
+            }
+            vertex_ranges_.allocate(vertex_count, allocation.vertex_offset);
+        }
+        if (!index_ranges_.allocate(index_count, allocation.index_offset)) {
+            index_ranges_.grow(grownCapacity(index_ranges_.getCapacity(), index_count));
+            index_data_.resize(index_ranges_.getCapacity());
+            index_ranges_.allocate(index_count, allocation.index_offset);
+        }
+
+        std::copy(slice->vertices.begin(), slice->vertices.begin() + vertex_count * 3,
+                  vertex_data_.begin() + allocation.vertex_offset * 3);
+        if (colors_) {
+            std::vector <GLfloat>::iterator colors = color_data_.begin() + allocation.vertex_offset * 3;
+            if (slice->colors.size() == vertex_count * 3) {
+                std::copy(slice->colors.begin(), slice->colors.end(), colors);
+            } else {
+                std::fill(colors, colors + vertex_count * 3, 0.0f);
+            }
+        }
+        GLuint base = static_cast<GLuint>(allocation.vertex_offset);
+        for (size_t i = 0; i < index_count; ++i) {
+            index_data_[allocation.index_offset + i] = slice->indices[i] + base;
+        }
+        vertex_ranges_.markDirty(allocation.vertex_offset, vertex_count);
+        index_ranges_.markDirty(allocation.index_offset, index_count);
+
+        allocations_[key] = allocation;
+    }
+
+    void MeshBufferManager::remove(std::map <uint64_t, Allocation>::iterator it) {
+        const Allocation &allocation = it->second;
+        vertex_ranges_.release(allocation.vertex_offset, allocation.slice->vertices.size() / 3);
+        index_ranges_.release(allocation.index_offset, allocation.slice->indices.size());
+        allocations_.erase(it);
+    }
+
+    void MeshBufferManager::flush() {
+        // colors share the ranges of the vertices
+        vertex_ranges_.takeDirtyRanges(dirty_);
+        upload(GL_ARRAY_BUFFER, vertex_buffer_, vertex_buffer_capacity_, vertex_data_.data(),
+               3 * sizeof(GLfloat), vertex_ranges_.getCapacity());
+        if (colors_) {
+            upload(GL_ARRAY_BUFFER, color_buffer_, color_buffer_capacity_, color_data_.data(),
+                   3 * sizeof(GLfloat), vertex_ranges_.getCapacity());
+        }
+        index_ranges_.takeDirtyRanges(dirty_);
+        upload(GL_ELEMENT_ARRAY_BUFFER, index_buffer_, index_buffer_capacity_, index_data_.data(),
+               sizeof(GLuint), index_ranges_.getCapacity());
+    }
+
+    void MeshBufferManager::upload(GLenum target, GLuint &buffer, size_t &gl_capacity,
+                                   const void *data, size_t element_size, size_t capacity) {
+        if (capacity == 0) {
+            return;
+        }
+        if (buffer == 0) {
+            glGenBuffers(1, &buffer);
+        }
+        glBindBuffer(target, buffer);
+        if (gl_capacity != capacity) {
+            // the buffer grew, the whole CPU copy is uploaded once
+            glBufferData(target, capacity * element_size, data, GL_DYNAMIC_DRAW);
+            gl_capacity = capacity;
+        } else {
+            const char *bytes = static_cast<const char *>(data);
+            for (size_t i = 0; i < dirty_.size(); ++i) {
+                glBufferSubData(target, dirty_[i].offset * element_size,
+                                dirty_[i].size * element_size,
+                                bytes + dirty_[i].offset * element_size);
+            }
+        }
+        glBindBuffer(target, 0);
+    }
+
+    void MeshBufferManager::draw(GLenum render_mode, GLuint attrib_vertices,
+                                 const ViewFrustum &frustum) {
+        if (allocations_.empty() || vertex_buffer_ == 0 || index_buffer_ == 0) {
+            return;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_);
+        glVertexAttribPointer(attrib_vertices, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), 0);
+        drawSlices(render_mode, frustum);
+    }
+
+    void MeshBufferManager::draw(GLenum render_mode, GLuint attrib_vertices,
+                                 GLuint attrib_colors, const ViewFrustum &frustum) {
+        if (allocations_.empty() || vertex_buffer_ == 0 || index_buffer_ == 0 ||
+            color_buffer_ == 0) {
+            return;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, color_buffer_);
+        glVertexAttribPointer(attrib_colors, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), 0);
+        glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_);
+        glVertexAttribPointer(attrib_vertices, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), 0);
+        drawSlices(render_mode, frustum);
+    }
+
+    void MeshBufferManager::drawSlices(GLenum render_mode, const ViewFrustum &frustum) {
+        visible_.clear();
+        for (std::map <uint64_t, Allocation>::iterator it = allocations_.begin();
+             it != allocations_.end(); ++it) {
+            size_t index_count = it->second.slice->indices.size();
+            if (index_count == 0 ||
+                !frustum.intersects(it->second.slice->min, it->second.slice->max)) {
+                continue;
+            }
+            RangeAllocator::Range range = {it->second.index_offset, index_count};
+            visible_.push_back(range);
+        }
+
+        // visible slices next to each other in the index buffer are drawn with
+        // one call, a culled slice or a free range in between splits the run
+        std::sort(visible_.begin(), visible_.end(), byOffset);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_);
+        size_t i = 0;
+        while (i < visible_.size()) {
+            size_t offset = visible_[i].offset;
+            size_t end = offset + visible_[i].size;
+            for (++i; i < visible_.size() && visible_[i].offset == end; ++i) {
+                end += visible_[i].size;
+            }
+            glDrawElements(render_mode, end - offset, GL_UNSIGNED_INT,
+                           reinterpret_cast<const void *>(offset * sizeof(GLuint)));
+        }
+
+        // other drawables still use client side arrays
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+
+    void MeshBufferManager::clear() {
+        allocations_.clear();
+        vertex_ranges_ = RangeAllocator();
+        index_ranges_ = RangeAllocator();
+        vertex_data_.clear();
+        color_data_.clear();
+        index_data_.clear();
+        if (vertex_buffer_ != 0) {
+            glDeleteBuffers(1, &vertex_buffer_);
+            vertex_buffer_ = 0;
+        }
+        if (index_buffer_ != 0) {
+            glDeleteBuffers(1, &index_buffer_);
+            index_buffer_ = 0;
+        }
+        if (color_buffer_ != 0) {
+            glDeleteBuffers(1, &color_buffer_);
+            color_buffer_ = 0;
+        }
+        vertex_buffer_capacity_ = 0;
+        index_buffer_capacity_ = 0;
+        color_buffer_capacity_ = 0;
+    }
+
+}  // namespace tango_augmented_reality
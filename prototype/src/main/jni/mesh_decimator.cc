@@ -0,0 +1,415 @@
+#include "tango-augmented-reality/mesh_decimator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <queue>
+#include <utility>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <Eigen/LU>
+
+namespace {
+    // positions closer than this are welded, marching cubes computes the shared
+    // vertices of neighbouring cubes with the same arithmetic
+    const double kWeldPrecision = 1e-5;
+
+    // collapses turning a remaining triangle by more than ~80 degrees are rejected
+    const double kMinNormalDot = 0.2;
+
+    // below this determinant the optimal position of a quadric is unstable,
+    // which is the normal case on flat surfaces
+    const double kMinDeterminant = 1e-6;
+
+    // the matrices live in std::vectors, so they must not require alignment
+    typedef Eigen::Matrix<double, 4, 4, Eigen::DontAlign> Quadric;
+
+    struct Vertex {
+        Eigen::Vector3d position;
+        Quadric quadric;
+        Eigen::Vector3f color;
+        // triangles using the vertex, may contain removed ones
+        std::vector <int> triangles;
+        int version;
+        bool locked;
+        bool removed;
+    };
+
+    struct Triangle {
+        int v[3];
+        bool removed;
+
+        bool contains(int vertex) const {
+            return v[0] == vertex || v[1] == vertex || v[2] == vertex;
+        }
+    };
+
+    // moves v onto u at target, outdated once one of the versions changed
+    struct Collapse {
+        double error;
+        int u, v;
+        int version_u, version_v;
+        Eigen::Vector3d target;
+
+        bool operator>(const Collapse &other) const { return error > other.error; }
+    };
+
+    struct WeldKey {
+        int64_t x, y, z;
+        int index;
+
+        bool operator<(const WeldKey &other) const {
+            if (x != other.x) return x < other.x;
+            if (y != other.y) return y < other.y;
+            return z < other.z;
+        }
+    };
+
+    double quadricError(const Quadric &quadric, const Eigen::Vector3d &position) {
+        Eigen::Vector4d p(position(0), position(1), position(2), 1.0);
+        return std::max(0.0, p.dot(quadric * p));
+    }
+
+    // one decimation run, collapses the cheapest edges first
+    class Decimation {
+    public:
+        Decimation(const std::vector <float> &vertices, const std::vector <uint32_t> &indices,
+                   const std::vector <float> &colors);
+
+        void run(double max_error);
+
+        void write(std::vector <float> &vertices, std::vector <uint32_t> &indices,
+                   std::vector <float> &colors) const;
+
+    private:
+        // locks the vertices of open and non manifold edges, the chunk borders
+        void lockOpenEdges(std::vector <std::pair <int, int>> &edges);
+
+        void pushCollapse(int u, int v);
+
+        bool isValid(const Collapse &collapse) const;
+
+        // checks that the triangles of vertex keep their orientation at target
+        bool keepsOrientation(int vertex, int other, const Eigen::Vector3d &target) const;
+
+        void applyCollapse(const Collapse &collapse);
+
+        void neighbours(int vertex, std::vector <int> &result) const;
+
+        std::vector <Vertex> vertices_;
+        std::vector <Triangle> triangles_;
+        std::priority_queue <Collapse, std::vector <Collapse>, std::greater <Collapse>> queue_;
+        bool colors_;
+    };
+
+    Decimation::Decimation(const std::vector <float> &vertices,
+                           const std::vector <uint32_t> &indices,
+                           const std::vector <float> &colors) {
+        size_t count = vertices.size() / 3;
+        colors_ = colors.size() == vertices.size();
+
+        // weld equal positions, the input may still be a triangle soup
+        std::vector <WeldKey> keys(count);
+        for (size_t i = 0; i < count; ++i) {
+            keys[i].x = std::llround(vertices[i * 3] / kWeldPrecision);
+            keys[i].y = std::llround(vertices[i * 3 + 1] / kWeldPrecision);
+            keys[i].z = std::llround(vertices[i * 3 + 2] / kWeldPrecision);
+            keys[i].index = i;
+        }
+        std::sort(keys.begin(), keys.end());
+        std::vector <int> remap(count);
+        for (size_t i = 0; i < count; ++i) {
+            if (i == 0 || keys[i - 1] < keys[i]) {
+                int index = keys[i].index;
+                Vertex vertex;
+                vertex.position = Eigen::Vector3d(vertices[index * 3], vertices[index * 3 + 1],
+                                                  vertices[index * 3 + 2]);
+                vertex.quadric.setZero();
+                vertex.color = colors_ ? Eigen::Vector3f(colors[index * 3], colors[index * 3 + 1],
+                                                         colors[index * 3 + 2])
+                                       : Eigen::Vector3f::Zero();
+                vertex.version = 0;
+                vertex.locked = false;
+                vertex.removed = false;
+                vertices_.push_back(vertex);
+            }
+            remap[keys[i].index] = vertices_.size() - 1;
+        }
+
+        std::vector <std::pair <int, int>> edges;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            if (indices[i] >= count || indices[i + 1] >= count || indices[i + 2] >= count) {
+                continue;
+            }
+            Triangle triangle = {{remap[indices[i]], remap[indices[i + 1]], remap[indices[i + 2]]},
+                                 false};
+            if (triangle.v[0] == triangle.v[1] || triangle.v[1] == triangle.v[2] ||
+                triangle.v[0] == triangle.v[2]) {
+                continue;
+            }
+            int index = triangles_.size();
+            for (int j = 0; j < 3; ++j) {
+                int a = triangle.v[j];
+                int b = triangle.v[(j + 1) % 3];
+                vertices_[a].triangles.push_back(index);
+                edges.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+            }
+
+            // every vertex collects the planes of its triangles
+            const Eigen::Vector3d &p0 = vertices_[triangle.v[0]].position;
+            Eigen::Vector3d normal = (vertices_[triangle.v[1]].position - p0).cross(
+                    vertices_[triangle.v[2]].position - p0);
+            double length = normal.norm();
+            if (length > 0.0) {
+                normal /= length;
+                Eigen::Vector4d plane(normal(0), normal(1), normal(2), -normal.dot(p0));
+                Quadric quadric = plane * plane.transpose();
+                for (int j = 0; j < 3; ++j) {
+                    vertices_[triangle.v[j]].quadric += quadric;
+                }
+            }
+            triangles_.push_back(triangle);
+        }
+
+        lockOpenEdges(edges);
+        for (size_t i = 0; i < edges.size(); ++i) {
+            if (i == 0 || edges[i] != edges[i - 1]) {
+                pushCollapse(edges[i].first, edges[i].second);
+            }
+        }
+    }
+
+    void Decimation::lockOpenEdges(std::vector <std::pair <int, int>> &edges) {
+        std::sort(edges.begin(), edges.end());
+        size_t begin = 0;
+        for (size_t i = 1; i <= edges.size(); ++i) {
+            if (i == edges.size() || edges[i] != edges[begin]) {
+                // an interior edge is shared by exactly two triangles
+                if (i - begin != 2) {
+                    vertices_[edges[begin].first].locked = true;
+                    vertices_[edges[begin].second].locked = true;
+                }
+                begin = i;
+            }
+        }
+    }
+
+    void Decimation::pushCollapse(int u, int v) {
+        const Vertex &a = vertices_[u];
+        const Vertex &b = vertices_[v];
+        if (a.locked && b.locked) {
+            return;
+        }
+        Collapse collapse;
+        collapse.u = u;
+        collapse.v = v;
+        collapse.version_u = a.version;
+        collapse.version_v = b.version;
+        Quadric quadric = a.quadric + b.quadric;
+
+        if (a.locked) {
+            collapse.target = a.position;
+        } else if (b.locked) {
+            collapse.target = b.position;
+        } else {
+            // the optimal position is only used close to the edge, otherwise
+            // the better of both ends and the midpoint
+            Eigen::Matrix3d system = quadric.topLeftCorner<3, 3>();
+            Eigen::Vector3d middle = 0.5 * (a.position + b.position);
+            bool solved = false;
+            if (std::fabs(system.determinant()) > kMinDeterminant) {
+                Eigen::Vector3d optimum = system.inverse() * -quadric.topRightCorner<3, 1>();
+                if ((optimum - middle).norm() <= (a.position - b.position).norm()) {
+                    collapse.target = optimum;
+                    solved = true;
+                }
+            }
+            if (!solved) {
+                collapse.target = middle;
+                if (quadricError(quadric, a.position) < quadricError(quadric, collapse.target)) {
+                    collapse.target = a.position;
+                }
+                if (quadricError(quadric, b.position) < quadricError(quadric, collapse.target)) {
+                    collapse.target = b.position;
+                }
+            }
+        }
+        collapse.error = quadricError(quadric, collapse.target);
+        queue_.push(collapse);
+    }
+
+    bool Decimation::isValid(const Collapse &collapse) const {
+        const Vertex &a = vertices_[collapse.u];
+        const Vertex &b = vertices_[collapse.v];
+        if (a.removed || b.removed || a.version != collapse.version_u ||
+            b.version != collapse.version_v) {
+            return false;
+        }
+
+        // the ends may only share the vertices opposite to the edge, otherwise
+        // the collapse pinches the surface
+        std::vector <int> neighbours_a, neighbours_b, shared;
+        neighbours(collapse.u, neighbours_a);
+        neighbours(collapse.v, neighbours_b);
+        std::set_intersection(neighbours_a.begin(), neighbours_a.end(), neighbours_b.begin(),
+                              neighbours_b.end(), std::back_inserter(shared));
+        size_t opposite = 0;
+        for (int triangle : a.triangles) {
+            if (!triangles_[triangle].removed && triangles_[triangle].contains(collapse.v)) {
+                opposite++;
+            }
+        }
+        if (opposite == 0 || shared.size() != opposite) {
+            return false;
+        }
+
+        return keepsOrientation(collapse.u, collapse.v, collapse.target) &&
+               keepsOrientation(collapse.v, collapse.u, collapse.target);
+    }
+
+    bool Decimation::keepsOrientation(int vertex, int other, const Eigen::Vector3d &target) const {
+        for (int index : vertices_[vertex].triangles) {
+            const Triangle &triangle = triangles_[index];
+            if (triangle.removed || triangle.contains(other)) {
+                continue;
+            }
+            Eigen::Vector3d before[3], after[3];
+            for (int j = 0; j < 3; ++j) {
+                before[j] = vertices_[triangle.v[j]].position;
+                after[j] = triangle.v[j] == vertex ? target : before[j];
+            }
+            Eigen::Vector3d normal_before = (before[1] - before[0]).cross(before[2] - before[0]);
+            Eigen::Vector3d normal_after = (after[1] - after[0]).cross(after[2] - after[0]);
+            double length = normal_before.norm() * normal_after.norm();
+            if (length <= 0.0 || normal_before.dot(normal_after) < kMinNormalDot * length) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void Decimation::applyCollapse(const Collapse &collapse) {
+        Vertex &a = vertices_[collapse.u];
+        Vertex &b = vertices_[collapse.v];
+        if (collapse.target == b.position) {
+            a.color = b.color;
+        } else if (collapse.target != a.position) {
+            a.color = 0.5f * (a.color + b.color);
+        }
+        a.position = collapse.target;
+        a.quadric += b.quadric;
+        a.locked = a.locked || b.locked;
+
+        // triangles on the edge vanish, the others of v move over to u
+        for (int index : b.triangles) {
+            Triangle &triangle = triangles_[index];
+            if (triangle.removed) {
+                continue;
+            }
+            if (triangle.contains(collapse.u)) {
+                triangle.removed = true;
+                continue;
+            }
+            for (int j = 0; j < 3; ++j) {
+                if (triangle.v[j] == collapse.v) {
+                    triangle.v[j] = collapse.u;
+                }
+            }
+            a.triangles.push_back(index);
+        }
+        a.triangles.erase(std::remove_if(a.triangles.begin(), a.triangles.end(),
+                                         [this](int index) {
+                                             return triangles_[index].removed;
+                                         }), a.triangles.end());
+        b.triangles.clear();
+        b.removed = true;
+        a.version++;
+
+        std::vector <int> around;
+        neighbours(collapse.u, around);
+        for (int neighbour : around) {
+            pushCollapse(collapse.u, neighbour);
+        }
+    }
+
+    void Decimation::neighbours(int vertex, std::vector <int> &result) const {
+        result.clear();
+        for (int index : vertices_[vertex].triangles) {
+            const Triangle &triangle = triangles_[index];
+            if (triangle.removed) {
+                continue;
+            }
+            for (int j = 0; j < 3; ++j) {
+                if (triangle.v[j] != vertex) {
+                    result.push_back(triangle.v[j]);
+                }
+            }
+        }
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+    }
+
+    void Decimation::run(double max_error) {
+        // the queue holds the squared distances to the planes of both ends
+        double bound = max_error * max_error;
+        while (!queue_.empty() && queue_.top().error <= bound) {
+            Collapse collapse = queue_.top();
+            queue_.pop();
+            if (isValid(collapse)) {
+                applyCollapse(collapse);
+            }
+        }
+    }
+
+    void Decimation::write(std::vector <float> &vertices, std::vector <uint32_t> &indices,
+                           std::vector <float> &colors) const {
+        std::vector <int> remap(vertices_.size(), -1);
+        vertices.clear();
+        indices.clear();
+        colors.clear();
+        for (const Triangle &triangle : triangles_) {
+            if (triangle.removed) {
+                continue;
+            }
+            for (int j = 0; j < 3; ++j) {
+                int index = triangle.v[j];
+                if (remap[index] < 0) {
+                    remap[index] = vertices.size() / 3;
+                    const Vertex &vertex = vertices_[index];
+                    vertices.push_back(vertex.position(0));
+                    vertices.push_back(vertex.position(1));
+                    vertices.push_back(vertex.position(2));
+                    if (colors_) {
+                        colors.push_back(vertex.color(0));
+                        colors.push_back(vertex.color(1));
+                        colors.push_back(vertex.color(2));
+                    }
+                }
+                indices.push_back(remap[index]);
+            }
+        }
+    }
+}  // namespace
+
+namespace tango_augmented_reality {
+
+    MeshDecimator::MeshDecimator() : max_error_(0.0f) { }
+
+    void MeshDecimator::setMaxError(float max_error) {
+        max_error_ = std::max(max_error, 0.0f);
+    }
+
+    void MeshDecimator::decimate(std::vector <float> &vertices, std::vector <uint32_t> &indices,
+                                 std::vector <float> &colors) const {
+        float max_error = max_error_;
+        if (max_error <= 0.0f || indices.empty()) {
+            return;
+        }
+        Decimation decimation(vertices, indices, colors);
+        decimation.run(max_error);
+        decimation.write(vertices, indices, colors);
+    }
+
+}  // namespace tango_augmented_reality
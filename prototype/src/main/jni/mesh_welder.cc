@@ -0,0 +1,28 @@
+#include "tango-augmented-reality/mesh_welder.h"
+
+#include <cmath>
+
+namespace tango_augmented_reality {
+
+    MeshWelder::MeshWelder(float precision) : precision_(precision) { }
+
+    uint32_t MeshWelder::add(float x, float y, float z) {
+        Cell cell = {static_cast<int32_t>(std::lround(x / precision_)),
+                     static_cast<int32_t>(std::lround(y / precision_)),
+                     static_cast<int32_t>(std::lround(z / precision_))};
+        std::pair <std::unordered_map <Cell, uint32_t, CellHasher>::iterator, bool> inserted =
+                cells_.insert(std::make_pair(cell, static_cast<uint32_t>(getVertexCount())));
+        if (inserted.second) {
+            vertices_.push_back(cell.x * precision_);
+            vertices_.push_back(cell.y * precision_);
+            vertices_.push_back(cell.z * precision_);
+        }
+        return inserted.first->second;
+    }
+
+    void MeshWelder::clear() {
+        cells_.clear();
+        vertices_.clear();
+    }
+
+}  // namespace tango_augmented_reality
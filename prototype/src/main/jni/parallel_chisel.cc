@@ -0,0 +1,236 @@
+#include "tango-augmented-reality/parallel_chisel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <unordered_set>
+#include <utility>
+
+#include <open_chisel/geometry/Frustum.h>
+#include <open_chisel/truncation/QuadraticTruncator.h>
+#include <open_chisel/weighting/ConstantWeighter.h>
+
+namespace {
+    typedef std::unordered_set <chisel::ChunkID, chisel::ChunkHasher> ChunkIDSet;
+
+    chisel::ChunkID chunkAt(const chisel::Vec3 &point, float extent) {
+        return chisel::ChunkID(static_cast<int>(std::floor(point(0) / extent)),
+                               static_cast<int>(std::floor(point(1) / extent)),
+                               static_cast<int>(std::floor(point(2) / extent)));
+    }
+
+    // adds every chunk the segment from start to end passes through
+    void addChunksAlongRay(const chisel::Vec3 &start, const chisel::Vec3 &end, float extent,
+                           ChunkIDSet &ids) {
+        chisel::ChunkID id = chunkAt(start, extent);
+        chisel::ChunkID last = chunkAt(end, extent);
+        ids.insert(id);
+
+        chisel::Vec3 direction = end - start;
+        float length = direction.norm();
+        if (length <= 0.0f) {
+            return;
+        }
+        direction /= length;
+        int step[3];
+        float next[3];
+        float delta[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            if (direction(axis) > 0.0f) {
+                step[axis] = 1;
+                next[axis] = ((id(axis) + 1) * extent - start(axis)) / direction(axis);
+                delta[axis] = extent / direction(axis);
+            } else if (direction(axis) < 0.0f) {
+                step[axis] = -1;
+                next[axis] = (id(axis) * extent - start(axis)) / direction(axis);
+                delta[axis] = -extent / direction(axis);
+            } else {
+                step[axis] = 0;
+                next[axis] = std::numeric_limits<float>::max();
+                delta[axis] = std::numeric_limits<float>::max();
+            }
+        }
+        // walks the chunk grid one border crossing at a time
+        while (id != last) {
+            int axis = next[0] < next[1] ? (next[0] < next[2] ? 0 : 2)
+                                         : (next[1] < next[2] ? 1 : 2);
+            if (next[axis] > length) {
+                break;
+            }
+            id(axis) += step[axis];
+            next[axis] += delta[axis];
+            ids.insert(id);
+        }
+    }
+}  // namespace
+
+namespace tango_augmented_reality {
+
+    ParallelChisel::ParallelChisel(const Eigen::Vector3i &chunk_size, float resolution,
+                                   bool colors) : chisel::Chisel(chunk_size, resolution, colors) { }
+
+    chisel::ProjectionIntegrator ParallelChisel::createIntegrator(float truncation_scale,
+                                                                  float weighting,
+                                                                  float carving_distance) const {
+        // float quadratic, float linear, float constant, float scale
+        chisel::TruncatorPtr truncator(
+                new chisel::QuadraticTruncator(0.0030, 0.00152, 0.001504, truncation_scale));
+        chisel::ConstantWeighterPtr weighter(new chisel::ConstantWeighter(weighting));
+
+        chisel::Vec3List centroids;
+        chisel::ProjectionIntegrator integrator(truncator, weighter, carving_distance,
+                                                carving_distance > 0.0f, centroids);
+        integrator.SetCentroids(GetChunkManager().GetCentroids());
+        return integrator;
+    }
+
+    void ParallelChisel::integrateDepthScan(
+            WorkerPool &pool, const chisel::ProjectionIntegrator &integrator,
+            const boost::shared_ptr<const chisel::DepthImage<float>> &depth,
+            const chisel::Transform &extrinsic, const chisel::PinholeCamera &camera) {
+        chisel::Frustum frustum;
+        camera.SetupFrustum(extrinsic, &frustum);
+        chisel::ChunkIDList ids;
+        chunkManager.GetChunkIDsIntersecting(frustum, &ids);
+
+        integrateChunks(pool, ids, [&](chisel::Chunk *chunk) {
+            return integrator.Integrate(depth, camera, extrinsic, chunk);
+        });
+    }
+
+    void ParallelChisel::integratePointCloud(
+            WorkerPool &pool, const chisel::ProjectionIntegrator &integrator,
+            const chisel::PointCloud &cloud, const chisel::Transform &extrinsic,
+            float truncation, float max_distance) {
+        // points beyond the maximum distance neither add surface nor carve
+        chisel::PointCloud clipped;
+        // the band of truncation around each point creates chunks, as
+        // GetChunkIDsIntersecting does for the serial integration. The carving
+        // band in front of it only reaches chunks which exist already.
+        ChunkIDSet touched;
+        ChunkIDSet carved;
+        const float carving = integrator.IsCarvingEnabled() ? integrator.GetCarvingDist() : 0.0f;
+        const float extent = chunkManager.GetChunkSize()(0) * chunkManager.GetResolution();
+        for (const chisel::Vec3 &point : cloud.GetPoints()) {
+            float distance = point.norm();
+            if (distance <= 0.0f || distance > max_distance) {
+                continue;
+            }
+            clipped.AddPoint(point);
+            chisel::Vec3 direction = point / distance;
+            chisel::Vec3 start = extrinsic * (direction * (distance - truncation));
+            chisel::Vec3 end = extrinsic * (direction * (distance + truncation));
+            addChunksAlongRay(start, end, extent, touched);
+            if (carving > 0.0f) {
+                chisel::Vec3 front = extrinsic * (direction * std::max(
+                        distance - truncation - carving, 0.0f));
+                addChunksAlongRay(front, start, extent, carved);
+            }
+        }
+        for (const chisel::ChunkID &id : carved) {
+            if (chunkManager.HasChunk(id)) {
+                touched.insert(id);
+            }
+        }
+        chisel::ChunkIDList ids(touched.begin(), touched.end());
+
+        integrateChunks(pool, ids, [&](chisel::Chunk *chunk) {
+            return integrator.Integrate(clipped, extrinsic, chunk);
+        });
+    }
+
+    void ParallelChisel::integrateChunks(WorkerPool &pool, const chisel::ChunkIDList &ids,
+                                         const std::function<bool(chisel::Chunk *)> &integrate) {
+        // the chunk map is only changed before and after the parallel part
+        std::vector <chisel::ChunkPtr> chunks(ids.size());
+        std::vector <char> created(ids.size(), 0);
+        for (size_t i = 0; i < ids.size(); ++i) {
+            if (!chunkManager.HasChunk(ids[i])) {
+                chunkManager.CreateChunk(ids[i]);
+                created[i] = 1;
+            }
+            chunks[i] = chunkManager.GetChunk(ids[i]);
+        }
+
+        std::vector <char> updated(ids.size(), 0);
+        pool.run(static_cast<int>(ids.size()), [&](int i) {
+            updated[i] = integrate(chunks[i].get()) ? 1 : 0;
+        });
+
+        integrated_.clear();
+        for (size_t i = 0; i < ids.size(); ++i) {
+            if (updated[i]) {
+                integrated_.push_back(ids[i]);
+                remeshChunk(ids[i]);
+            } else if (created[i]) {
+                chunkManager.RemoveChunk(ids[i]);
+            }
+        }
+    }
+
+    void ParallelChisel::remeshChunk(const chisel::ChunkID &id) {
+        // the meshes of the neighbours share the border voxels
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dz = -1; dz <= 1; ++dz) {
+                    meshesToUpdate[id + chisel::ChunkID(dx, dy, dz)] = true;
+                }
+            }
+        }
+    }
+
+    size_t ParallelChisel::updateMeshes(
+            const chisel::Vec3 &camera, const chisel::Vec3 &forward, double budget_ms,
+            const std::function<void(const chisel::ChunkID &)> &meshed) {
+        typedef std::chrono::steady_clock Clock;
+        Clock::time_point start = Clock::now();
+
+        // distance grows up to three times for chunks behind the camera
+        const Eigen::Vector3i &size = chunkManager.GetChunkSize();
+        float resolution = chunkManager.GetResolution();
+        chisel::Vec3 extent(size(0) * resolution, size(1) * resolution, size(2) * resolution);
+        std::vector <std::pair<float, chisel::ChunkID>> queue;
+        queue.reserve(meshesToUpdate.size());
+        for (const std::pair <const chisel::ChunkID, bool> &chunk : meshesToUpdate) {
+            if (!chunk.second) {
+                continue;
+            }
+            chisel::Vec3 center = (chunk.first.cast<float>() + chisel::Vec3(0.5f, 0.5f, 0.5f))
+                    .cwiseProduct(extent);
+            chisel::Vec3 offset = center - camera;
+            float distance = offset.norm();
+            float facing = distance > 0.0f ? offset.dot(forward) / distance : 1.0f;
+            queue.push_back(std::make_pair(distance * (2.0f - facing), chunk.first));
+        }
+        std::sort(queue.begin(), queue.end(),
+                  [](const std::pair <float, chisel::ChunkID> &a,
+                     const std::pair <float, chisel::ChunkID> &b) {
+                      return a.first < b.first;
+                  });
+
+        chisel::ChunkSet single;
+        size_t done = 0;
+        while (done < queue.size()) {
+            const chisel::ChunkID &id = queue[done].second;
+            single.clear();
+            single[id] = true;
+            chunkManager.RecomputeMeshes(single);
+            meshesToUpdate.erase(id);
+            meshed(id);
+            ++done;
+            std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+            if (elapsed.count() >= budget_ms) {
+                break;
+            }
+        }
+        // unmarked entries are dropped as UpdateMeshes would
+        for (chisel::ChunkSet::iterator chunk = meshesToUpdate.begin();
+             chunk != meshesToUpdate.end();) {
+            chunk = chunk->second ? std::next(chunk) : meshesToUpdate.erase(chunk);
+        }
+        return queue.size() - done;
+    }
+
+}  // namespace tango_augmented_reality
@@ -0,0 +1,171 @@
+#include "tango-augmented-reality/plane_map.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "tango-augmented-reality/reconstructor.h"
+
+namespace {
+    // largest angle between the normals of fused planes, cos(15 deg)
+    const float kMinNormalDot = 0.966f;
+
+    // largest offset between fused planes in meters
+    const float kMaxPlaneOffset = 0.05f;
+
+    // gap allowed between the extents of fused planes in meters
+    const float kExtentMargin = 0.2f;
+}  // namespace
+
+namespace tango_augmented_reality {
+
+    void PlaneMap::fuse(const std::vector <PlaneSegment> &segments,
+                        const glm::mat4 &transformation) {
+        for (int s = 0; s < segments.size(); ++s) {
+            std::vector <glm::vec3> points;
+            points.reserve(segments[s].points.size());
+            PlaneStatistics statistics;
+            glm::vec3 min(INFINITY, INFINITY, INFINITY);
+            glm::vec3 max(-INFINITY, -INFINITY, -INFINITY);
+            for (int i = 0; i < segments[s].points.size(); ++i) {
+                glm::vec4 point = glm::vec4(segments[s].points[i], 1) * transformation;
+                glm::vec3 world(point.x, point.y, point.z);
+                points.push_back(world);
+                statistics.add(world);
+                min = glm::min(min, world);
+                max = glm::max(max, world);
+            }
+
+            glm::vec3 normal;
+            float distance;
+            if (statistics.fit(normal, distance) < 0.0f) {
+                continue;
+            }
+            // keep the orientation of the segment, which faces the camera
+            glm::vec4 facing = glm::vec4(segments[s].normal, 0) * transformation;
+            if (glm::dot(normal, glm::vec3(facing.x, facing.y, facing.z)) < 0.0f) {
+                normal = -normal;
+                distance = -distance;
+            }
+
+            int index = findPlane(normal, distance, min, max);
+            if (index < 0) {
+                MapPlane plane;
+                plane.statistics = statistics;
+                plane.normal = normal;
+                plane.distance = distance;
+                plane.changed = true;
+                planes_.push_back(plane);
+                updateHull(planes_.back(), points);
+                continue;
+            }
+
+            MapPlane &plane = planes_[index];
+            plane.statistics.merge(statistics);
+            glm::vec3 fused_normal;
+            float fused_distance;
+            plane.statistics.fit(fused_normal, fused_distance);
+            if (glm::dot(fused_normal, plane.normal) < 0.0f) {
+                fused_normal = -fused_normal;
+                fused_distance = -fused_distance;
+            }
+            plane.normal = fused_normal;
+            plane.distance = fused_distance;
+            plane.changed = true;
+            updateHull(plane, points);
+        }
+    }
+
+    int PlaneMap::findPlane(const glm::vec3 &normal, float distance, const glm::vec3 &min,
+                            const glm::vec3 &max) {
+        int best = -1;
+        float best_offset = kMaxPlaneOffset;
+        glm::vec3 center = (min + max) * 0.5f;
+        for (int i = 0; i < planes_.size(); ++i) {
+            const MapPlane &plane = planes_[i];
+            if (glm::dot(plane.normal, normal) < kMinNormalDot) {
+                continue;
+            }
+            if (min.x > plane.max.x + kExtentMargin || max.x < plane.min.x - kExtentMargin ||
+                min.y > plane.max.y + kExtentMargin || max.y < plane.min.y - kExtentMargin ||
+                min.z > plane.max.z + kExtentMargin || max.z < plane.min.z - kExtentMargin) {
+                continue;
+            }
+            // the segment also has to pass through the center of the plane,
+            // otherwise a tilted segment matches wherever it crosses the plane
+            glm::vec3 plane_center = (plane.min + plane.max) * 0.5f;
+            float offset = std::max(std::fabs(glm::dot(plane.normal, center) - plane.distance),
+                                    std::fabs(glm::dot(normal, plane_center) - distance));
+            if (offset < best_offset) {
+                best_offset = offset;
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    void PlaneMap::updateHull(MapPlane &plane, const std::vector <glm::vec3> &points) {
+        Plane model(plane.normal, plane.distance);
+
+        // project the old hull and the new points into the plane
+        std::vector <glm::vec2> projection;
+        projection.reserve(plane.hull.size() + points.size());
+        for (int i = 0; i < plane.hull.size(); ++i) {
+            glm::vec3 point = model.plane_z_rotation * (plane.hull[i] - model.plane_origin);
+            projection.push_back(glm::vec2(point.x, point.y));
+        }
+        for (int i = 0; i < points.size(); ++i) {
+            glm::vec3 point = model.plane_z_rotation * (points[i] - model.plane_origin);
+            projection.push_back(glm::vec2(point.x, point.y));
+        }
+
+        std::vector <glm::vec2> hull = convex_hull_.generateConvexHull(projection);
+        if (!hull.empty()) {
+            hull.pop_back();    // remove last point which is available twice
+        }
+
+        plane.hull.clear();
+        plane.min = glm::vec3(INFINITY, INFINITY, INFINITY);
+        plane.max = glm::vec3(-INFINITY, -INFINITY, -INFINITY);
+        for (int i = 0; i < hull.size(); ++i) {
+            glm::vec3 point = model.inverse_plane_z_rotation * glm::vec3(hull[i].x, hull[i].y, 0.0);
+            point = point + model.plane_origin;
+            plane.hull.push_back(point);
+            plane.min = glm::min(plane.min, point);
+            plane.max = glm::max(plane.max, point);
+        }
+    }
+
+    void PlaneMap::updateSlices(MeshSliceMap &slices) {
+        for (int i = 0; i < planes_.size(); ++i) {
+            MapPlane &plane = planes_[i];
+            if (!plane.changed) {
+                continue;
+            }
+            plane.changed = false;
+            if (plane.hull.size() < 3) {
+                slices.erase(i);
+                continue;
+            }
+
+            // triangle fan over the convex hull
+            std::shared_ptr <MeshSlice> slice = std::make_shared<MeshSlice>();
+            for (int j = 0; j < plane.hull.size(); ++j) {
+                slice->vertices.push_back(plane.hull[j].x);
+                slice->vertices.push_back(plane.hull[j].y);
+                slice->vertices.push_back(plane.hull[j].z);
+            }
+            for (int j = 0; j + 2 < plane.hull.size(); ++j) {
+                slice->indices.push_back(0);
+                slice->indices.push_back(j + 1);
+                slice->indices.push_back(j + 2);
+            }
+            slice->updateBounds();
+            slices[i] = slice;
+        }
+    }
+
+    void PlaneMap::clear() {
+        planes_.clear();
+    }
+
+}  // namespace tango_augmented_reality
@@ -17,13 +17,113 @@
 #include "tango-augmented-reality/plane_mesh.h"
 #include <tango-gl/shaders.h>
 
+namespace {
+    // depth frames waiting for the worker, older ones get dropped
+    const size_t kFrameQueueCapacity = 4;
+
+    // time the worker spends on queued clusters before it looks for new frames
+    const double kReconstructionSliceMs = 20.0;
+
+    // time the worker waits for a frame when nothing else is left to do
+    const int kIdleWaitMs = 100;
+
+    // depth only shader which moves each vertex towards the camera by pull
+    const std::string kDepthVertexShader =
+            "precision highp float;\n"
+                    "uniform mat4 mv;\n"
+                    "uniform mat4 projection;\n"
+                    "uniform float pull;\n"
+                    "attribute vec4 vertex;\n"
+                    "void main() {\n"
+                    "  vec4 position = mv * vertex;\n"
+                    "  float distance = length(position.xyz);\n"
+                    "  position.xyz *= max(distance - pull, 0.01) / distance;\n"
+                    "  gl_Position = projection * position;\n"
+                    "}\n";
+
+    const std::string kDepthFragmentShader =
+            "precision highp float;\n"
+                    "void main() {\n"
+                    "  gl_FragColor = vec4(1.0);\n"
+                    "}\n";
+}  // namespace
+
 namespace tango_augmented_reality {
 
-    PlaneMesh::PlaneMesh() {
+    PlaneMesh::PlaneMesh() : frames_(kFrameQueueCapacity), engine_(OCTREE_RANSAC),
+                             active_engine_(OCTREE_RANSAC), running_(true),
+                             clear_requested_(false) {
         render_mode_ = GL_TRIANGLES;
         SetShader();
 
         tree = new ReconstructionOcTree(glm::vec3(-20, -20, -20), 40, 7);
+        worker_ = std::thread(&PlaneMesh::run, this);
+    }
+
+    PlaneMesh::~PlaneMesh() {
+        running_ = false;
+        frames_.notify();
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+    }
+
+    void PlaneMesh::addFrame(glm::mat4 transformation, const std::vector <float> &vertices) {
+        PlaneFrame frame;
+        frame.transformation = transformation;
+        frame.vertices = vertices;
+        if (frames_.push(std::move(frame))) {
+            LOGI("Plane reconstruction is behind, dropped a depth frame");
+        }
+    }
+
+    void PlaneMesh::setCamera(const glm::mat4 &view_projection, const glm::vec3 &position) {
+        std::lock_guard <std::mutex> lock(camera_mutex_);
+        camera_view_projection_ = view_projection;
+        camera_position_ = position;
+    }
+
+    void PlaneMesh::setIntrinsics(float fx, float fy, float cx, float cy, int width, int height) {
+        std::lock_guard <std::mutex> lock(segmenter_mutex_);
+        segmenter_.setIntrinsics(fx, fy, cx, cy, width, height);
+    }
+
+    void PlaneMesh::setEngine(int engine) {
+        if (engine_.exchange(engine) != engine) {
+            // slices of both engines use different keys, so start from scratch
+            clear();
+        }
+    }
+
+    void PlaneMesh::run() {
+        while (running_) {
+            PlaneFrame frame;
+            // only wait for new frames if there are no clusters left to reconstruct
+            int timeout = scheduler_.getPendingCount() > 0 ? 0 : kIdleWaitMs;
+            bool has_frame = frames_.pop(frame, timeout);
+
+            if (clear_requested_.exchange(false)) {
+                scheduler_.clear();
+                tree->clear();
+                plane_map_.clear();
+                slices_.clear();
+                meshes_.back().clear();
+                meshes_.publish();
+                // an engine switch only takes effect together with its clear
+                active_engine_ = engine_.load();
+                continue;
+            }
+            if (active_engine_ == ORGANIZED_SEGMENTATION) {
+                if (has_frame) {
+                    segmentFrame(frame.transformation, frame.vertices);
+                }
+                continue;
+            }
+            if (has_frame) {
+                addPoints(frame.transformation, frame.vertices);
+            }
+            reconstruct(kReconstructionSliceMs);
+        }
     }
 
     void PlaneMesh::addPoints(glm::mat4 transformation, std::vector <float> &vertices) {
@@ -34,25 +134,72 @@ namespace tango_augmented_reality {
             tree->addPoint(glm::vec3(point.x, point.y, point.z));
         }
         LOGE("got %d points into %d clusters", tree->getSize(), tree->getClusterCount());
-        tree->reconstruct();
+        scheduler_.collect(tree);
+    }
+
+    void PlaneMesh::segmentFrame(glm::mat4 transformation, std::vector <float> &vertices) {
+        std::vector <PlaneSegment> segments;
+        {
+            std::lock_guard <std::mutex> lock(segmenter_mutex_);
+            segmenter_.segment(vertices, segments);
+        }
+        plane_map_.fuse(segments, transformation);
+        LOGI("Segmented %d planes, %d planes in map", segments.size(),
+             plane_map_.getPlaneCount());
+
+        plane_map_.updateSlices(slices_);
+        meshes_.back() = slices_;
+        meshes_.publish();
     }
 
-    void PlaneMesh::updateVertices() {
-        std::vector <GLfloat> mesh;
-        std::vector <glm::vec3> reconstruction = tree->getMesh();
-        for (int i = 0; i < reconstruction.size(); ++i) {
-            mesh.push_back(reconstruction[i].x);
-            mesh.push_back(reconstruction[i].y);
-            mesh.push_back(reconstruction[i].z);
+    bool PlaneMesh::reconstruct(double budget_ms) {
+        if (scheduler_.getPendingCount() == 0) {
+            return false;
         }
-        LOGI("Got %d polygons", mesh.size() / 9);
-        if (mesh.size() >= 0) {
-            std::lock_guard <std::mutex> lock(render_mutex);
-            SetVertices(mesh);
+        glm::mat4 view_projection;
+        glm::vec3 camera_position;
+        {
+            std::lock_guard <std::mutex> lock(camera_mutex_);
+            view_projection = camera_view_projection_;
+            camera_position = camera_position_;
         }
+        std::vector <ReconstructionOcTree *> leaves;
+        int processed = scheduler_.process(ViewFrustum(view_projection), camera_position,
+                                           budget_ms, leaves);
+        LOGI("Reconstructed %d clusters, %d pending", processed, scheduler_.getPendingCount());
+        updateVertices(leaves);
+        return true;
     }
 
-    PlaneMesh::PlaneMesh(GLenum render_mode) {
+    void PlaneMesh::updateVertices(const std::vector <ReconstructionOcTree *> &leaves) {
+        for (int i = 0; i < leaves.size(); ++i) {
+            uint64_t key = reinterpret_cast<uintptr_t>(leaves[i]);
+            std::vector <glm::vec3> reconstruction = leaves[i]->getMesh();
+            if (reconstruction.empty()) {
+                slices_.erase(key);
+                continue;
+            }
+            std::shared_ptr <MeshSlice> slice = std::make_shared<MeshSlice>();
+            slice->vertices.reserve(reconstruction.size() * 3);
+            slice->indices.reserve(reconstruction.size());
+            for (int j = 0; j < reconstruction.size(); ++j) {
+                slice->vertices.push_back(reconstruction[j].x);
+                slice->vertices.push_back(reconstruction[j].y);
+                slice->vertices.push_back(reconstruction[j].z);
+                slice->indices.push_back(j);
+            }
+            slice->updateBounds();
+            slices_[key] = slice;
+        }
+        // copies only the slice pointers, the render thread shares the slices
+        meshes_.back() = slices_;
+        meshes_.publish();
+    }
+
+    PlaneMesh::PlaneMesh(GLenum render_mode) : frames_(kFrameQueueCapacity),
+                                               engine_(OCTREE_RANSAC),
+                                               active_engine_(OCTREE_RANSAC), running_(false),
+                                               clear_requested_(false) {
         render_mode_ = render_mode;
     }
 
@@ -69,13 +216,23 @@ namespace tango_augmented_reality {
 
         SetColor(1.0, 0.0, 0.0);
         SetAlpha(0.4);
+
+        depth_program_ = tango_gl::util::CreateProgram(kDepthVertexShader.c_str(),
+                                                       kDepthFragmentShader.c_str());
+        if (!depth_program_) {
+            LOGE("Could not create depth program.");
+        }
+        uniform_depth_mv_ = glGetUniformLocation(depth_program_, "mv");
+        uniform_depth_projection_ = glGetUniformLocation(depth_program_, "projection");
+        uniform_depth_pull_ = glGetUniformLocation(depth_program_, "pull");
+        attrib_depth_vertices_ = glGetAttribLocation(depth_program_, "vertex");
     }
 
     void PlaneMesh::clear() {
-        std::lock_guard <std::mutex> lock(render_mutex);
-        std::vector <GLfloat> mesh;
-        SetVertices(mesh);
-        tree->clear();
+        // the worker owns the octree, it resets it and publishes an empty mesh
+        frames_.clear();
+        clear_requested_ = true;
+        frames_.notify();
     }
 
     void PlaneMesh::Render(const glm::mat4 &projection_mat,
@@ -87,20 +244,34 @@ namespace tango_augmented_reality {
         glUniformMatrix4fv(uniform_mvp_mat_, 1, GL_FALSE, glm::value_ptr(mvp_mat));
         glUniform4f(uniform_color_, red_, green_, blue_, alpha_);
 
+        // take over the newest slices of the worker and upload the changed ones
+        if (meshes_.update()) {
+            buffers_.update(meshes_.front());
+        }
+
         glEnableVertexAttribArray(attrib_vertices_);
+        buffers_.draw(render_mode_, attrib_vertices_, ViewFrustum(mvp_mat));
 
-        if (!indices_.empty()) {
-            glVertexAttribPointer(attrib_vertices_, 3, GL_FLOAT, GL_FALSE,
-                                  3 * sizeof(GLfloat), vertices_.data());
-            glDrawElements(render_mode_, indices_.size(), GL_UNSIGNED_SHORT,
-                           indices_.data());
-        } else {
-            glVertexAttribPointer(attrib_vertices_, 3, GL_FLOAT, GL_FALSE,
-                                  3 * sizeof(GLfloat), &vertices_[0]);
-            glDrawArrays(render_mode_, 0, vertices_.size() / 3);
+        glDisableVertexAttribArray(attrib_vertices_);
+        glUseProgram(0);
+    }
+
+    void PlaneMesh::RenderDepth(const glm::mat4 &projection_mat, const glm::mat4 &view_mat,
+                                float pull_forward) const {
+        glUseProgram(depth_program_);
+        glm::mat4 mv_mat = view_mat * GetTransformationMatrix();
+        glUniformMatrix4fv(uniform_depth_mv_, 1, GL_FALSE, glm::value_ptr(mv_mat));
+        glUniformMatrix4fv(uniform_depth_projection_, 1, GL_FALSE, glm::value_ptr(projection_mat));
+        glUniform1f(uniform_depth_pull_, pull_forward);
+
+        if (meshes_.update()) {
+            buffers_.update(meshes_.front());
         }
 
-        glDisableVertexAttribArray(attrib_vertices_);
+        glEnableVertexAttribArray(attrib_depth_vertices_);
+        buffers_.draw(render_mode_, attrib_depth_vertices_,
+                      ViewFrustum(projection_mat * mv_mat));
+        glDisableVertexAttribArray(attrib_depth_vertices_);
         glUseProgram(0);
     }
 }  // namespace tango_augmented_reality
@@ -0,0 +1,258 @@
+#include "tango-augmented-reality/plane_segmenter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace {
+    // size of a grid cell in depth image pixels
+    const int kCellSize = 8;
+
+    // points a cell needs for its initial plane fit
+    const int kMinPointsPerCell = 6;
+
+    // cells a node needs to be reported as plane
+    const int kMinCellsPerPlane = 6;
+
+    // depth noise model, sigma = kDepthNoise * z^2 + kMinNoise in meters
+    const float kDepthNoise = 0.005f;
+    const float kMinNoise = 0.005f;
+
+    // points further away from the plane than this many sigmas are dropped
+    const float kInlierSigmas = 3.0f;
+}  // namespace
+
+namespace tango_augmented_reality {
+
+    OrganizedPlaneSegmenter::OrganizedPlaneSegmenter() : fx_(0), fy_(0), cx_(0), cy_(0),
+                                                         grid_width_(0), grid_height_(0) { }
+
+    void OrganizedPlaneSegmenter::setIntrinsics(float fx, float fy, float cx, float cy,
+                                                int width, int height) {
+        fx_ = fx;
+        fy_ = fy;
+        cx_ = cx;
+        cy_ = cy;
+        grid_width_ = (width + kCellSize - 1) / kCellSize;
+        grid_height_ = (height + kCellSize - 1) / kCellSize;
+    }
+
+    void OrganizedPlaneSegmenter::segment(const std::vector <float> &vertices,
+                                          std::vector <PlaneSegment> &segments) {
+        segments.clear();
+        if (grid_width_ == 0 || grid_height_ == 0) {
+            return;
+        }
+        buildGrid(vertices);
+        initGraph(vertices);
+
+        std::priority_queue <Candidate> queue;
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            Candidate candidate = {nodes_[i].mse, static_cast<int>(i)};
+            queue.push(candidate);
+        }
+
+        // merge the most planar node with its best fitting neighbour until no
+        // merge stays within the noise, nodes are never modified but replaced
+        while (!queue.empty()) {
+            int v = queue.top().node;
+            queue.pop();
+            if (!nodes_[v].alive) {
+                continue;
+            }
+
+            // only the error is needed to pick the best neighbour
+            int best = -1;
+            float best_mse = 0.0f;
+            PlaneStatistics best_statistics;
+            for (int u : nodes_[v].neighbours) {
+                PlaneStatistics statistics = nodes_[v].statistics;
+                statistics.merge(nodes_[u].statistics);
+                float mse = statistics.fitError();
+                if (mse >= 0.0f && (best < 0 || mse < best_mse)) {
+                    best = u;
+                    best_mse = mse;
+                    best_statistics = statistics;
+                }
+            }
+
+            if (best >= 0 && best_mse < maxMse(best_statistics.getCentroid().z)) {
+                Node merged;
+                merged.statistics = best_statistics;
+                merged.mse = merged.statistics.fit(merged.normal, merged.distance);
+                merged.alive = true;
+                // the larger node hands over its containers to avoid copies
+                int large = nodes_[v].cells.size() >= nodes_[best].cells.size() ? v : best;
+                int small = large == v ? best : v;
+                merged.cells.swap(nodes_[large].cells);
+                merged.cells.insert(merged.cells.end(), nodes_[small].cells.begin(),
+                                    nodes_[small].cells.end());
+                merged.neighbours.swap(nodes_[large].neighbours);
+                for (int n : nodes_[small].neighbours) {
+                    addNeighbour(merged, n);
+                }
+                removeNeighbour(merged, v);
+                removeNeighbour(merged, best);
+
+                int w = nodes_.size();
+                for (int n : merged.neighbours) {
+                    removeNeighbour(nodes_[n], v);
+                    removeNeighbour(nodes_[n], best);
+                    addNeighbour(nodes_[n], w);
+                }
+                nodes_[v].alive = false;
+                nodes_[best].alive = false;
+                nodes_.push_back(std::move(merged));
+
+                Candidate candidate = {best_mse, w};
+                queue.push(candidate);
+            } else {
+                // the node can not grow anymore
+                if (nodes_[v].cells.size() >= kMinCellsPerPlane) {
+                    extract(nodes_[v], vertices, segments);
+                }
+                for (int n : nodes_[v].neighbours) {
+                    removeNeighbour(nodes_[n], v);
+                }
+                nodes_[v].neighbours.clear();
+                nodes_[v].alive = false;
+            }
+        }
+    }
+
+    void OrganizedPlaneSegmenter::buildGrid(const std::vector <float> &vertices) {
+        int count = vertices.size() / 3;
+        int cells = grid_width_ * grid_height_;
+        point_cell_.assign(count, -1);
+        cell_start_.assign(cells + 1, 0);
+
+        for (int i = 0; i < count; ++i) {
+            float x = vertices[i * 3];
+            float y = vertices[i * 3 + 1];
+            float z = vertices[i * 3 + 2];
+            if (!(z > 0.0f)) {
+                continue;
+            }
+            float px = fx_ * x / z + cx_;
+            float py = fy_ * y / z + cy_;
+            if (px < 0.0f || py < 0.0f) {
+                continue;
+            }
+            int u = static_cast<int>(px) / kCellSize;
+            int v = static_cast<int>(py) / kCellSize;
+            if (u >= grid_width_ || v >= grid_height_) {
+                continue;
+            }
+            point_cell_[i] = v * grid_width_ + u;
+            cell_start_[point_cell_[i] + 1]++;
+        }
+
+        // counting sort of the point indices by cell
+        for (int c = 0; c < cells; ++c) {
+            cell_start_[c + 1] += cell_start_[c];
+        }
+        cell_points_.resize(cell_start_[cells]);
+        std::vector <int> next(cell_start_.begin(), cell_start_.end() - 1);
+        for (int i = 0; i < count; ++i) {
+            if (point_cell_[i] >= 0) {
+                cell_points_[next[point_cell_[i]]++] = i;
+            }
+        }
+    }
+
+    void OrganizedPlaneSegmenter::initGraph(const std::vector <float> &vertices) {
+        int cells = grid_width_ * grid_height_;
+        nodes_.clear();
+        cell_node_.assign(cells, -1);
+
+        for (int c = 0; c < cells; ++c) {
+            if (cell_start_[c + 1] - cell_start_[c] < kMinPointsPerCell) {
+                continue;
+            }
+            Node node;
+            for (int p = cell_start_[c]; p < cell_start_[c + 1]; ++p) {
+                int i = cell_points_[p];
+                node.statistics.add(glm::vec3(vertices[i * 3], vertices[i * 3 + 1],
+                                              vertices[i * 3 + 2]));
+            }
+            node.mse = node.statistics.fit(node.normal, node.distance);
+            if (node.mse < 0.0f || node.mse >= maxMse(node.statistics.getCentroid().z)) {
+                continue;
+            }
+            node.cells.push_back(c);
+            node.alive = true;
+            cell_node_[c] = nodes_.size();
+            nodes_.push_back(std::move(node));
+        }
+
+        // four neighbourhood of the grid
+        for (int y = 0; y < grid_height_; ++y) {
+            for (int x = 0; x < grid_width_; ++x) {
+                int a = cell_node_[y * grid_width_ + x];
+                if (a < 0) {
+                    continue;
+                }
+                if (x + 1 < grid_width_) {
+                    int b = cell_node_[y * grid_width_ + x + 1];
+                    if (b >= 0) {
+                        addNeighbour(nodes_[a], b);
+                        addNeighbour(nodes_[b], a);
+                    }
+                }
+                if (y + 1 < grid_height_) {
+                    int b = cell_node_[(y + 1) * grid_width_ + x];
+                    if (b >= 0) {
+                        addNeighbour(nodes_[a], b);
+                        addNeighbour(nodes_[b], a);
+                    }
+                }
+            }
+        }
+    }
+
+    void OrganizedPlaneSegmenter::addNeighbour(Node &node, int neighbour) {
+        if (std::find(node.neighbours.begin(), node.neighbours.end(), neighbour) ==
+            node.neighbours.end()) {
+            node.neighbours.push_back(neighbour);
+        }
+    }
+
+    void OrganizedPlaneSegmenter::removeNeighbour(Node &node, int neighbour) {
+        std::vector <int>::iterator it = std::find(node.neighbours.begin(),
+                                                   node.neighbours.end(), neighbour);
+        if (it != node.neighbours.end()) {
+            *it = node.neighbours.back();
+            node.neighbours.pop_back();
+        }
+    }
+
+    float OrganizedPlaneSegmenter::maxMse(float depth) {
+        float sigma = kDepthNoise * depth * depth + kMinNoise;
+        return sigma * sigma;
+    }
+
+    void OrganizedPlaneSegmenter::extract(const Node &node, const std::vector <float> &vertices,
+                                          std::vector <PlaneSegment> &segments) {
+        PlaneSegment segment;
+        segment.normal = node.normal;
+        segment.distance = node.distance;
+        // the camera sits in the origin, so a positive distance faces away
+        if (segment.distance > 0.0f) {
+            segment.normal = -segment.normal;
+            segment.distance = -segment.distance;
+        }
+
+        for (int c : node.cells) {
+            for (int p = cell_start_[c]; p < cell_start_[c + 1]; ++p) {
+                int i = cell_points_[p];
+                glm::vec3 point(vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2]);
+                float error = glm::dot(segment.normal, point) - segment.distance;
+                if (std::fabs(error) < kInlierSigmas * std::sqrt(maxMse(point.z))) {
+                    segment.points.push_back(point);
+                }
+            }
+        }
+        segments.push_back(segment);
+    }
+
+}  // namespace tango_augmented_reality
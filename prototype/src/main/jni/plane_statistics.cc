@@ -0,0 +1,94 @@
+#include "tango-augmented-reality/plane_statistics.h"
+
+#include <algorithm>
+
+#include <Eigen/Core>
+#include <Eigen/Eigenvalues>
+
+namespace tango_augmented_reality {
+
+    PlaneStatistics::PlaneStatistics() : count_(0) {
+        for (int i = 0; i < 3; ++i) {
+            sum_[i] = 0.0;
+        }
+        for (int i = 0; i < 6; ++i) {
+            squares_[i] = 0.0;
+        }
+    }
+
+    void PlaneStatistics::add(const glm::vec3 &point) {
+        count_++;
+        sum_[0] += point.x;
+        sum_[1] += point.y;
+        sum_[2] += point.z;
+        squares_[0] += point.x * point.x;
+        squares_[1] += point.x * point.y;
+        squares_[2] += point.x * point.z;
+        squares_[3] += point.y * point.y;
+        squares_[4] += point.y * point.z;
+        squares_[5] += point.z * point.z;
+    }
+
+    void PlaneStatistics::merge(const PlaneStatistics &other) {
+        count_ += other.count_;
+        for (int i = 0; i < 3; ++i) {
+            sum_[i] += other.sum_[i];
+        }
+        for (int i = 0; i < 6; ++i) {
+            squares_[i] += other.squares_[i];
+        }
+    }
+
+    glm::vec3 PlaneStatistics::getCentroid() const {
+        if (count_ == 0) {
+            return glm::vec3(0, 0, 0);
+        }
+        return glm::vec3(sum_[0] / count_, sum_[1] / count_, sum_[2] / count_);
+    }
+
+    void PlaneStatistics::covariance(double mean[3], double cv[9]) const {
+        for (int i = 0; i < 3; ++i) {
+            mean[i] = sum_[i] / count_;
+        }
+        cv[0] = squares_[0] / count_ - mean[0] * mean[0];
+        cv[1] = squares_[1] / count_ - mean[0] * mean[1];
+        cv[2] = squares_[2] / count_ - mean[0] * mean[2];
+        cv[4] = squares_[3] / count_ - mean[1] * mean[1];
+        cv[5] = squares_[4] / count_ - mean[1] * mean[2];
+        cv[8] = squares_[5] / count_ - mean[2] * mean[2];
+        cv[3] = cv[1];
+        cv[6] = cv[2];
+        cv[7] = cv[5];
+    }
+
+    float PlaneStatistics::fit(glm::vec3 &normal, float &distance) const {
+        if (count_ < 3) {
+            return -1.0f;
+        }
+        double mean[3];
+        Eigen::Matrix3d cv;
+        covariance(mean, cv.data());
+
+        // eigenvalues are sorted in increasing order
+        Eigen::SelfAdjointEigenSolver <Eigen::Matrix3d> es;
+        es.computeDirect(cv);
+        Eigen::Vector3d n = es.eigenvectors().col(0);
+        normal = glm::normalize(glm::vec3(n(0), n(1), n(2)));
+        distance = normal.x * mean[0] + normal.y * mean[1] + normal.z * mean[2];
+        return std::max(0.0, es.eigenvalues()(0));
+    }
+
+    float PlaneStatistics::fitError() const {
+        if (count_ < 3) {
+            return -1.0f;
+        }
+        double mean[3];
+        Eigen::Matrix3d cv;
+        covariance(mean, cv.data());
+
+        Eigen::SelfAdjointEigenSolver <Eigen::Matrix3d> es;
+        es.computeDirect(cv, Eigen::EigenvaluesOnly);
+        return std::max(0.0, es.eigenvalues()(0));
+    }
+
+}  // namespace tango_augmented_reality
@@ -0,0 +1,99 @@
+#include "tango-augmented-reality/range_allocator.h"
+
+#include <algorithm>
+
+namespace {
+    typedef std::map <size_t, size_t> RangeMap;
+
+    // inserts [offset, offset + size) and merges it with overlapping or
+    // adjacent ranges
+    void insertMerged(RangeMap &ranges, size_t offset, size_t size) {
+        size_t begin = offset;
+        size_t end = offset + size;
+
+        RangeMap::iterator it = ranges.upper_bound(begin);
+        if (it != ranges.begin()) {
+            RangeMap::iterator previous = it;
+            --previous;
+            if (previous->first + previous->second >= begin) {
+                it = previous;
+            }
+        }
+        while (it != ranges.end() && it->first <= end) {
+            begin = std::min(begin, it->first);
+            end = std::max(end, it->first + it->second);
+            it = ranges.erase(it);
+        }
+        ranges[begin] = end - begin;
+    }
+}  // namespace
+
+namespace tango_augmented_reality {
+
+    RangeAllocator::RangeAllocator(size_t capacity) : capacity_(0), used_(0) {
+        grow(capacity);
+    }
+
+    bool RangeAllocator::allocate(size_t size, size_t &offset) {
+        if (size == 0) {
+            offset = 0;
+            return true;
+        }
+        for (RangeMap::iterator it = free_.begin(); it != free_.end(); ++it) {
+            if (it->second < size) {
+                continue;
+            }
+            offset = it->first;
+            size_t remaining = it->second - size;
+            free_.erase(it);
+            if (remaining > 0) {
+                free_[offset + size] = remaining;
+            }
+            used_ += size;
+            return true;
+        }
+        return false;
+    }
+
+    void RangeAllocator::release(size_t offset, size_t size) {
+        if (size == 0) {
+            return;
+        }
+        insertMerged(free_, offset, size);
+        used_ -= size;
+    }
+
+    void RangeAllocator::grow(size_t capacity) {
+        if (capacity <= capacity_) {
+            return;
+        }
+        insertMerged(free_, capacity_, capacity - capacity_);
+        capacity_ = capacity;
+    }
+
+    void RangeAllocator::markDirty(size_t offset, size_t size) {
+        if (size == 0) {
+            return;
+        }
+        insertMerged(dirty_, offset, size);
+    }
+
+    void RangeAllocator::takeDirtyRanges(std::vector <Range> &ranges) {
+        ranges.clear();
+        for (RangeMap::iterator it = dirty_.begin(); it != dirty_.end(); ++it) {
+            Range range = {it->first, it->second};
+            ranges.push_back(range);
+        }
+        dirty_.clear();
+    }
+
+    void RangeAllocator::clear() {
+        free_.clear();
+        dirty_.clear();
+        used_ = 0;
+        if (capacity_ > 0) {
+            free_[0] = capacity_;
+        }
+    }
+
+}  // namespace tango_augmented_reality
@@ -12,6 +12,9 @@ namespace tango_augmented_reality {
         range_ = range;
         halfRange_ = range / 2;
         depth_ = depth;
+        updated = false;
+        collected_ = false;
+        new_points_ = 0;
         children_ = (ReconstructionOcTree **) malloc(sizeof(ReconstructionOcTree *) * 8);
         for (int i = 0; i < 8; ++i) {
             is_available_[i] = false;
@@ -47,6 +50,7 @@ namespace tango_augmented_reality {
         }
         updated = true;
         if (depth_ == 0) {
+            new_points_++;
             reconstructor->addPoint(point);
         } else {
             int index = getChildIndex(point);
@@ -70,17 +74,33 @@ namespace tango_augmented_reality {
         return 1;
     }
 
-    void ReconstructionOcTree::reconstruct() {
-        if (depth_ == 0 && updated) {
-            reconstructor->reconstruct();
-        } else if (updated) {
-            for (int i = 0; i < 8; ++i) {
-                if (is_available_[i]) {
-                    children_[i]->reconstruct();
-                }
+    void ReconstructionOcTree::collectUpdatedLeaves(std::vector <ReconstructionOcTree *> &leaves) {
+        if (!updated) {
+            return;
+        }
+        if (depth_ == 0) {
+            // leaf stays updated until it gets reconstructed
+            if (!collected_) {
+                collected_ = true;
+                leaves.push_back(this);
             }
+            return;
         }
+        for (int i = 0; i < 8; ++i) {
+            if (is_available_[i]) {
+                children_[i]->collectUpdatedLeaves(leaves);
+            }
+        }
+        updated = false;
+    }
+
+    void ReconstructionOcTree::reconstructLeaf() {
+        reconstructor->reconstruct();
+        // points which do not belong to a plane are dropped after each reconstruction
+        reconstructor->clearPoints();
         updated = false;
+        collected_ = false;
+        new_points_ = 0;
     }
 
     std::vector <glm::vec3> ReconstructionOcTree::getMesh() {
@@ -96,7 +116,6 @@ namespace tango_augmented_reality {
             }
             return mesh;
         }
-        reconstructor->clearPoints();
         return reconstructor->getMesh();
     }
 
@@ -110,7 +129,10 @@ namespace tango_augmented_reality {
             }
         } else {
             reconstructor->reset();
+            collected_ = false;
+            new_points_ = 0;
         }
+        updated = false;
     }
 
     void ReconstructionOcTree::initChild(glm::vec3 location, int index) {
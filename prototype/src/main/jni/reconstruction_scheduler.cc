@@ -0,0 +1,69 @@
+#include "tango-augmented-reality/reconstruction_scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+    // priority boost of leaves inside the current camera frustum
+    const float kVisibleWeight = 8.0f;
+
+    double elapsedMilliseconds(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+    }
+}  // namespace
+
+namespace tango_augmented_reality {
+
+    void ReconstructionScheduler::collect(ReconstructionOcTree *tree) {
+        std::vector <ReconstructionOcTree *> leaves;
+        tree->collectUpdatedLeaves(leaves);
+        for (int i = 0; i < leaves.size(); ++i) {
+            PendingLeaf pending = {leaves[i], 0.0f};
+            pending_.push_back(pending);
+        }
+    }
+
+    int ReconstructionScheduler::process(const ViewFrustum &frustum,
+                                         const glm::vec3 &camera_position,
+                                         double budget_ms,
+                                         std::vector <ReconstructionOcTree *> &reconstructed) {
+        if (pending_.empty()) {
+            return 0;
+        }
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        // priorities change with the camera, so they are rated on every call
+        for (int i = 0; i < pending_.size(); ++i) {
+            pending_[i].priority = priority(pending_[i].leaf, frustum, camera_position);
+        }
+        std::sort(pending_.begin(), pending_.end(),
+                  [](const PendingLeaf &a, const PendingLeaf &b) {
+                      return a.priority > b.priority;
+                  });
+
+        // at least one leaf is processed per call to guarantee progress
+        int processed = 0;
+        while (processed < pending_.size() &&
+               (processed == 0 || elapsedMilliseconds(start) < budget_ms)) {
+            pending_[processed].leaf->reconstructLeaf();
+            reconstructed.push_back(pending_[processed].leaf);
+            processed++;
+        }
+        pending_.erase(pending_.begin(), pending_.begin() + processed);
+        return processed;
+    }
+
+    float ReconstructionScheduler::priority(ReconstructionOcTree *leaf, const ViewFrustum &frustum,
+                                            const glm::vec3 &camera_position) {
+        glm::vec3 center = leaf->getCenter();
+        float radius = leaf->getRange() * 0.866f;
+        float distance = glm::distance(center, camera_position);
+        float score = leaf->getNewPointCount() / (1.0f + distance * distance);
+        if (frustum.intersectsSphere(center, radius)) {
+            score *= kVisibleWeight;
+        }
+        return score;
+    }
+
+}  // namespace tango_augmented_reality
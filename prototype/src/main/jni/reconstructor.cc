@@ -37,8 +37,7 @@ namespace tango_augmented_reality {
                                                          ransac_best_supporting_points);
 
             // CALCULATE THE CONVEX HULL
-            ConvexHull *h = new ConvexHull();
-            std::vector <glm::vec2> hull = h->generateConvexHull(projection);
+            std::vector <glm::vec2> hull = convex_hull_.generateConvexHull(projection);
             hull.pop_back();    // remove last point which is available twice
             if (hull.size() < 4) {
                 plane_available[planeIndex] = false;
@@ -43,6 +43,21 @@ namespace {
     glm::vec3 kCubeScale = glm::vec3(0.10f, 0.10f, 0.10f);
     const tango_gl::Color kCubeColor(1.0f, 0.f, 0.f);
 
+    // Distance in meters the planes are moved towards the camera when they
+    // complete the depth map, depth noise within this range is replaced.
+    const float kPlaneCompletionPull = 0.03f;
+
+    // Keyframes of the TSDF, the integration drops frames when it is behind,
+    // so the minimum interval mostly saves the copies of the depth frames.
+    const tango_augmented_reality::KeyframeSettings kTsdfKeyframes = {
+            0.05f, glm::radians(8.0f), 0.15f, 0.1, 5.0
+    };
+
+    // Keyframes of the plane reconstruction, planes change less with the view.
+    const tango_augmented_reality::KeyframeSettings kPlaneKeyframes = {
+            0.1f, glm::radians(12.0f), 0.2f, 0.2, 10.0
+    };
+
     inline void Yuv2Rgb(uint8_t yValue, uint8_t uValue, uint8_t vValue, uint8_t *r,
                         uint8_t *g, uint8_t *b) {
         *r = yValue + (1.370705 * (vValue - 128));
@@ -54,7 +69,7 @@ namespace {
 
 namespace tango_augmented_reality {
 
-    Scene::Scene() { }
+    Scene::Scene() : tsdf_keyframes_(kTsdfKeyframes), plane_keyframes_(kPlaneKeyframes) { }
 
     Scene::~Scene() { }
 
@@ -111,6 +126,11 @@ namespace tango_augmented_reality {
         int32_t max_point_cloud_elements;
         TangoSupport_createXYZij(20000, &XYZij);
         chisel_mesh_ = new ChiselMesh();
+        chisel_mesh_->setStreaming(tsdf_directory, tsdf_budget_megabytes * 1024 * 1024);
+        chisel_mesh_->setColorIntegration(tsdf_color);
+        chisel_mesh_->setDecimation(tsdf_decimation);
+        chisel_mesh_->setMultiResolution(tsdf_multi_resolution);
+        chisel_mesh_->setRaycastResolution(tsdf_raycast_width, tsdf_raycast_height);
         plane_mesh_ = new PlaneMesh();
         gesture_camera_->SetCameraType(tango_gl::GestureCamera::CameraType::kThirdPerson);
     }
@@ -196,11 +216,38 @@ namespace tango_augmented_reality {
         }
 
 
-        if ((mode == TSDF || mode == PLANE) &&
-            last_depth_timestamp - last_depth_timestamp_updated > 1.0) {
+        // each depth frame is tested once, only keyframes are integrated
+        bool tsdf_keyframe = false;
+        bool plane_keyframe = false;
+        {
+            std::lock_guard <std::mutex> lock(depth_mutex_);
+            if (last_depth_timestamp > last_depth_timestamp_tested) {
+                last_depth_timestamp_tested = last_depth_timestamp;
+                tsdf_keyframe = mode == TSDF &&
+                                tsdf_keyframes_.isKeyframe(XYZij.timestamp,
+                                                           point_cloud_transformation, vertices);
+                plane_keyframe = (mode == PLANE || plane_completion) &&
+                                 plane_keyframes_.isKeyframe(XYZij.timestamp,
+                                                             point_cloud_transformation, vertices);
+            }
+        }
+        if (tsdf_keyframe || (plane_keyframe && mode == PLANE)) {
             Tap();
         }
 
+        // planes for the depth completion are built in the other modes as well
+        if (plane_keyframe && mode != PLANE) {
+            std::lock_guard <std::mutex> lock(depth_mutex_);
+            plane_keyframes_.addKeyframe(XYZij.timestamp, point_cloud_transformation, vertices);
+            plane_mesh_->addFrame(glm::transpose(point_cloud_transformation), vertices);
+        }
+
+        if (mode == PLANE || plane_completion) {
+            // the plane worker reconstructs visible clusters first
+            plane_mesh_->setCamera(ar_camera_projection_matrix_ *
+                                   glm::inverse(cur_pose_transformation), position);
+        }
+
         if (show_occlusion) {
             // render reconstructions or pointcloud, depending on mode
             switch (mode) {
@@ -211,17 +258,13 @@ namespace tango_augmented_reality {
                                                   point_cloud_transformation, vertices);
                 }
                     break;
-                case TSDF: {
-                    std::lock_guard <std::mutex> lock(chisel_mesh_->render_mutex);
+                case TSDF:
                     chisel_mesh_->Render(gesture_camera_->GetProjectionMatrix(),
                                          gesture_camera_->GetViewMatrix());
-                }
                     break;
-                case PLANE: {
-                    std::lock_guard <std::mutex> lock(plane_mesh_->render_mutex);
+                case PLANE:
                     plane_mesh_->Render(gesture_camera_->GetProjectionMatrix(),
                                         gesture_camera_->GetViewMatrix());
-                }
                     break;
             }
         }
@@ -244,20 +287,27 @@ namespace tango_augmented_reality {
                                               point_cloud_transformation, vertices);
             }
                 break;
-            case TSDF: {
-                std::lock_guard <std::mutex> lock(chisel_mesh_->render_mutex);
-                chisel_mesh_->Render(gesture_camera_->GetProjectionMatrix(),
-                                     gesture_camera_->GetViewMatrix());
-            }
+            case TSDF:
+                if (tsdf_raycast_width > 0) {
+                    RenderRaycastDepth();
+                } else {
+                    chisel_mesh_->Render(gesture_camera_->GetProjectionMatrix(),
+                                         gesture_camera_->GetViewMatrix());
+                }
                 break;
-            case PLANE: {
-                std::lock_guard <std::mutex> lock(depth_mutex_);
+            case PLANE:
                 plane_mesh_->Render(gesture_camera_->GetProjectionMatrix(),
                                     gesture_camera_->GetViewMatrix());
-            }
                 break;
         }
 
+        if (plane_completion && mode != PLANE) {
+            // planes fill the holes of the depth map and flatten the noise on
+            // walls and floors, geometry in front of them stays visible
+            plane_mesh_->RenderDepth(gesture_camera_->GetProjectionMatrix(),
+                                     gesture_camera_->GetViewMatrix(), kPlaneCompletionPull);
+        }
+
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
         if (do_filtering) {
@@ -414,20 +464,26 @@ namespace tango_augmented_reality {
 
     void Scene::Tap() {
         glm::mat4 transformation = glm::transpose(point_cloud_transformation);
-        last_depth_timestamp_updated = XYZij.timestamp;
         if (mode == TSDF) {
             LOGD("Collect Points for Chisel");
             {
+                // the last color frame is sampled by the TSDF worker, not converted here
                 std::lock_guard <std::mutex> lock(depth_mutex_);
-                chisel_mesh_->addPoints(transformation, depth_intrinsics, &XYZij);
-                chisel_mesh_->updateVertices();
+                tsdf_keyframes_.addKeyframe(XYZij.timestamp, point_cloud_transformation, vertices);
+                std::lock_guard <std::mutex> yuv_lock(yuv_buffer_mutex_);
+                if (is_yuv_texture_available_) {
+                    chisel_mesh_->addFrame(transformation, &XYZij, &yuv_buffer_[0],
+                                           yuv_width_, yuv_height_);
+                } else {
+                    chisel_mesh_->addFrame(transformation, &XYZij, nullptr, 0, 0);
+                }
             }
         } else if (mode == PLANE) {
             LOGD("Collect Points for Plane Reconstruction");
             {
                 std::lock_guard <std::mutex> lock(depth_mutex_);
-                plane_mesh_->addPoints(transformation, vertices);
-                plane_mesh_->updateVertices();
+                plane_keyframes_.addKeyframe(XYZij.timestamp, point_cloud_transformation, vertices);
+                plane_mesh_->addFrame(transformation, vertices);
             }
         }
     }
@@ -464,9 +520,18 @@ namespace tango_augmented_reality {
     }
 
     void Scene::ClearReconstruction() {
+        {
+            // the cleared space is new again
+            std::lock_guard <std::mutex> lock(depth_mutex_);
+            tsdf_keyframes_.reset();
+            plane_keyframes_.reset();
+        }
         switch (mode) {
             case TSDF:
                 chisel_mesh_->clear();
+                if (plane_completion) {
+                    plane_mesh_->clear();
+                }
                 break;
             case PLANE:
                 plane_mesh_->clear();
@@ -477,6 +542,117 @@ namespace tango_augmented_reality {
     void Scene::SetDepthIntrinsics(TangoCameraIntrinsics depth_intrinsics_) {
         depth_intrinsics = depth_intrinsics_;
         chisel_mesh_->init(depth_intrinsics);
+        plane_mesh_->setIntrinsics(depth_intrinsics.fx, depth_intrinsics.fy, depth_intrinsics.cx,
+                                   depth_intrinsics.cy, depth_intrinsics.width,
+                                   depth_intrinsics.height);
+    }
+
+    void Scene::SetColorIntrinsics(TangoCameraIntrinsics color_intrinsics) {
+        chisel_mesh_->setColorIntrinsics(color_intrinsics);
+    }
+
+    void Scene::SetPlaneEngine(int engine) {
+        plane_mesh_->setEngine(engine);
+    }
+
+    void Scene::SetIntegrationMode(int integration_mode) {
+        chisel_mesh_->setIntegrationMode(integration_mode);
+    }
+
+    void Scene::BenchmarkReconstruction() {
+        chisel_mesh_->benchmark();
+    }
+
+    void Scene::SweepReconstruction(const std::string &path) {
+        chisel_mesh_->sweep(path);
+    }
+
+    void Scene::SetSessionRecording(const std::string &path) {
+        chisel_mesh_->setSessionRecording(path);
+    }
+
+    void Scene::SaveTsdf(const std::string &path) {
+        chisel_mesh_->save(path);
+    }
+
+    void Scene::LoadTsdf(const std::string &path) {
+        chisel_mesh_->load(path);
+        std::lock_guard <std::mutex> lock(depth_mutex_);
+        tsdf_keyframes_.reset();
+    }
+
+    void Scene::SetKeyframeSettings(int id, const KeyframeSettings &settings) {
+        std::lock_guard <std::mutex> lock(depth_mutex_);
+        switch ((ARMode) id) {
+            case TSDF:
+                tsdf_keyframes_.setSettings(settings);
+                break;
+            case PLANE:
+                plane_keyframes_.setSettings(settings);
+                break;
+            default:
+                break;
+        }
+    }
+
+    void Scene::SetTsdfStreaming(const std::string &directory, int budget_megabytes) {
+        // the chisel mesh is created with the GL content, which might happen later
+        tsdf_directory = directory;
+        tsdf_budget_megabytes = budget_megabytes;
+        if (chisel_mesh_ != nullptr) {
+            chisel_mesh_->setStreaming(tsdf_directory, tsdf_budget_megabytes * 1024 * 1024);
+        }
+    }
+
+    void Scene::SetTsdfDecimation(float max_error) {
+        tsdf_decimation = max_error;
+        if (chisel_mesh_ != nullptr) {
+            chisel_mesh_->setDecimation(tsdf_decimation);
+        }
+    }
+
+    void Scene::SetTsdfMultiResolution(bool enabled) {
+        tsdf_multi_resolution = enabled;
+        if (chisel_mesh_ != nullptr) {
+            chisel_mesh_->setMultiResolution(tsdf_multi_resolution);
+        }
+    }
+
+    void Scene::RenderRaycastDepth() {
+        // the worker casts while the frame is drawn, the depth lags one frame
+        chisel_mesh_->requestDepth(gesture_camera_->GetProjectionMatrix() *
+                                   gesture_camera_->GetViewMatrix());
+        if (chisel_mesh_->updateDepth()) {
+            const RaycastDepth &image = chisel_mesh_->getDepth();
+            cv::Mat depth(image.height, image.width, CV_32FC1,
+                          const_cast<float *>(image.depth.data()));
+            cv::Mat scaled;
+            depth.convertTo(scaled, cv_depth_format_, 65535.0);
+            cv::resize(scaled, raycast_frame, depth_frame.size(), 0, 0, cv::INTER_NEAREST);
+        }
+        if (raycast_frame.empty()) {
+            return;
+        }
+        // both are stored bottom row first, the image goes straight into the texture
+        glBindTexture(GL_TEXTURE_2D, depth_drawable_->GetTextureId());
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, raycast_frame.cols, raycast_frame.rows,
+                        GL_DEPTH_COMPONENT, gl_depth_format_, raycast_frame.ptr());
+    }
+
+    void Scene::SetTsdfRaycast(int width, int height) {
+        tsdf_raycast_width = width;
+        tsdf_raycast_height = height;
+        raycast_frame.release();
+        if (chisel_mesh_ != nullptr) {
+            chisel_mesh_->setRaycastResolution(tsdf_raycast_width, tsdf_raycast_height);
+        }
+    }
+
+    void Scene::SetTsdfColor(bool enabled) {
+        tsdf_color = enabled;
+        if (chisel_mesh_ != nullptr) {
+            chisel_mesh_->setColorIntegration(tsdf_color);
+        }
     }
 
 
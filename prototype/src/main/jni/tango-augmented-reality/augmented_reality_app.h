@@ -160,6 +160,51 @@ namespace tango_augmented_reality {
         // triggers the reconstruction resetting
         void clearReconstruction();
 
+        // selects the plane reconstruction engine
+        void setPlaneEngine(int engine);
+
+        // fills the depth map with the reconstructed planes
+        void setPlaneCompletion(bool enabled);
+
+        // selects the TSDF integration of depth images or point clouds
+        void setIntegrationMode(int integration_mode);
+
+        // benchmarks the TSDF integration modes on the last frames
+        void benchmarkReconstruction();
+
+        // sweeps the TSDF parameters on a recorded depth session or the last frames
+        void sweepReconstruction(const std::string &path);
+
+        // records the integrated depth frames to path, empty stops the recording
+        void setSessionRecording(const std::string &path);
+
+        // saves the TSDF to a map file
+        void saveTsdf(const std::string &path);
+
+        // starts from a saved TSDF map file
+        void loadTsdf(const std::string &path);
+
+        // spills distant TSDF chunks to directory above the memory budget
+        void setTsdfStreaming(const std::string &directory, int budget_megabytes);
+
+        // colors the TSDF with the color camera
+        void setTsdfColor(bool enabled);
+
+        // decimates the TSDF mesh with an error bound in meters, 0 disables it
+        void setTsdfDecimation(float max_error);
+
+        // coarse voxels for distant depth, fine voxels close to the camera
+        void setTsdfMultiResolution(bool enabled);
+
+        // occlusion depth ray cast from the TSDF at width x height, 0 disables it
+        void setTsdfRaycast(int width, int height);
+
+        // integrates a depth frame after moving translation meters, turning
+        // rotation degrees or seeing a novelty fraction of new space, at most
+        // every min_interval and at least every max_interval seconds (0 never)
+        void setKeyframeSettings(int mode, float translation, float rotation, float novelty,
+                                 double min_interval, double max_interval);
+
         // set the current filter object to scene
         void setFilterSettings(int diameter, double sigma);
 
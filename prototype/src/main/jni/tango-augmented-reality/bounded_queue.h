@@ -0,0 +1,72 @@
+
+#ifndef TANGO_AUGMENTED_REALITY_BOUNDED_QUEUE_H_
+#define TANGO_AUGMENTED_REALITY_BOUNDED_QUEUE_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace tango_augmented_reality {
+
+    // Thread safe FIFO with a fixed capacity. When a producer pushes into a full
+    // queue the oldest item is dropped, so a slow consumer always works on
+    // recent data and never blocks the producer.
+    template<class T>
+    class BoundedQueue {
+    public:
+        explicit BoundedQueue(size_t capacity) : capacity_(capacity) { }
+
+        // appends an item and returns true if an old item had to be dropped
+        bool push(T item) {
+            bool dropped = false;
+            {
+                std::lock_guard <std::mutex> lock(mutex_);
+                if (items_.size() >= capacity_) {
+                    items_.pop_front();
+                    dropped = true;
+                }
+                items_.push_back(std::move(item));
+            }
+            condition_.notify_one();
+            return dropped;
+        }
+
+        // takes the oldest item, waits up to timeout_ms for one to arrive
+        bool pop(T &item, int timeout_ms) {
+            std::unique_lock <std::mutex> lock(mutex_);
+            if (items_.empty() && timeout_ms > 0) {
+                condition_.wait_for(lock, std::chrono::milliseconds(timeout_ms));
+            }
+            if (items_.empty()) {
+                return false;
+            }
+            item = std::move(items_.front());
+            items_.pop_front();
+            return true;
+        }
+
+        // wakes up a waiting consumer without adding an item
+        void notify() { condition_.notify_all(); }
+
+        void clear() {
+            std::lock_guard <std::mutex> lock(mutex_);
+            items_.clear();
+        }
+
+        size_t size() {
+            std::lock_guard <std::mutex> lock(mutex_);
+            return items_.size();
+        }
+
+    private:
+        size_t capacity_;
+        std::deque <T> items_;
+        std::mutex mutex_;
+        std::condition_variable condition_;
+    };
+
+}  // namespace tango_augmented_reality
+
+#endif  // TANGO_AUGMENTED_REALITY_BOUNDED_QUEUE_H_
@@ -0,0 +1,121 @@
+#ifndef TANGO_AUGMENTED_REALITY_CHISEL_BENCHMARK_H_
+#define TANGO_AUGMENTED_REALITY_CHISEL_BENCHMARK_H_
+
+#include <string>
+#include <vector>
+
+#include <open_chisel/ProjectionIntegrator.h>
+#include <open_chisel/camera/DepthImage.h>
+#include <open_chisel/camera/PinholeCamera.h>
+#include <open_chisel/pointcloud/PointCloud.h>
+
+#include "tango-augmented-reality/depth_rasterizer.h"
+#include "tango-augmented-reality/depth_session.h"
+#include "tango-augmented-reality/parallel_chisel.h"
+#include "tango-augmented-reality/worker_pool.h"
+
+namespace tango_augmented_reality {
+
+    struct ChiselBenchmarkResult {
+        IntegrationMode mode;
+        // every stride-th point of a frame was used
+        int stride;
+        int frames;
+        int points;
+        double integration_ms;
+        double meshing_ms;
+        // chunks marked for remeshing, summed over all frames
+        int touched_chunks;
+        int triangles;
+        // surface area of the final mesh in square meters
+        float area;
+    };
+
+    // TSDF parameters of a sweep
+    struct ChiselParameters {
+        int chunk_size;
+        // voxel size in meters
+        float resolution;
+        // scale of the quadratic truncation, see ParallelChisel::createIntegrator
+        float truncation_scale;
+        float weighting;
+        // distance the rays carve in front of the surface, 0 disables carving
+        float carving_distance;
+    };
+
+    struct ChiselSweepResult {
+        ChiselParameters parameters;
+        int frames;
+        double integration_ms;
+        double meshing_ms;
+        // voxels and meshes of the TSDF at its largest, computed from the
+        // element counts of chisel, not measured
+        size_t estimated_peak_bytes;
+        int chunks;
+        int triangles;
+    };
+
+    // ChiselBenchmark replays recorded depth frames into fresh TSDFs, once per
+    // integration mode and point density, or once per set of parameters of a
+    // sweep. Frames are integrated like ChiselMesh does: the depth between the
+    // near and far plane of the camera, either rasterized into a depth image
+    // or as a point cloud. Nothing depends on Tango or OpenGL, chisel_sweep
+    // runs the sweep on the host.
+    class ChiselBenchmark {
+    public:
+        // replays run into TSDFs with the chunk and voxel size of map,
+        // integrated with integrator. rasterizer has the intrinsics of camera.
+        ChiselBenchmark(WorkerPool &pool, const ParallelChisel &map,
+                        const chisel::ProjectionIntegrator &integrator,
+                        const chisel::PinholeCamera &camera, const DepthRasterizer &rasterizer,
+                        float ray_truncation);
+
+        void run(const std::vector <DepthSessionFrame> &frames,
+                 std::vector <ChiselBenchmarkResult> &results);
+
+        // replays the frames once per parameter set with the given mode
+        void sweep(const std::vector <DepthSessionFrame> &frames,
+                   const std::vector <ChiselParameters> &grid, IntegrationMode mode,
+                   std::vector <ChiselSweepResult> &results);
+
+        // chunk sizes and voxel sizes of both modules, with and without
+        // carving. A constant weight cancels out in the running average of the
+        // voxels, so weighting is not swept.
+        static std::vector <ChiselParameters> grid(float weighting);
+
+        // single line summaries for the log
+        static std::string describe(const ChiselBenchmarkResult &result);
+
+        static std::string describe(const ChiselSweepResult &result);
+
+        // writes the results as comma separated values
+        static bool write(const std::string &path,
+                          const std::vector <ChiselSweepResult> &results);
+
+    private:
+        ChiselBenchmarkResult replay(const std::vector <DepthSessionFrame> &frames,
+                                     IntegrationMode mode, int stride);
+
+        ChiselSweepResult replay(const std::vector <DepthSessionFrame> &frames,
+                                 const ChiselParameters &parameters, IntegrationMode mode);
+
+        // integrates every stride-th point of a frame, returns the point count
+        int integrate(ParallelChisel &map, const DepthSessionFrame &frame, IntegrationMode mode,
+                      const chisel::ProjectionIntegrator &integrator, int stride);
+
+        WorkerPool &pool_;
+        Eigen::Vector3i chunk_size_;
+        float resolution_;
+        chisel::ProjectionIntegrator integrator_;
+        chisel::PinholeCamera camera_;
+        DepthRasterizer rasterizer_;
+        float ray_truncation_;
+
+        std::vector <float> points_;
+        chisel::PointCloud cloud_;
+        boost::shared_ptr <chisel::DepthImage<float>> depth_;
+    };
+
+}  // namespace tango_augmented_reality
+
+#endif  // TANGO_AUGMENTED_REALITY_CHISEL_BENCHMARK_H_
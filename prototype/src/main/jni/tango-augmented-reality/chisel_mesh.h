@@ -8,7 +8,10 @@
 
 #include <Eigen/Core>
 
+#include <atomic>
+#include <deque>
 #include <mutex>
+#include <thread>
 
 #include <open_chisel/Chisel.h>
 #include <open_chisel/camera/DepthImage.h>
@@ -21,41 +24,216 @@
 #include <open_chisel/truncation/QuadraticTruncator.h>
 #include <open_chisel/weighting/ConstantWeighter.h>
 #include <open_chisel/mesh/Mesh.h>
+#include <open_chisel/pointcloud/PointCloud.h>
 
 #include <tango_support_api.h>
 
+#include "tango-augmented-reality/bounded_queue.h"
+#include "tango-augmented-reality/chisel_benchmark.h"
+#include "tango-augmented-reality/chunk_streamer.h"
+#include "tango-augmented-reality/color_integrator.h"
+#include "tango-augmented-reality/depth_session.h"
+#include "tango-augmented-reality/depth_rasterizer.h"
+#include "tango-augmented-reality/mesh_buffer_manager.h"
+#include "tango-augmented-reality/mesh_decimator.h"
+#include "tango-augmented-reality/mesh_welder.h"
+#include "tango-augmented-reality/parallel_chisel.h"
+#include "tango-augmented-reality/triple_buffer.h"
+#include "tango-augmented-reality/tsdf_raycaster.h"
+#include "tango-augmented-reality/worker_pool.h"
+
 
 
 typedef boost::shared_ptr<chisel::DepthImage<float>> DepthImagePtr;
 
 namespace tango_augmented_reality {
 
+    // depth frame in depth camera coordinates with its world transformation
+    struct ChiselFrame {
+        glm::mat4 transformation;
+        std::vector <float> points;
+        double timestamp;
+        // NV21 color image of the frame, empty without color integration
+        std::vector <uint8_t> color;
+        int color_width;
+        int color_height;
+    };
+
+    // window depth ray cast from the TSDF, rows start at the bottom
+    struct RaycastDepth {
+        std::vector <float> depth;
+        int width = 0;
+        int height = 0;
+    };
 
+    // ChiselMesh integrates depth frames into a TSDF on a worker thread. Frames
+    // are queued by addFrame, the extracted meshes are published through a
+    // triple buffer which Render picks up without waiting for the worker.
+    // With multi resolution enabled, distant depth goes into a second TSDF with
+    // twice the voxel size.
     class ChiselMesh : public tango_gl::DrawableObject {
     public:
         ChiselMesh();
 
         ChiselMesh(GLenum render_mode);
 
+        ~ChiselMesh();
+
         void SetShader();
 
         void init(TangoCameraIntrinsics intrinsics);
 
-        void Render(const glm::mat4 &projection_mat, const glm::mat4 &view_mat) const;
+        void setColorIntrinsics(TangoCameraIntrinsics intrinsics);
 
-        void addPoints(glm::mat4 transformation, TangoCameraIntrinsics intrinsics, TangoXYZij *XYZij);
+        void Render(const glm::mat4 &projection_mat, const glm::mat4 &view_mat) const;
 
-        void updateVertices();
-        
-        std::mutex render_mutex;
+        // copies a depth frame into the queue of the worker, drops the oldest
+        // frame if the worker falls behind. The NV21 color image is only copied
+        // with color integration enabled and may be null.
+        void addFrame(glm::mat4 transformation, const TangoXYZij *XYZij, const uint8_t *nv21,
+                      int color_width, int color_height);
 
         void clear();
 
+        // switches between the IntegrationMode values for the following frames
+        void setIntegrationMode(int mode) { integration_mode_ = mode; }
+
+        IntegrationMode getIntegrationMode() {
+            return static_cast<IntegrationMode>(integration_mode_.load());
+        }
+
+        // replays the last frames of the depth session recording with a
+        // ChiselBenchmark on the worker and logs the results, integration
+        // pauses meanwhile
+        void benchmark();
+
+        // replays the session recorded at path, or the last recorded frames
+        // for an empty path, for a grid of TSDF parameters on the worker.
+        // Results are logged and written to path + ".csv".
+        void sweep(const std::string &path);
+
+        // records the integrated frames into a DepthSession at path, an empty
+        // path stops the recording
+        void setSessionRecording(const std::string &path);
+
+        // moves chunks far away from the camera into directory once the voxels
+        // exceed budget bytes, an empty directory packs them in memory. A
+        // quarter of the budget goes to the coarse level.
+        void setStreaming(const std::string &directory, size_t budget);
+
+        // integrates the colors of the following frames and draws the mesh with
+        // vertex colors, switching resets the reconstruction
+        void setColorIntegration(bool enabled);
+
+        // decimates remeshed chunks with the given error bound in meters, 0
+        // keeps the marching cubes output. Applies to chunks meshed afterwards.
+        void setDecimation(float max_error);
+
+        // integrates far depth into a coarse TSDF level and near depth into the
+        // fine one, switching resets the reconstruction
+        void setMultiResolution(bool enabled);
+
+        // ray casts the TSDF at width x height pixels for the depth requested
+        // with requestDepth, 0 stops ray casting
+        void setRaycastResolution(int width, int height);
+
+        // queues a ray cast of the TSDF from the camera view_projection, the
+        // worker publishes the depth image for updateDepth
+        void requestDepth(const glm::mat4 &view_projection);
+
+        // takes over the newest ray cast depth, returns false if there is none
+        bool updateDepth() { return depths_.update(); }
+
+        const RaycastDepth &getDepth() const { return depths_.front(); }
+
+        // writes the TSDF into a map file at path, runs on the worker. The
+        // coarse level of the multi resolution TSDF goes to path + ".coarse".
+        void save(const std::string &path);
+
+        // replaces the TSDF by the map file at path, its chunks are loaded
+        // lazily around the camera. The coarse level is opened from
+        // path + ".coarse" with multi resolution enabled.
+        void load(const std::string &path);
+
+        // creates an empty TSDF with the parameters of this mesh, scale
+        // multiplies the voxel size
+        ParallelChiselPtr createMap(bool colors = false, double scale = 1.0) const;
+
+        // integrates a frame into the given fine level TSDF, only called on the worker
+        void integrate(ParallelChisel &map, const ChiselFrame &frame, IntegrationMode mode);
+
     protected:
+        // worker loop, integrates queued frames and publishes the meshes
+        void run();
+
+        // empties both TSDF levels and the published mesh, only called on the worker
+        void reset();
+
+        std::string getMapPath();
+
+        // integrates a single depth frame into the TSDF
+        void addPoints(const ChiselFrame &frame);
+
+        // integrates the depth of a frame between the near and far plane of
+        // camera, integrator has to match the voxel size of map
+        void integrate(ParallelChisel &map, const ChiselFrame &frame, IntegrationMode mode,
+                       chisel::ProjectionIntegrator &integrator,
+                       const chisel::PinholeCamera &camera);
+
+        // opens or closes the session after setSessionRecording
+        void updateSession();
+
+        // appends the depth of a frame to the open session and keeps it for
+        // the benchmark, takes the points of frame
+        void recordFrame(ChiselFrame &frame);
+
+        // runs the parameter sweep requested with sweep
+        void sweepParameters();
+
+        // benchmark with the fine level TSDF, integrator and camera
+        ChiselBenchmark createBenchmark();
+
+        // colors the chunks of map touched by the frame
+        void integrateColor(ParallelChisel &map, const ChiselFrame &frame);
+
+        // ray casts the requested depth image on the pool and publishes it
+        void raycastDepth();
+
+        // remeshes the marked chunks closest to the camera within the meshing
+        // budget and publishes the slices to the render thread
+        void updateVertices();
+
+        // evicts and loads the chunks of a level around the camera, chunks up to
+        // reach are kept, loaded chunks without a slice are remeshed
+        void stream(ChunkStreamer &streamer, ParallelChisel &map, MeshSliceMap &slices,
+                    const chisel::Vec3 &camera, float reach);
+
+        // rebuilds the slices of the chunks remeshed within the budget,
+        // returns false if no chunk was remeshed
+        bool remesh(ParallelChisel &map, MeshSliceMap &slices);
+
+        // welds and decimates the new mesh of a chunk into its slice, drops
+        // the slice of a chunk without surface. Returns the index count.
+        size_t updateSlice(ParallelChisel &map, MeshSliceMap &slices, const chisel::ChunkID &id);
+
+        // sets the fine chunks the vertices of a coarse slice lie in
+        void updateFineCells(const chisel::ChunkID &coarse, MeshSlice &slice) const;
+
+        // whether the fine level has a surface wherever the slice of the coarse
+        // chunk has one
+        bool isCoveredByFineLevel(const chisel::ChunkID &coarse, const MeshSlice &slice) const;
+
         tango_gl::BoundingBox *bounding_box_;
 
         GLuint uniform_mv_mat_;
 
+        // program with per vertex colors
+        GLuint color_program_;
+        GLuint uniform_color_mvp_;
+        GLuint uniform_color_alpha_;
+        GLuint attrib_color_vertices_;
+        GLuint attrib_colors_;
+
         double truncationDistScale;
         double chunkSize;
         double chunkResolution;
@@ -65,12 +243,91 @@ namespace tango_augmented_reality {
         double farClipping;
         double rayTruncation;
 
-        chisel::ChiselPtr chiselMap;
+        ParallelChiselPtr chiselMap;
         DepthImagePtr lastDepthImage = DepthImagePtr(new chisel::DepthImage<float>());
         chisel::ProjectionIntegrator projectionIntegrator;
 
         chisel::Intrinsics chiselIntrinsics;
         chisel::PinholeCamera pinHoleCamera;
+        chisel::PointCloud lastPointCloud;
+
+        // coarse level for distant depth, null without multi resolution
+        ParallelChiselPtr coarseMap;
+        chisel::ProjectionIntegrator coarseIntegrator;
+        chisel::PinholeCamera coarseCamera;
+
+        // projects the frames into lastDepthImage with the depth intrinsics
+        DepthRasterizer rasterizer_;
+        ColorIntegrator color_integrator_;
+        MeshDecimator decimator_;
+        // indexes the chunk meshes, only used by the worker
+        MeshWelder welder_;
+        std::mutex camera_mutex_;
+
+        BoundedQueue <ChiselFrame> frames_;
+
+        // spill distant chunks of each level to storage, used by the worker
+        ChunkStreamer streamer_;
+        ChunkStreamer coarse_streamer_;
+
+        // last frames of the session recording without color for the
+        // benchmark, frames are only kept while recording. Owned by the worker.
+        std::deque <DepthSessionFrame> recorded_;
+
+        // one slice per meshed chunk of each level, owned by the worker
+        MeshSliceMap slices_;
+        MeshSliceMap coarse_slices_;
+
+        // camera of the last frame, the closest chunks are meshed first
+        chisel::Vec3 meshing_camera_ = chisel::Vec3(0.0f, 0.0f, 0.0f);
+        chisel::Vec3 meshing_forward_ = chisel::Vec3(0.0f, 0.0f, 1.0f);
+        // chunks are left for the next call, the worker does not wait for frames
+        bool meshes_pending_ = false;
+
+        // splits the integration and ray casts of the worker over the cores
+        WorkerPool pool_;
+        TsdfRaycaster raycaster_;
+
+        // camera and resolution of the next ray cast, set by the GL thread
+        std::mutex raycast_mutex_;
+        glm::mat4 raycast_view_projection_;
+        int raycast_width_;
+        int raycast_height_;
+
+        // map file of the next save or load request
+        std::mutex map_path_mutex_;
+        std::string map_path_;
+
+        // recording and sweep requests, the session is written by the worker
+        std::mutex session_mutex_;
+        std::string session_path_;
+        std::string sweep_path_;
+        DepthSession session_;
+
+        // depth images ray cast by the worker
+        TripleBuffer <RaycastDepth> depths_;
+
+        // slices published by the worker, one per chunk, swapped in by Render
+        mutable TripleBuffer <MeshSliceMap> meshes_;
+
+        // GPU copy of the published slices, owned by the GL thread
+        mutable MeshBufferManager buffers_;
+
+        std::atomic <bool> initialized_;
+        std::atomic <bool> running_;
+        std::atomic <bool> clear_requested_;
+        std::atomic <bool> benchmark_requested_;
+        std::atomic <bool> raycast_requested_;
+        std::atomic <bool> save_requested_;
+        std::atomic <bool> load_requested_;
+        std::atomic <bool> session_changed_;
+        std::atomic <bool> sweep_requested_;
+        std::atomic <int> integration_mode_;
+        std::atomic <bool> color_enabled_;
+        std::atomic <bool> multi_resolution_;
+        // whether chiselMap has color voxels, owned by the worker
+        bool map_colors_;
+        std::thread worker_;
 
     };
 }  // namespace tango_augmented_reality
@@ -0,0 +1,122 @@
+
+#ifndef TANGO_AUGMENTED_REALITY_CHUNK_STREAMER_H_
+#define TANGO_AUGMENTED_REALITY_CHUNK_STREAMER_H_
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <open_chisel/ChunkManager.h>
+
+#include "tango-augmented-reality/tsdf_map_file.h"
+
+namespace tango_augmented_reality {
+
+    // ChunkStreamer bounds the memory of a TSDF by moving chunks far away from
+    // the camera out of the float voxel grid. Evicted chunks are packed, see
+    // PackedChunk, and written to a TsdfMapFile in the directory, which
+    // reuses the records of loaded chunks, or kept in memory without a
+    // directory, which still takes less than half of the float voxels. Chunks are loaded again as soon as the camera comes back
+    // into the radius. The render slices of evicted chunks are not touched, so
+    // the map stays visible.
+    // A saved map is opened the same way, all of its chunks start evicted and
+    // are loaded lazily around the camera.
+    class ChunkStreamer {
+    public:
+        ChunkStreamer();
+
+        ~ChunkStreamer();
+
+        // directory for the evicted chunks, an empty path keeps them packed in
+        // memory
+        void setDirectory(const std::string &directory);
+
+        // bytes of float voxels kept in the TSDF, 0 keeps everything inside the
+        // radius. Without a directory, 0 disables streaming.
+        void setBudget(size_t bytes);
+
+        // chunks further away from the camera are always evicted
+        void setRadius(float radius);
+
+        // weight of one step of the packed voxel weights, should match the
+        // weight of a single observation
+        void setWeightStep(float weight_step);
+
+        // evicts and loads chunks for the current camera position. Chunks within
+        // keep_radius are never evicted and always loaded, because the next
+        // integration might touch them. The ids of loaded chunks are appended
+        // to loaded, the ids of chunks which integration had created again
+        // and which got the evicted voxels merged in to merged, if given.
+        // Must run on the thread owning the TSDF.
+        void update(chisel::ChunkManager &chunks, const chisel::Vec3 &camera, float keep_radius,
+                    std::vector <chisel::ChunkID> *loaded = nullptr,
+                    std::vector <chisel::ChunkID> *merged = nullptr);
+
+        // writes the chunks in memory and the evicted ones into a map at path,
+        // must run on the thread owning the TSDF
+        bool save(const chisel::ChunkManager &chunks, const std::string &path);
+
+        // drops all evicted chunks and evicts every chunk of the map at path,
+        // must run on the thread owning the TSDF
+        bool open(const chisel::ChunkManager &chunks, const std::string &path);
+
+        // deletes all evicted chunks, must run on the thread owning the TSDF
+        void clear();
+
+        size_t getEvictedCount() const { return evicted_.size(); }
+
+    private:
+        struct Candidate {
+            float distance;
+            chisel::ChunkID id;
+        };
+
+        // where an evicted chunk is kept
+        enum Store {
+            PACKED,
+            SPILLED,
+            // the opened map, which is never written
+            SITE
+        };
+
+        // packs a chunk and removes it from the TSDF
+        bool evict(chisel::ChunkManager &chunks, const chisel::ChunkID &id, float weight_step);
+
+        // unpacks an evicted chunk back into the TSDF, or merges it into the
+        // chunk which took its place
+        bool load(chisel::ChunkManager &chunks, const chisel::ChunkID &id);
+
+        // copies an evicted chunk out of its store, take drops it there
+        bool read(const chisel::ChunkID &id, Store store, PackedChunk &chunk, bool take);
+
+        // distance of the chunk center to the camera
+        float getDistance(const chisel::ChunkManager &chunks, const chisel::ChunkID &id,
+                          const chisel::Vec3 &camera) const;
+
+        // guards the settings, which are changed from the UI thread
+        std::mutex settings_mutex_;
+        std::string directory_;
+        size_t budget_;
+        float radius_;
+        float weight_step_;
+
+        // directory of the spill map, only used by the owning thread
+        std::string active_directory_;
+
+        // chunks which live in their packed form only
+        std::unordered_map <chisel::ChunkID, Store, chisel::ChunkHasher> evicted_;
+
+        // packed chunks without a directory
+        std::unordered_map <chisel::ChunkID, PackedChunk, chisel::ChunkHasher> packed_;
+
+        // evicted chunks in the directory, created with the first one
+        TsdfMapFile spill_;
+
+        // map opened by open
+        TsdfMapFile site_;
+    };
+
+}  // namespace tango_augmented_reality
+
+#endif  // TANGO_AUGMENTED_REALITY_CHUNK_STREAMER_H_
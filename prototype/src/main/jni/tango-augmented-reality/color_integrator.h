@@ -0,0 +1,43 @@
+
+#ifndef TANGO_AUGMENTED_REALITY_COLOR_INTEGRATOR_H_
+#define TANGO_AUGMENTED_REALITY_COLOR_INTEGRATOR_H_
+
+#include <stdint.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <open_chisel/ChunkManager.h>
+
+namespace tango_augmented_reality {
+
+    // ColorIntegrator blends the color camera into the color voxels of a TSDF.
+    // Only voxels close to the surface of the given chunks are projected into
+    // the image and sampled straight from the NV21 buffer, so the frame is never
+    // converted to RGB as a whole. The color and the depth camera share the
+    // same frame on Tango devices.
+    class ColorIntegrator {
+    public:
+        ColorIntegrator();
+
+        void setIntrinsics(float fx, float fy, float cx, float cy, int width, int height);
+
+        // transformation maps camera points into the world (point * transformation),
+        // nv21 holds width * height luma bytes followed by the interleaved chroma
+        void integrate(chisel::ChunkManager &chunks, const std::vector <chisel::ChunkID> &ids,
+                       const glm::mat4 &transformation, const uint8_t *nv21, int width,
+                       int height);
+
+    private:
+        // converts the pixel at x, y to rgb
+        static void sample(const uint8_t *nv21, int width, int height, int x, int y,
+                           uint8_t *r, uint8_t *g, uint8_t *b);
+
+        float fx_, fy_, cx_, cy_;
+        int width_;
+        int height_;
+    };
+
+}  // namespace tango_augmented_reality
+
+#endif  // TANGO_AUGMENTED_REALITY_COLOR_INTEGRATOR_H_
@@ -2,8 +2,8 @@
 #define TANGO_AUGMENTED_REALITY_HULL_H_
 
 #include <algorithm>
+#include <stdint.h>
 #include <vector>
-#include <tango-gl/util.h>
 #include <glm/glm.hpp>
 #include <glm/ext.hpp>
 
@@ -13,11 +13,27 @@ namespace tango_augmented_reality {
     public:
 
         // applies the convex hull algorithm to determine the convex hull
-        std::vector <glm::vec2> generateConvexHull(std::vector <glm::vec2> &points);
+        std::vector <glm::vec2> generateConvexHull(const std::vector <glm::vec2> &points);
 
         // tests if a point is Left|On|Right of an infinite line.
         double isLeft(glm::vec2 P0, glm::vec2 P1, glm::vec2 P2);
 
+    private:
+        // Akl-Toussaint heuristic, keeps only points outside of the octagon
+        // spanned by the extreme points in 8 directions
+        void discardInteriorPoints(const std::vector <glm::vec2> &points,
+                                   std::vector <glm::vec2> &candidates);
+
+        // sorts points lexicographically with a radix sort on quantized coordinates
+        void sortPoints(std::vector <glm::vec2> &points);
+
+        // buffers reused between calls
+        std::vector <uint8_t> outside_;
+        std::vector <uint32_t> keys_;
+        std::vector <uint32_t> key_buffer_;
+        std::vector <uint32_t> order_;
+        std::vector <uint32_t> order_buffer_;
+        std::vector <glm::vec2> sorted_;
     };
 }
-#endif
\ No newline at end of file
+#endif
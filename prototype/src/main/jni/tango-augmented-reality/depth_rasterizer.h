@@ -0,0 +1,53 @@
+
+#ifndef TANGO_AUGMENTED_REALITY_DEPTH_RASTERIZER_H_
+#define TANGO_AUGMENTED_REALITY_DEPTH_RASTERIZER_H_
+
+#include <vector>
+
+namespace tango_augmented_reality {
+
+    // DepthRasterizer turns a sparse point cloud in depth camera coordinates
+    // into a dense depth image. Every point is splatted into a small square of
+    // pixels where the closest point wins, an optional dilation pass fills the
+    // remaining single pixel holes. Pixels without depth are set to zero. The
+    // projection runs four points at a time with NEON when it is available,
+    // nothing depends on Tango or OpenGL.
+    class DepthRasterizer {
+    public:
+        DepthRasterizer();
+
+        void setIntrinsics(float fx, float fy, float cx, float cy, int width, int height);
+
+        // fills holes with the closest valid neighbour after splatting
+        void setDilation(bool dilation) { dilation_ = dilation; }
+
+        // projects with NEON where available, the scalar path is kept to
+        // compare against
+        void setVectorized(bool vectorized) { vectorized_ = vectorized; }
+
+        int getWidth() const { return width_; }
+
+        int getHeight() const { return height_; }
+
+        // rasterizes count xyz triples into depth, which holds width * height floats
+        void rasterize(const float *xyz, int count, float *depth);
+
+    private:
+        // computes the pixel index of every point, -1 for points outside the image
+        void project(const float *xyz, int count);
+
+        void dilate(float *depth);
+
+        float fx_, fy_, cx_, cy_;
+        int width_;
+        int height_;
+        bool dilation_;
+        bool vectorized_;
+
+        std::vector <int> pixels_;
+        std::vector <float> holes_;
+    };
+
+}  // namespace tango_augmented_reality
+
+#endif  // TANGO_AUGMENTED_REALITY_DEPTH_RASTERIZER_H_
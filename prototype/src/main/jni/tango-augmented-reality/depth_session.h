@@ -0,0 +1,45 @@
+
+#ifndef TANGO_AUGMENTED_REALITY_DEPTH_SESSION_H_
+#define TANGO_AUGMENTED_REALITY_DEPTH_SESSION_H_
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace tango_augmented_reality {
+
+    // depth frame of a session, transformation holds the 16 floats of the
+    // glm::mat4 of a ChiselFrame in memory order
+    struct DepthSessionFrame {
+        double timestamp;
+        float transformation[16];
+        std::vector <float> points;
+    };
+
+    // DepthSession records the integrated depth frames of a session into a
+    // file, so they can be replayed with other TSDF parameters later on.
+    // Frames are appended as they come, a session cut off by the app is read
+    // up to its last complete frame.
+    // Only depends on the standard library, chisel_sweep replays sessions on
+    // the host.
+    class DepthSession {
+    public:
+        // starts a new session, truncates path
+        bool create(const std::string &path);
+
+        bool append(const DepthSessionFrame &frame);
+
+        void close();
+
+        bool isOpen() const { return file_.is_open(); }
+
+        // reads all complete frames of a session
+        static bool load(const std::string &path, std::vector <DepthSessionFrame> &frames);
+
+    private:
+        std::ofstream file_;
+    };
+
+}  // namespace tango_augmented_reality
+
+#endif  // TANGO_AUGMENTED_REALITY_DEPTH_SESSION_H_
@@ -0,0 +1,70 @@
+
+#ifndef TANGO_AUGMENTED_REALITY_KEYFRAME_SCHEDULER_H_
+#define TANGO_AUGMENTED_REALITY_KEYFRAME_SCHEDULER_H_
+
+#include <stdint.h>
+#include <unordered_set>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace tango_augmented_reality {
+
+    struct KeyframeSettings {
+        // movement since the last keyframe which triggers a new one, meters
+        float translation;
+        // rotation since the last keyframe which triggers a new one, radians
+        float rotation;
+        // fraction of depth points in space no keyframe has seen before
+        float novelty;
+        // seconds between keyframes at the highest rate
+        double min_interval;
+        // seconds after which a keyframe is taken without movement, 0 never
+        double max_interval;
+    };
+
+    // KeyframeScheduler decides which depth frames are integrated into a
+    // reconstruction. A frame becomes a keyframe when the device moved or
+    // turned far enough or when enough of its points fall into space no
+    // keyframe covered yet, never faster than the minimum interval. A static
+    // device only integrates once per maximum interval.
+    // Not synchronized, the scene calls it under its depth lock.
+    class KeyframeScheduler {
+    public:
+        explicit KeyframeScheduler(const KeyframeSettings &settings);
+
+        void setSettings(const KeyframeSettings &settings) { settings_ = settings; }
+
+        const KeyframeSettings &getSettings() const { return settings_; }
+
+        // tests a depth frame, transformation maps the camera points (xyz
+        // triples) into the world
+        bool isKeyframe(double timestamp, const glm::mat4 &transformation,
+                        const std::vector <float> &points) const;
+
+        // records a frame which was integrated
+        void addKeyframe(double timestamp, const glm::mat4 &transformation,
+                         const std::vector <float> &points);
+
+        // forgets all keyframes, the next frame is integrated
+        void reset();
+
+    private:
+        // cell of the coarse grid remembering the covered space
+        static int64_t cell(const glm::vec4 &point);
+
+        // fraction of the sampled points in cells which are not covered yet
+        float novelty(const glm::mat4 &transformation, const std::vector <float> &points) const;
+
+        KeyframeSettings settings_;
+
+        bool has_keyframe_;
+        double last_timestamp_;
+        glm::mat4 last_transformation_;
+
+        std::unordered_set <int64_t> covered_;
+    };
+
+}  // namespace tango_augmented_reality
+
+#endif  // TANGO_AUGMENTED_REALITY_KEYFRAME_SCHEDULER_H_
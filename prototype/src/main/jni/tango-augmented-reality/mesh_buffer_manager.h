@@ -0,0 +1,126 @@
+
+#ifndef TANGO_AUGMENTED_REALITY_MESH_BUFFER_MANAGER_H_
+#define TANGO_AUGMENTED_REALITY_MESH_BUFFER_MANAGER_H_
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <tango-gl/util.h>
+
+#include "tango-augmented-reality/range_allocator.h"
+#include "tango-augmented-reality/view_frustum.h"
+
+namespace tango_augmented_reality {
+
+    // independent part of a mesh, e.g. a plane cluster or a chisel chunk.
+    // Indices refer to the vertices of the same slice.
+    struct MeshSlice {
+        std::vector <GLfloat> vertices;
+        std::vector <GLuint> indices;
+        // optional rgb colors in [0, 1], three floats per vertex
+        std::vector <GLfloat> colors;
+        // bounding box of the vertices, set by updateBounds
+        glm::vec3 min;
+        glm::vec3 max;
+        // slices of a coarse TSDF chunk set bit 4 * x + 2 * y + z for each of
+        // the 2 x 2 x 2 fine chunks their vertices lie in
+        uint8_t fine_cells;
+
+        MeshSlice() : fine_cells(0) { }
+
+        // has to be called after the vertices are written
+        void updateBounds();
+    };
+
+    // slices are never modified after publishing, a changed part of the mesh
+    // gets a new slice object
+    typedef std::shared_ptr <const MeshSlice> MeshSlicePtr;
+    typedef std::map <uint64_t, MeshSlicePtr> MeshSliceMap;
+
+    // MeshBufferManager keeps a mesh made of slices in one persistent vertex
+    // and index buffer. Changed slices are written into CPU side copies of the
+    // buffers and only the dirty ranges are uploaded with glBufferSubData.
+    // A manager created with colors keeps a third buffer with the vertex colors.
+    // All methods have to be called on the GL thread.
+    class MeshBufferManager {
+    public:
+        explicit MeshBufferManager(bool colors = false);
+
+        ~MeshBufferManager();
+
+        // brings the buffers in sync with the given slices, slices are compared
+        // by pointer, so unchanged slices are neither copied nor uploaded
+        void update(const MeshSliceMap &slices);
+
+        // draws the slices whose bounding box intersects the frustum with the
+        // vertex positions bound to attrib_vertices, the default draws all
+        void draw(GLenum render_mode, GLuint attrib_vertices,
+                  const ViewFrustum &frustum = ViewFrustum());
+
+        // draws like above and binds the vertex colors to attrib_colors, slices
+        // without colors are black. Needs a manager created with colors.
+        void draw(GLenum render_mode, GLuint attrib_vertices, GLuint attrib_colors,
+                  const ViewFrustum &frustum);
+
+        // removes all slices and frees the GL buffers
+        void clear();
+
+        // count of indices currently stored
+        size_t getIndexCount() const { return index_ranges_.getUsed(); }
+
+    private:
+        struct Allocation {
+            MeshSlicePtr slice;
+            size_t vertex_offset;
+            size_t index_offset;
+        };
+
+        // copies a slice into the CPU buffers and marks its ranges dirty
+        void insert(uint64_t key, const MeshSlicePtr &slice);
+
+        // frees the ranges of a slice
+        void remove(std::map <uint64_t, Allocation>::iterator it);
+
+        // uploads dirty ranges, recreates GL buffers whose capacity changed
+        void flush();
+
+        // uploads the dirty ranges of one buffer
+        void upload(GLenum target, GLuint &buffer, size_t &gl_capacity, const void *data,
+                    size_t element_size, size_t capacity);
+
+        // issues the draw calls of all slices inside the frustum, one per run
+        // of adjacent index ranges
+        void drawSlices(GLenum render_mode, const ViewFrustum &frustum);
+
+        // vertex data, three floats per vertex
+        std::vector <GLfloat> vertex_data_;
+        // colors of the vertices, three floats per vertex
+        std::vector <GLfloat> color_data_;
+        // indices rebased onto the vertex buffer
+        std::vector <GLuint> index_data_;
+
+        RangeAllocator vertex_ranges_;
+        RangeAllocator index_ranges_;
+
+        std::map <uint64_t, Allocation> allocations_;
+
+        GLuint vertex_buffer_;
+        GLuint index_buffer_;
+        GLuint color_buffer_;
+        // element capacities of the GL buffers
+        size_t vertex_buffer_capacity_;
+        size_t index_buffer_capacity_;
+        size_t color_buffer_capacity_;
+
+        bool colors_;
+
+        std::vector <RangeAllocator::Range> dirty_;
+        // index ranges of the slices inside the frustum, kept for the capacity
+        std::vector <RangeAllocator::Range> visible_;
+    };
+
+}  // namespace tango_augmented_reality
+
+#endif  // TANGO_AUGMENTED_REALITY_MESH_BUFFER_MANAGER_H_
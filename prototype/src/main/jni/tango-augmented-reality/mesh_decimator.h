@@ -0,0 +1,39 @@
+
+#ifndef TANGO_AUGMENTED_REALITY_MESH_DECIMATOR_H_
+#define TANGO_AUGMENTED_REALITY_MESH_DECIMATOR_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+namespace tango_augmented_reality {
+
+    // MeshDecimator reduces the triangles of a chunk mesh by quadric error edge
+    // collapses. Marching cubes puts many small triangles on flat surfaces,
+    // which collapse with almost no error. Vertices on open edges are never
+    // moved or removed, the borders of neighbouring chunks stay identical and
+    // the decimated chunks fit together without cracks.
+    class MeshDecimator {
+    public:
+        MeshDecimator();
+
+        // edges are collapsed while the surface moves less than max_error
+        // meters, 0 disables the decimation
+        void setMaxError(float max_error);
+
+        float getMaxError() const { return max_error_; }
+
+        // decimates a triangle mesh in place. Vertices are xyz triples, indices
+        // triples of vertex indices and colors are rgb triples per vertex or
+        // empty. Equal positions are welded, the output is an indexed mesh.
+        void decimate(std::vector <float> &vertices, std::vector <uint32_t> &indices,
+                      std::vector <float> &colors) const;
+
+    private:
+        // set from the UI thread, read by the thread meshing the chunks
+        std::atomic <float> max_error_;
+    };
+
+}  // namespace tango_augmented_reality
+
+#endif  // TANGO_AUGMENTED_REALITY_MESH_DECIMATOR_H_
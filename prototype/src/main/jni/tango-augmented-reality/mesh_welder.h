@@ -0,0 +1,56 @@
+
+#ifndef TANGO_AUGMENTED_REALITY_MESH_WELDER_H_
+#define TANGO_AUGMENTED_REALITY_MESH_WELDER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+namespace tango_augmented_reality {
+
+    // MeshWelder turns a triangle soup into an indexed mesh. Positions are
+    // snapped to a fine grid and looked up in a spatial hash, so each shared
+    // vertex is stored once. Because of the snapping, two chunks meshed on
+    // their own still produce bit identical vertices along their seam.
+    class MeshWelder {
+    public:
+        // vertices within the same cell of precision meters are merged
+        explicit MeshWelder(float precision = 1e-4f);
+
+        // returns the index of the vertex at x, y, z and adds it if it is new
+        uint32_t add(float x, float y, float z);
+
+        // snapped xyz triples in the order they were added
+        const std::vector <float> &getVertices() const { return vertices_; }
+
+        size_t getVertexCount() const { return vertices_.size() / 3; }
+
+        void clear();
+
+    private:
+        struct Cell {
+            int32_t x, y, z;
+
+            bool operator==(const Cell &other) const {
+                return x == other.x && y == other.y && z == other.z;
+            }
+        };
+
+        struct CellHasher {
+            size_t operator()(const Cell &cell) const {
+                // unsigned, the products of far cells overflow
+                return static_cast<size_t>(static_cast<uint32_t>(cell.x) * 73856093u ^
+                                           static_cast<uint32_t>(cell.y) * 19349669u ^
+                                           static_cast<uint32_t>(cell.z) * 83492791u);
+            }
+        };
+
+        float precision_;
+        std::unordered_map <Cell, uint32_t, CellHasher> cells_;
+        std::vector <float> vertices_;
+    };
+
+}  // namespace tango_augmented_reality
+
+#endif  // TANGO_AUGMENTED_REALITY_MESH_WELDER_H_
@@ -0,0 +1,87 @@
+
+#ifndef TANGO_AUGMENTED_REALITY_PARALLEL_CHISEL_H_
+#define TANGO_AUGMENTED_REALITY_PARALLEL_CHISEL_H_
+
+#include <functional>
+#include <memory>
+
+#include <open_chisel/Chisel.h>
+#include <open_chisel/ProjectionIntegrator.h>
+#include <open_chisel/camera/DepthImage.h>
+#include <open_chisel/camera/PinholeCamera.h>
+#include <open_chisel/pointcloud/PointCloud.h>
+
+#include "tango-augmented-reality/worker_pool.h"
+
+namespace tango_augmented_reality {
+
+    enum IntegrationMode {
+        // frames are rasterized into a dense depth image first
+        DEPTH_IMAGE = 0,
+        // the sparse points are integrated along their rays
+        POINT_CLOUD = 1
+    };
+
+    // ParallelChisel integrates the chunks touched by one scan on a worker
+    // pool. The chunks are collected and created up front, each one is then
+    // integrated on its own, and the chunks to remesh are marked once all are
+    // done. Chunks never share voxels, so the schedule does not change the
+    // result: depth scans and point clouds within max_distance give the voxels
+    // of the serial Chisel integration, see parallel_chisel_test. With carving
+    // enabled, point clouds also carve existing chunks in front of the
+    // truncation band, which the serial integration skips.
+    class ParallelChisel : public chisel::Chisel {
+    public:
+        ParallelChisel(const Eigen::Vector3i &chunk_size, float resolution, bool colors);
+
+        // integrator for the voxels of this map with the quadratic truncation
+        // of the Tango depth camera, a carving distance of 0 disables carving
+        chisel::ProjectionIntegrator createIntegrator(float truncation_scale, float weighting,
+                                                      float carving_distance) const;
+
+        // IntegrateDepthScan for all chunks in the frustum of camera
+        void integrateDepthScan(WorkerPool &pool, const chisel::ProjectionIntegrator &integrator,
+                                const boost::shared_ptr<const chisel::DepthImage<float>> &depth,
+                                const chisel::Transform &extrinsic,
+                                const chisel::PinholeCamera &camera);
+
+        // IntegratePointCloud for the chunks within truncation of the points up
+        // to max_distance, and the existing chunks within the carving distance
+        // in front of that band
+        void integratePointCloud(WorkerPool &pool, const chisel::ProjectionIntegrator &integrator,
+                                 const chisel::PointCloud &cloud,
+                                 const chisel::Transform &extrinsic, float truncation,
+                                 float max_distance);
+
+        // marks a chunk and its neighbours for remeshing, for chunks which were
+        // added without integration
+        void remeshChunk(const chisel::ChunkID &id);
+
+        // remeshes the marked chunks in order of their distance to the camera,
+        // chunks in view direction first, until budget_ms is used up. meshed
+        // runs right after each chunk got its mesh and counts against the
+        // budget as well. At least one chunk is remeshed per call, the others
+        // stay marked for the next calls. Returns the count of chunks still
+        // marked.
+        size_t updateMeshes(const chisel::Vec3 &camera, const chisel::Vec3 &forward,
+                            double budget_ms,
+                            const std::function<void(const chisel::ChunkID &)> &meshed);
+
+        // chunks the last integration changed, the marked chunks might also
+        // contain chunks waiting for their mesh
+        const chisel::ChunkIDList &getIntegratedChunks() const { return integrated_; }
+
+    private:
+        // integrates the chunks on the pool, creates missing ones and drops
+        // new chunks which integrate returned false for
+        void integrateChunks(WorkerPool &pool, const chisel::ChunkIDList &ids,
+                             const std::function<bool(chisel::Chunk *)> &integrate);
+
+        chisel::ChunkIDList integrated_;
+    };
+
+    typedef std::shared_ptr <ParallelChisel> ParallelChiselPtr;
+
+}  // namespace tango_augmented_reality
+
+#endif  // TANGO_AUGMENTED_REALITY_PARALLEL_CHISEL_H_
@@ -0,0 +1,58 @@
+
+#ifndef TANGO_AUGMENTED_REALITY_PLANE_MAP_H_
+#define TANGO_AUGMENTED_REALITY_PLANE_MAP_H_
+
+#include <vector>
+
+#include "tango-augmented-reality/convex_hull.h"
+#include "tango-augmented-reality/mesh_buffer_manager.h"
+#include "tango-augmented-reality/plane_segmenter.h"
+#include "tango-augmented-reality/plane_statistics.h"
+
+namespace tango_augmented_reality {
+
+    // PlaneMap fuses the planes of single depth frames into a global set of
+    // planes. A frame segment is merged into a known plane with a similar normal
+    // and offset next to its extent, otherwise it starts a new plane. Every plane
+    // is drawn as the convex hull of all its observations.
+    class PlaneMap {
+    public:
+        // merges the segments of a frame, transformation maps depth camera
+        // points into the world (point * transformation)
+        void fuse(const std::vector <PlaneSegment> &segments, const glm::mat4 &transformation);
+
+        // replaces the slices of all planes which changed since the last call
+        void updateSlices(MeshSliceMap &slices);
+
+        int getPlaneCount() { return planes_.size(); }
+
+        void clear();
+
+    private:
+        struct MapPlane {
+            PlaneStatistics statistics;
+            glm::vec3 normal;
+            float distance;
+            // closed convex hull in world coordinates
+            std::vector <glm::vec3> hull;
+            // bounding box of the hull
+            glm::vec3 min;
+            glm::vec3 max;
+            bool changed;
+        };
+
+        // returns the index of the plane matching the segment or -1
+        int findPlane(const glm::vec3 &normal, float distance, const glm::vec3 &min,
+                      const glm::vec3 &max);
+
+        // grows the hull of the plane by the given points
+        void updateHull(MapPlane &plane, const std::vector <glm::vec3> &points);
+
+        std::vector <MapPlane> planes_;
+
+        ConvexHull convex_hull_;
+    };
+
+}  // namespace tango_augmented_reality
+
+#endif  // TANGO_AUGMENTED_REALITY_PLANE_MAP_H_
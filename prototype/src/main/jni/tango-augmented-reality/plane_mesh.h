@@ -3,36 +3,133 @@
 #define TANGO_AUGMENTED_REALITY_PLANE_MESH_H_
 
 #include <tango-gl/drawable_object.h>
+#include <atomic>
 #include <mutex>
+#include <thread>
 
+#include "tango-augmented-reality/bounded_queue.h"
+#include "tango-augmented-reality/mesh_buffer_manager.h"
+#include "tango-augmented-reality/plane_map.h"
+#include "tango-augmented-reality/plane_segmenter.h"
 #include "tango-augmented-reality/reconstruction_octree.h"
+#include "tango-augmented-reality/reconstruction_scheduler.h"
+#include "tango-augmented-reality/triple_buffer.h"
 
 
 namespace tango_augmented_reality {
+
+    enum PlaneEngine {
+        // RANSAC on the accumulated points of each octree leaf
+        OCTREE_RANSAC = 0,
+        // segmentation of each depth frame, fused into a global plane set
+        ORGANIZED_SEGMENTATION = 1
+    };
+
+    // depth frame in depth camera coordinates with its world transformation
+    struct PlaneFrame {
+        glm::mat4 transformation;
+        std::vector <float> vertices;
+    };
+
+    // PlaneMesh reconstructs planes on a worker thread. Depth frames are queued
+    // by addFrame, finished meshes are published through a triple buffer which
+    // Render picks up without waiting for the worker. Each octree leaf is one
+    // mesh slice, so only reconstructed leaves get uploaded to the GPU.
     class PlaneMesh : public tango_gl::DrawableObject {
     public:
         PlaneMesh();
 
         PlaneMesh(GLenum render_mode);
 
+        ~PlaneMesh();
+
         void SetShader();
 
         void Render(const glm::mat4 &projection_mat, const glm::mat4 &view_mat) const;
 
-        void addPoints(glm::mat4 transformation, std::vector <float> &vertices);
+        // renders the planes into the depth buffer only, moved towards the
+        // camera by pull_forward meters, so noisy depth right behind a plane
+        // is replaced while objects in front of it are kept
+        void RenderDepth(const glm::mat4 &projection_mat, const glm::mat4 &view_mat,
+                         float pull_forward) const;
+
+        // queues a depth frame for the worker, drops the oldest one if the
+        // worker falls behind
+        void addFrame(glm::mat4 transformation, const std::vector <float> &vertices);
+
+        // current AR camera, used to reconstruct visible clusters first
+        void setCamera(const glm::mat4 &view_projection, const glm::vec3 &position);
 
-        void updateVertices();
+        // depth camera intrinsics, needed by the organized segmentation
+        void setIntrinsics(float fx, float fy, float cx, float cy, int width, int height);
 
-        std::mutex render_mutex;
+        // switches between the PlaneEngine values, resets the reconstruction
+        void setEngine(int engine);
+
+        PlaneEngine getEngine() { return static_cast<PlaneEngine>(engine_.load()); }
 
         void clear();
 
     protected:
 
+        // worker loop, consumes frames and reconstructs queued leaves
+        void run();
+
+        // adds the points to the octree and queues the updated leaves
+        void addPoints(glm::mat4 transformation, std::vector <float> &vertices);
+
+        // segments the planes of a frame, fuses them into the plane map and
+        // publishes the changed planes
+        void segmentFrame(glm::mat4 transformation, std::vector <float> &vertices);
+
+        // reconstructs queued leaves within budget_ms, leaves inside the frustum
+        // and close to the camera first. Returns true if the mesh was updated.
+        bool reconstruct(double budget_ms);
+
+        // replaces the slices of the reconstructed leaves and publishes all
+        // slices to the render thread
+        void updateVertices(const std::vector <ReconstructionOcTree *> &leaves);
+
         GLuint uniform_mv_mat_;
 
+        // depth only program of RenderDepth
+        GLuint depth_program_;
+        GLuint uniform_depth_mv_;
+        GLuint uniform_depth_projection_;
+        GLuint uniform_depth_pull_;
+        GLuint attrib_depth_vertices_;
+
         ReconstructionOcTree* tree;
 
+        ReconstructionScheduler scheduler_;
+
+        // organized segmentation engine
+        OrganizedPlaneSegmenter segmenter_;
+        std::mutex segmenter_mutex_;
+        PlaneMap plane_map_;
+
+        BoundedQueue <PlaneFrame> frames_;
+
+        // slices of the worker, one per octree leaf
+        MeshSliceMap slices_;
+
+        // slices published by the worker, swapped in by Render
+        mutable TripleBuffer <MeshSliceMap> meshes_;
+
+        // GPU copy of the published slices, owned by the GL thread
+        mutable MeshBufferManager buffers_;
+
+        std::mutex camera_mutex_;
+        glm::mat4 camera_view_projection_;
+        glm::vec3 camera_position_;
+
+        // engine requested by setEngine and the one the worker runs, which
+        // only follows the request when it clears the old engine's slices
+        std::atomic <int> engine_;
+        int active_engine_;
+        std::atomic <bool> running_;
+        std::atomic <bool> clear_requested_;
+        std::thread worker_;
     };
 
 }  // namespace tango_augmented_reality
@@ -0,0 +1,87 @@
+
+#ifndef TANGO_AUGMENTED_REALITY_PLANE_SEGMENTER_H_
+#define TANGO_AUGMENTED_REALITY_PLANE_SEGMENTER_H_
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "tango-augmented-reality/plane_statistics.h"
+
+namespace tango_augmented_reality {
+
+    // plane found in a single depth frame, in depth camera coordinates
+    struct PlaneSegment {
+        // normal faces the camera
+        glm::vec3 normal;
+        float distance;
+        std::vector <glm::vec3> points;
+    };
+
+    // OrganizedPlaneSegmenter finds planes in a single depth frame by agglomerative
+    // hierarchical clustering on a grid of image cells (Feng et al. 2014). The
+    // points are projected into the depth image with the camera intrinsics, each
+    // cell which fits a plane becomes a node, and neighbouring nodes are merged
+    // greedily as long as the merged plane stays within the sensor noise.
+    class OrganizedPlaneSegmenter {
+    public:
+        OrganizedPlaneSegmenter();
+
+        void setIntrinsics(float fx, float fy, float cx, float cy, int width, int height);
+
+        // segments a frame of xyz triples in depth camera coordinates, finds
+        // nothing until the intrinsics are set
+        void segment(const std::vector <float> &vertices, std::vector <PlaneSegment> &segments);
+
+    private:
+        struct Node {
+            PlaneStatistics statistics;
+            glm::vec3 normal;
+            float distance;
+            float mse;
+            std::vector <int> cells;
+            // small unordered set of adjacent nodes
+            std::vector <int> neighbours;
+            bool alive;
+        };
+
+        struct Candidate {
+            float mse;
+            int node;
+            bool operator<(const Candidate &other) const { return mse > other.mse; }
+        };
+
+        // projects the points into grid cells
+        void buildGrid(const std::vector <float> &vertices);
+
+        // creates a node for every cell which is planar enough
+        void initGraph(const std::vector <float> &vertices);
+
+        void addNeighbour(Node &node, int neighbour);
+
+        void removeNeighbour(Node &node, int neighbour);
+
+        // largest mean squared error accepted for a plane at the given depth
+        float maxMse(float depth);
+
+        // turns a finished node into a segment
+        void extract(const Node &node, const std::vector <float> &vertices,
+                     std::vector <PlaneSegment> &segments);
+
+        float fx_, fy_, cx_, cy_;
+        int grid_width_;
+        int grid_height_;
+
+        // points of each cell, stored as ranges in cell_points_
+        std::vector <int> cell_start_;
+        std::vector <int> cell_points_;
+        std::vector <int> point_cell_;
+
+        // node of each cell or -1
+        std::vector <int> cell_node_;
+        std::vector <Node> nodes_;
+    };
+
+}  // namespace tango_augmented_reality
+
+#endif  // TANGO_AUGMENTED_REALITY_PLANE_SEGMENTER_H_
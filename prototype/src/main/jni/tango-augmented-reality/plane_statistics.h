@@ -0,0 +1,46 @@
+
+#ifndef TANGO_AUGMENTED_REALITY_PLANE_STATISTICS_H_
+#define TANGO_AUGMENTED_REALITY_PLANE_STATISTICS_H_
+
+#include <glm/glm.hpp>
+
+namespace tango_augmented_reality {
+
+    // PlaneStatistics keeps the first and second moments of a point set, so
+    // a least squares plane of the union of two sets can be fitted in constant
+    // time without visiting the points again.
+    class PlaneStatistics {
+    public:
+        PlaneStatistics();
+
+        void add(const glm::vec3 &point);
+
+        // adds all points of another set
+        void merge(const PlaneStatistics &other);
+
+        int getCount() const { return count_; }
+
+        glm::vec3 getCentroid() const;
+
+        // fits a plane through the centroid, normal is the direction of the
+        // smallest variance. Returns the mean squared distance of the points
+        // to the plane, or a negative value for less than three points.
+        float fit(glm::vec3 &normal, float &distance) const;
+
+        // mean squared distance of the fitted plane without computing the plane
+        float fitError() const;
+
+    private:
+        // centroid and symmetric covariance matrix
+        void covariance(double mean[3], double cv[9]) const;
+
+        int count_;
+        // sum of x, y, z
+        double sum_[3];
+        // sum of xx, xy, xz, yy, yz, zz
+        double squares_[6];
+    };
+
+}  // namespace tango_augmented_reality
+
+#endif  // TANGO_AUGMENTED_REALITY_PLANE_STATISTICS_H_
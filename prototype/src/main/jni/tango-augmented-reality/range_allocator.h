@@ -0,0 +1,60 @@
+
+#ifndef TANGO_AUGMENTED_REALITY_RANGE_ALLOCATOR_H_
+#define TANGO_AUGMENTED_REALITY_RANGE_ALLOCATOR_H_
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+namespace tango_augmented_reality {
+
+    // RangeAllocator manages element ranges inside a linear buffer of fixed
+    // capacity and remembers which ranges were written since the last upload.
+    // It does not touch OpenGL, the owner maps the ranges onto GPU buffers.
+    class RangeAllocator {
+    public:
+        struct Range {
+            size_t offset;
+            size_t size;
+        };
+
+        explicit RangeAllocator(size_t capacity = 0);
+
+        // first fit allocation, returns false if no free range is large enough
+        bool allocate(size_t size, size_t &offset);
+
+        // returns a range to the free list and merges it with its neighbours
+        void release(size_t offset, size_t size);
+
+        // appends free space up to the new capacity
+        void grow(size_t capacity);
+
+        // marks a range as written, overlapping and adjacent ranges are merged
+        void markDirty(size_t offset, size_t size);
+
+        // moves the merged dirty ranges into ranges and resets the dirty state
+        void takeDirtyRanges(std::vector <Range> &ranges);
+
+        // releases all ranges, the capacity is kept
+        void clear();
+
+        size_t getCapacity() const { return capacity_; }
+
+        // count of allocated elements
+        size_t getUsed() const { return used_; }
+
+        // count of free ranges, a measure of fragmentation
+        size_t getFreeRangeCount() const { return free_.size(); }
+
+    private:
+        size_t capacity_;
+        size_t used_;
+        // offset -> size of free ranges, never adjacent to each other
+        std::map <size_t, size_t> free_;
+        // offset -> size of written ranges, never adjacent to each other
+        std::map <size_t, size_t> dirty_;
+    };
+
+}  // namespace tango_augmented_reality
+
+#endif  // TANGO_AUGMENTED_REALITY_RANGE_ALLOCATOR_H_
@@ -26,8 +26,20 @@ namespace tango_augmented_reality {
         void addPoint(glm::vec3 point);
 
 
-        // triggers the clusters reconstruction
-        void reconstruct();
+        // collects all leaves with new points, which are not collected yet
+        void collectUpdatedLeaves(std::vector <ReconstructionOcTree *> &leaves);
+
+        // reconstructs a single leaf and marks it as processed
+        void reconstructLeaf();
+
+        // center of the cubic node
+        glm::vec3 getCenter() { return position_ + glm::vec3(halfRange_); }
+
+        // size of the cubic node
+        float getRange() { return range_; }
+
+        // count of points added since the last reconstruction of this leaf
+        int getNewPointCount() { return new_points_; }
 
         // collects the reconstructed mesg from each cluster
         std::vector <glm::vec3> getMesh();
@@ -53,6 +65,10 @@ namespace tango_augmented_reality {
         ReconstructionOcTree **children_;
         // boolean flag if the points got updated
         bool updated;
+        // boolean flag if the leaf is already waiting for its reconstruction
+        bool collected_;
+        // points added to the leaf since its last reconstruction
+        int new_points_;
 
         // get Octree child index of a given point
         int getChildIndex(glm::vec3 point);
@@ -0,0 +1,47 @@
+
+#ifndef TANGO_AUGMENTED_REALITY_RECONSTRUCTION_SCHEDULER_H_
+#define TANGO_AUGMENTED_REALITY_RECONSTRUCTION_SCHEDULER_H_
+
+#include <vector>
+
+#include "tango-augmented-reality/reconstruction_octree.h"
+#include "tango-augmented-reality/view_frustum.h"
+
+namespace tango_augmented_reality {
+
+    // ReconstructionScheduler spreads the plane reconstruction of updated octree
+    // leaves over several frames. Each call processes the most important leaves
+    // until the time budget is used up, the rest is kept for the next call.
+    class ReconstructionScheduler {
+    public:
+        // queues all leaves of the tree which received new points
+        void collect(ReconstructionOcTree *tree);
+
+        // reconstructs queued leaves in priority order within the given budget,
+        // appends them to reconstructed and returns their count
+        int process(const ViewFrustum &frustum, const glm::vec3 &camera_position,
+                    double budget_ms, std::vector <ReconstructionOcTree *> &reconstructed);
+
+        // count of leaves waiting for their reconstruction
+        int getPendingCount() { return pending_.size(); }
+
+        // drops all queued leaves
+        void clear() { pending_.clear(); }
+
+    private:
+        struct PendingLeaf {
+            ReconstructionOcTree *leaf;
+            float priority;
+        };
+
+        // rates a leaf by visibility, distance to the device and new points
+        float priority(ReconstructionOcTree *leaf, const ViewFrustum &frustum,
+                       const glm::vec3 &camera_position);
+
+        // leaves waiting for their reconstruction
+        std::vector <PendingLeaf> pending_;
+    };
+
+}  // namespace tango_augmented_reality
+
+#endif  // TANGO_AUGMENTED_REALITY_RECONSTRUCTION_SCHEDULER_H_
@@ -126,6 +126,8 @@ namespace tango_augmented_reality {
         std::array<Plane, RANSAC_DETECT_PLANES> planes;
         // available planes
         std::array<bool, RANSAC_DETECT_PLANES> plane_available;
+        // hull generator, keeps its buffers between reconstructions
+        ConvexHull convex_hull_;
 
     };
 
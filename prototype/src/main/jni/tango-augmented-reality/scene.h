@@ -36,6 +36,7 @@
 #include <tango-augmented-reality/depth_drawable.h>
 #include <tango-augmented-reality/chisel_mesh.h>
 #include <tango-augmented-reality/plane_mesh.h>
+#include <tango-augmented-reality/keyframe_scheduler.h>
 #include <tango-augmented-reality/ar_object.h>
 #include <tango_support_api.h>
 
@@ -160,12 +161,59 @@ namespace tango_augmented_reality {
 
         void SetDepthFullscreen(bool show) { depth_fullscreen = show; }
 
+        // completes the depth map with the reconstructed planes
+        void SetPlaneCompletion(bool enabled) { plane_completion = enabled; }
+
         ARMode GetMode() { return mode; }
 
         void SetDepthIntrinsics(TangoCameraIntrinsics depth_intrinsics_);
 
+        // intrinsics of the color camera, used to color the TSDF
+        void SetColorIntrinsics(TangoCameraIntrinsics color_intrinsics);
+
         void ClearReconstruction();
 
+        // selects the PlaneEngine of the plane reconstruction
+        void SetPlaneEngine(int engine);
+
+        // selects the IntegrationMode of the TSDF reconstruction
+        void SetIntegrationMode(int integration_mode);
+
+        // compares the TSDF integration modes on the last frames, results go to the log
+        void BenchmarkReconstruction();
+
+        // replays the depth session at path, or the last frames for an empty
+        // path, for a grid of TSDF parameters, results go to the log and path.csv
+        void SweepReconstruction(const std::string &path);
+
+        // records the integrated TSDF frames to path, an empty path stops it
+        void SetSessionRecording(const std::string &path);
+
+        // writes the TSDF into a map file
+        void SaveTsdf(const std::string &path);
+
+        // replaces the TSDF by a map file, its chunks load around the camera
+        void LoadTsdf(const std::string &path);
+
+        // spills distant TSDF chunks to directory above budget_megabytes
+        void SetTsdfStreaming(const std::string &directory, int budget_megabytes);
+
+        // integrates the color camera into the TSDF, toggling clears the reconstruction
+        void SetTsdfColor(bool enabled);
+
+        // decimates the TSDF chunks with max_error meters, 0 disables it
+        void SetTsdfDecimation(float max_error);
+
+        // integrates distant depth into a coarser TSDF, toggling clears the reconstruction
+        void SetTsdfMultiResolution(bool enabled);
+
+        // occludes with depth ray cast from the TSDF at width x height instead
+        // of the rendered mesh, 0 disables it
+        void SetTsdfRaycast(int width, int height);
+
+        // selects when depth frames are integrated in the TSDF or PLANE mode
+        void SetKeyframeSettings(int id, const KeyframeSettings &settings);
+
         void SetFilterSettings(int diameter_, double sigma_) {
             diameter = diameter_;
             sigma = sigma_;
@@ -174,6 +222,10 @@ namespace tango_augmented_reality {
         void joyStick(double angle, double power);
 
     private:
+        // requests the TSDF depth at the current camera and writes the newest
+        // ray cast depth into the bound depth frame buffer
+        void RenderRaycastDepth();
+
         // Video overlay drawable object to display the camera image.
         YUVDrawable *yuv_drawable_;
 
@@ -197,7 +249,7 @@ namespace tango_augmented_reality {
         // A cub placed at (0.0f, 0.0f, -1.0f) location.
         ArObject *cube_;
 
-        ChiselMesh *chisel_mesh_;
+        ChiselMesh *chisel_mesh_ = nullptr;
 
         PlaneMesh *plane_mesh_;
 
@@ -257,10 +309,24 @@ namespace tango_augmented_reality {
         bool do_filtering = false;
         bool show_occlusion = false;
         bool depth_fullscreen = false;
+        bool plane_completion = false;
+        std::string tsdf_directory;
+        int tsdf_budget_megabytes = 0;
+        bool tsdf_color = false;
+        float tsdf_decimation = 0.0f;
+        bool tsdf_multi_resolution = false;
+        int tsdf_raycast_width = 0;
+        int tsdf_raycast_height = 0;
+        // ray cast TSDF depth scaled to the depth frame buffer
+        cv::Mat raycast_frame;
         ARMode mode = POINTCLOUD;
 
         double last_depth_timestamp = 0;
-        double last_depth_timestamp_updated = 0;
+        // newest depth frame the keyframe schedulers have seen
+        double last_depth_timestamp_tested = 0;
+        KeyframeScheduler tsdf_keyframes_;
+        // plane frames, in the PLANE mode and for the plane completion
+        KeyframeScheduler plane_keyframes_;
     };
 }  // namespace tango_augmented_reality
 
@@ -0,0 +1,53 @@
+
+#ifndef TANGO_AUGMENTED_REALITY_TRIPLE_BUFFER_H_
+#define TANGO_AUGMENTED_REALITY_TRIPLE_BUFFER_H_
+
+#include <atomic>
+
+namespace tango_augmented_reality {
+
+    // Lock free triple buffer between one writer and one reader thread. The
+    // writer fills back() and publishes it, the reader picks up the newest
+    // published buffer with update() and reads it through front(). Neither side
+    // ever waits for the other.
+    template<class T>
+    class TripleBuffer {
+    public:
+        TripleBuffer() : write_(0), read_(1), middle_(2) { }
+
+        // buffer owned by the writer
+        T &back() { return buffers_[write_]; }
+
+        // hands the back buffer over to the reader
+        void publish() {
+            write_ = middle_.exchange(write_ | kFresh) & kIndexMask;
+        }
+
+        // swaps in the newest published buffer, returns false if there is none
+        bool update() {
+            if (!(middle_.load() & kFresh)) {
+                return false;
+            }
+            read_ = middle_.exchange(read_) & kIndexMask;
+            return true;
+        }
+
+        // buffer owned by the reader
+        T &front() { return buffers_[read_]; }
+
+        const T &front() const { return buffers_[read_]; }
+
+    private:
+        static const int kIndexMask = 3;
+        static const int kFresh = 4;
+
+        T buffers_[3];
+        int write_;
+        int read_;
+        // index of the buffer in between, flagged if it was not read yet
+        std::atomic<int> middle_;
+    };
+
+}  // namespace tango_augmented_reality
+
+#endif  // TANGO_AUGMENTED_REALITY_TRIPLE_BUFFER_H_
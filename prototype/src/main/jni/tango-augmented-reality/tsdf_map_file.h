@@ -0,0 +1,134 @@
+
+#ifndef TANGO_AUGMENTED_REALITY_TSDF_MAP_FILE_H_
+#define TANGO_AUGMENTED_REALITY_TSDF_MAP_FILE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <open_chisel/Chunk.h>
+
+#include "tango-augmented-reality/voxel_codec.h"
+
+namespace tango_augmented_reality {
+
+    // runs of equal packed voxels, a run never exceeds the voxels of one
+    // chunk. The color stays zero for chunks without color voxels.
+    struct VoxelRun {
+        uint32_t length;
+        int16_t sdf;
+        uint8_t weight;
+        uint8_t color[4];
+    };
+
+    // chunk packed with a VoxelCodec and run-length encoded, empty space
+    // collapses into a few runs
+    struct PackedChunk {
+        uint32_t count;
+        uint32_t colors;
+        // weight step the chunk was packed with
+        float weight_step;
+        std::vector <VoxelRun> runs;
+
+        void pack(const chisel::Chunk &chunk, float resolution, float weight_step);
+
+        // chunk has to be new, with the voxel count and colors of the packed one
+        bool unpack(chisel::Chunk &chunk, float resolution) const;
+    };
+
+    // TsdfMapFile stores packed chunks in a single file with an index of chunk
+    // ids to file offsets at its end. The records of removed and rewritten
+    // chunks go to a free list, adjacent ones are merged, and writes take the
+    // smallest free record that fits before appending. Chunks moving in and
+    // out of a created map therefore do not grow the file. Reads go through a
+    // read only memory mapping, so opening a map only reads its index and the
+    // chunks are decoded when they are needed.
+    class TsdfMapFile {
+    public:
+        TsdfMapFile();
+
+        ~TsdfMapFile();
+
+        // creates an empty map for chunks of the given layout, truncates path
+        bool create(const std::string &path, const Eigen::Vector3i &chunk_size,
+                    float resolution);
+
+        // opens a map read only, fails if its chunk layout differs
+        bool open(const std::string &path, const Eigen::Vector3i &chunk_size,
+                  float resolution);
+
+        // writes the index and unmaps the file
+        void close();
+
+        bool isOpen() const { return file_ >= 0; }
+
+        const std::string &getPath() const { return path_; }
+
+        bool contains(const chisel::ChunkID &id) const;
+
+        // writes a chunk into a free record of a created map or appends it
+        bool write(const chisel::ChunkID &id, const PackedChunk &chunk);
+
+        bool read(const chisel::ChunkID &id, PackedChunk &chunk);
+
+        // drops a chunk from the index, a created map reuses its record
+        void remove(const chisel::ChunkID &id);
+
+        std::vector <chisel::ChunkID> getChunkIDs() const;
+
+        size_t getChunkCount() const { return index_.size(); }
+
+        // writes the index behind the records, a created map is readable by
+        // open afterwards and further writes append again
+        bool flush();
+
+        // bytes of the records in the file, free ones included
+        uint64_t getRecordBytes() const;
+
+        uint64_t getFreeBytes() const { return free_bytes_; }
+
+    private:
+        struct Record {
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        // takes the smallest free record of at least size bytes, or the end
+        uint64_t allocate(uint64_t size);
+
+        // returns a record to the free list, merged with its free neighbours
+        void release(const Record &record);
+
+        // drops a record from both free lists
+        void eraseFree(uint64_t offset, uint64_t size);
+
+        // maps at least size bytes of the file
+        bool map(size_t size);
+
+        void unmap();
+
+        std::string path_;
+        int file_;
+        bool writable_;
+        // end of the last record, the index starts here
+        uint64_t end_;
+        // dirty index which was not flushed yet
+        bool changed_;
+
+        const uint8_t *mapping_;
+        size_t mapped_size_;
+
+        std::unordered_map <chisel::ChunkID, Record, chisel::ChunkHasher> index_;
+
+        // free records of a created map by offset and by size
+        std::map <uint64_t, uint64_t> free_;
+        std::multimap <uint64_t, uint64_t> free_sizes_;
+        uint64_t free_bytes_;
+    };
+
+}  // namespace tango_augmented_reality
+
+#endif  // TANGO_AUGMENTED_REALITY_TSDF_MAP_FILE_H_
@@ -0,0 +1,48 @@
+
+#ifndef TANGO_AUGMENTED_REALITY_TSDF_RAYCASTER_H_
+#define TANGO_AUGMENTED_REALITY_TSDF_RAYCASTER_H_
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <open_chisel/ChunkManager.h>
+
+#include "tango-augmented-reality/worker_pool.h"
+
+namespace tango_augmented_reality {
+
+    // TsdfRaycaster renders a depth image straight from the voxels of a TSDF,
+    // so occlusion does not need a mesh of the reconstruction. Rays jump over
+    // chunks which were never allocated and step through the others by the
+    // signed distance until it changes its sign.
+    class TsdfRaycaster {
+    public:
+        TsdfRaycaster();
+
+        void setResolution(int width, int height);
+
+        int getWidth() const { return width_; }
+
+        int getHeight() const { return height_; }
+
+        // casts a ray per pixel of view_projection up to max_distance meters
+        // and writes the window depth in [0, 1], rows start at the bottom like
+        // GL textures. depth has to hold width * height values, closer depth
+        // already in there is kept, so several TSDF levels can be combined.
+        void raycast(const chisel::ChunkManager &chunks, const glm::mat4 &view_projection,
+                     float max_distance, WorkerPool &pool, std::vector <float> &depth) const;
+
+    private:
+        // distance along the normalized direction to the first surface, a
+        // negative value if there is none in front of max_distance
+        float castRay(const chisel::ChunkManager &chunks, const glm::vec3 &origin,
+                      const glm::vec3 &direction, float max_distance) const;
+
+        int width_;
+        int height_;
+    };
+
+}  // namespace tango_augmented_reality
+
+#endif  // TANGO_AUGMENTED_REALITY_TSDF_RAYCASTER_H_
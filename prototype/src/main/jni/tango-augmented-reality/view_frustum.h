@@ -0,0 +1,36 @@
+
+#ifndef TANGO_AUGMENTED_REALITY_VIEW_FRUSTUM_H_
+#define TANGO_AUGMENTED_REALITY_VIEW_FRUSTUM_H_
+
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+namespace tango_augmented_reality {
+
+    // ViewFrustum holds the six clipping planes of a camera and answers
+    // visibility queries on the CPU, it does not depend on an OpenGL context.
+    class ViewFrustum {
+    public:
+        // creates a frustum which contains the whole space
+        ViewFrustum();
+
+        // extracts the clipping planes from a projection * view matrix
+        explicit ViewFrustum(const glm::mat4 &view_projection);
+
+        // tests if an axis aligned box is at least partially inside the frustum
+        bool intersects(const glm::vec3 &min, const glm::vec3 &max) const;
+
+        // tests if a sphere is at least partially inside the frustum
+        bool intersectsSphere(const glm::vec3 &center, float radius) const;
+
+        // tests if a point is inside the frustum
+        bool contains(const glm::vec3 &point) const;
+
+    private:
+        // normalized planes (xyz normal pointing inside, w distance)
+        glm::vec4 planes_[6];
+    };
+
+}  // namespace tango_augmented_reality
+
+#endif  // TANGO_AUGMENTED_REALITY_VIEW_FRUSTUM_H_
@@ -0,0 +1,55 @@
+
+#ifndef TANGO_AUGMENTED_REALITY_VOXEL_CODEC_H_
+#define TANGO_AUGMENTED_REALITY_VOXEL_CODEC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include <open_chisel/Chunk.h>
+
+namespace tango_augmented_reality {
+
+    // compact copy of the distance voxels of a chunk, 3 bytes per voxel
+    struct CompactVoxels {
+        std::vector <int16_t> sdf;
+        std::vector <uint8_t> weight;
+    };
+
+    // VoxelCodec packs TSDF voxels into a 16 bit fixed point distance and an
+    // 8 bit weight instead of two floats. Distances saturate at 32767 steps,
+    // weights at 255 steps, which only makes long observed voxels adapt a bit
+    // faster. Voxels without weight are never touched when decoding, so they
+    // keep the default distance of the chunk.
+    class VoxelCodec {
+    public:
+        // sdf_step and weight_step are the values of one fixed point step
+        VoxelCodec(float sdf_step, float weight_step);
+
+        // codec for a TSDF with the given voxel size, the distance covers
+        // 128 voxels in both directions
+        static VoxelCodec forResolution(float resolution, float weight_step);
+
+        // largest distance error of a voxel inside the range
+        float getMaxError() const { return sdf_step_ * 0.5f; }
+
+        // conversion kernels over plain arrays of count voxels
+        void encode(const float *sdf, const float *weight, size_t count, int16_t *compact_sdf,
+                    uint8_t *compact_weight) const;
+
+        void decode(const int16_t *compact_sdf, const uint8_t *compact_weight, size_t count,
+                    float *sdf, float *weight) const;
+
+        void encode(const chisel::Chunk &chunk, CompactVoxels &voxels) const;
+
+        // voxels has to hold the voxel count of the chunk
+        void decode(const CompactVoxels &voxels, chisel::Chunk &chunk) const;
+
+    private:
+        float sdf_step_;
+        float weight_step_;
+    };
+
+}  // namespace tango_augmented_reality
+
+#endif  // TANGO_AUGMENTED_REALITY_VOXEL_CODEC_H_
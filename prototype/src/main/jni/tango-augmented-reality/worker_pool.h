@@ -0,0 +1,55 @@
+
+#ifndef TANGO_AUGMENTED_REALITY_WORKER_POOL_H_
+#define TANGO_AUGMENTED_REALITY_WORKER_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tango_augmented_reality {
+
+    // WorkerPool spreads independent tasks over a fixed set of threads. The
+    // threads are started once and sleep between jobs, so a job per frame does
+    // not pay for thread creation. The calling thread takes tasks as well.
+    class WorkerPool {
+    public:
+        // threads helpers besides the calling thread, 0 leaves one core for the rest
+        explicit WorkerPool(int threads = 0);
+
+        ~WorkerPool();
+
+        // calls task for every index in [0, count) and returns once all are
+        // done. Only one thread may run jobs at a time.
+        void run(int count, const std::function<void(int)> &task);
+
+        // threads working on a job including the calling one
+        int getThreadCount() const { return static_cast<int>(threads_.size()) + 1; }
+
+    private:
+        // helper loop, waits for the next job
+        void loop();
+
+        // takes tasks of the current job until none are left
+        void work();
+
+        std::vector <std::thread> threads_;
+        std::mutex mutex_;
+        std::condition_variable start_;
+        std::condition_variable done_;
+
+        // current job, set under mutex_ before the generation changes
+        const std::function<void(int)> *task_;
+        int count_;
+        std::atomic <int> next_;
+        // helpers which did not finish the current job yet
+        int active_;
+        unsigned generation_;
+        bool running_;
+    };
+
+}  // namespace tango_augmented_reality
+
+#endif  // TANGO_AUGMENTED_REALITY_WORKER_POOL_H_
@@ -0,0 +1,390 @@
+#include "tango-augmented-reality/tsdf_map_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+    const char kMagic[4] = {'T', 'S', 'D', 'F'};
+    const uint32_t kVersion = 1;
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        int32_t chunk_size[3];
+        float resolution;
+        uint64_t index_offset;
+        uint32_t index_count;
+        uint32_t reserved;
+    };
+
+    struct IndexEntry {
+        int32_t id[3];
+        uint32_t reserved;
+        uint64_t offset;
+    };
+
+    // count, runs, colors and weight step in front of the runs of a record
+    struct RecordHeader {
+        uint32_t count;
+        uint32_t runs;
+        uint32_t colors;
+        float weight_step;
+    };
+
+    bool writeAt(int file, const void *data, size_t size, uint64_t offset) {
+        const char *bytes = static_cast<const char *>(data);
+        while (size > 0) {
+            ssize_t written = pwrite(file, bytes, size, static_cast<off_t>(offset));
+            if (written <= 0) {
+                return false;
+            }
+            bytes += written;
+            size -= written;
+            offset += written;
+        }
+        return true;
+    }
+}  // namespace
+
+namespace tango_augmented_reality {
+
+    void PackedChunk::pack(const chisel::Chunk &chunk, float resolution, float step) {
+        CompactVoxels voxels;
+        VoxelCodec::forResolution(resolution, step).encode(chunk, voxels);
+        count = static_cast<uint32_t>(voxels.sdf.size());
+        colors = chunk.HasColors() ? 1u : 0u;
+        weight_step = step;
+        runs.clear();
+        for (size_t i = 0; i < voxels.sdf.size(); ++i) {
+            VoxelRun run = {1, voxels.sdf[i], voxels.weight[i], {0, 0, 0, 0}};
+            if (colors) {
+                const chisel::ColorVoxel &color = chunk.GetColorVoxel(i);
+                run.color[0] = color.GetRed();
+                run.color[1] = color.GetGreen();
+                run.color[2] = color.GetBlue();
+                run.color[3] = color.GetWeight();
+            }
+            if (!runs.empty() && runs.back().sdf == run.sdf && runs.back().weight == run.weight &&
+                std::equal(run.color, run.color + 4, runs.back().color)) {
+                runs.back().length++;
+            } else {
+                runs.push_back(run);
+            }
+        }
+    }
+
+    bool PackedChunk::unpack(chisel::Chunk &chunk, float resolution) const {
+        if (count != static_cast<uint32_t>(chunk.GetTotalNumVoxels()) ||
+            (colors && !chunk.HasColors())) {
+            return false;
+        }
+        CompactVoxels voxels;
+        voxels.sdf.reserve(count);
+        voxels.weight.reserve(count);
+        size_t voxel = 0;
+        for (size_t i = 0; i < runs.size(); ++i) {
+            const VoxelRun &run = runs[i];
+            for (uint32_t j = 0; j < run.length && voxel < count; ++j, ++voxel) {
+                voxels.sdf.push_back(run.sdf);
+                voxels.weight.push_back(run.weight);
+                if (colors) {
+                    chisel::ColorVoxel &color = chunk.GetColorVoxelMutable(voxel);
+                    color.SetRed(run.color[0]);
+                    color.SetGreen(run.color[1]);
+                    color.SetBlue(run.color[2]);
+                    color.SetWeight(run.color[3]);
+                }
+            }
+        }
+        if (voxel != count) {
+            return false;
+        }
+        VoxelCodec::forResolution(resolution, weight_step).decode(voxels, chunk);
+        return true;
+    }
+
+    TsdfMapFile::TsdfMapFile() : file_(-1), writable_(false), end_(0), changed_(false),
+                                 mapping_(nullptr), mapped_size_(0), free_bytes_(0) { }
+
+    TsdfMapFile::~TsdfMapFile() {
+        close();
+    }
+
+    bool TsdfMapFile::create(const std::string &path, const Eigen::Vector3i &chunk_size,
+                             float resolution) {
+        close();
+        file_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (file_ < 0) {
+            return false;
+        }
+        FileHeader header;
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        for (int axis = 0; axis < 3; ++axis) {
+            header.chunk_size[axis] = chunk_size(axis);
+        }
+        header.resolution = resolution;
+        header.index_offset = sizeof(FileHeader);
+        header.index_count = 0;
+        header.reserved = 0;
+        if (!writeAt(file_, &header, sizeof(header), 0)) {
+            close();
+            return false;
+        }
+        path_ = path;
+        writable_ = true;
+        end_ = sizeof(FileHeader);
+        return true;
+    }
+
+    bool TsdfMapFile::open(const std::string &path, const Eigen::Vector3i &chunk_size,
+                           float resolution) {
+        close();
+        file_ = ::open(path.c_str(), O_RDONLY);
+        struct stat status;
+        if (file_ < 0 || fstat(file_, &status) != 0 || !map(status.st_size) ||
+            mapped_size_ < sizeof(FileHeader)) {
+            close();
+            return false;
+        }
+        FileHeader header;
+        std::memcpy(&header, mapping_, sizeof(header));
+        bool valid = std::equal(kMagic, kMagic + 4, header.magic) && header.version == kVersion &&
+                     header.resolution == resolution &&
+                     header.index_offset + header.index_count * sizeof(IndexEntry) <= mapped_size_;
+        for (int axis = 0; axis < 3; ++axis) {
+            valid = valid && header.chunk_size[axis] == chunk_size(axis);
+        }
+        if (!valid) {
+            close();
+            return false;
+        }
+        const uint8_t *entries = mapping_ + header.index_offset;
+        for (uint32_t i = 0; i < header.index_count; ++i) {
+            IndexEntry entry;
+            std::memcpy(&entry, entries + i * sizeof(IndexEntry), sizeof(entry));
+            // sizes are only needed to reuse the records of created maps
+            Record record = {entry.offset, 0};
+            index_[chisel::ChunkID(entry.id[0], entry.id[1], entry.id[2])] = record;
+        }
+        path_ = path;
+        end_ = header.index_offset;
+        return true;
+    }
+
+    void TsdfMapFile::close() {
+        if (file_ < 0) {
+            return;
+        }
+        if (writable_ && changed_) {
+            flush();
+        }
+        unmap();
+        ::close(file_);
+        file_ = -1;
+        writable_ = false;
+        changed_ = false;
+        end_ = 0;
+        path_.clear();
+        index_.clear();
+        free_.clear();
+        free_sizes_.clear();
+        free_bytes_ = 0;
+    }
+
+    bool TsdfMapFile::contains(const chisel::ChunkID &id) const {
+        return index_.find(id) != index_.end();
+    }
+
+    bool TsdfMapFile::write(const chisel::ChunkID &id, const PackedChunk &chunk) {
+        if (!writable_) {
+            return false;
+        }
+        RecordHeader header = {chunk.count, static_cast<uint32_t>(chunk.runs.size()),
+                               chunk.colors, chunk.weight_step};
+        uint64_t size = sizeof(header) + chunk.runs.size() * sizeof(VoxelRun);
+        Record record = {allocate(size), size};
+        if (!writeAt(file_, &header, sizeof(header), record.offset) ||
+            !writeAt(file_, chunk.runs.data(), chunk.runs.size() * sizeof(VoxelRun),
+                     record.offset + sizeof(header))) {
+            release(record);
+            return false;
+        }
+        std::unordered_map <chisel::ChunkID, Record, chisel::ChunkHasher>::iterator old =
+                index_.find(id);
+        if (old != index_.end()) {
+            release(old->second);
+        }
+        index_[id] = record;
+        changed_ = true;
+        return true;
+    }
+
+    bool TsdfMapFile::read(const chisel::ChunkID &id, PackedChunk &chunk) {
+        std::unordered_map <chisel::ChunkID, Record, chisel::ChunkHasher>::const_iterator
+                entry = index_.find(id);
+        if (entry == index_.end()) {
+            return false;
+        }
+        uint64_t offset = entry->second.offset;
+        if (!map(offset + sizeof(RecordHeader))) {
+            return false;
+        }
+        RecordHeader record;
+        std::memcpy(&record, mapping_ + offset, sizeof(record));
+        size_t end = offset + sizeof(record) + record.runs * sizeof(VoxelRun);
+        if (!map(end)) {
+            return false;
+        }
+        chunk.count = record.count;
+        chunk.colors = record.colors;
+        chunk.weight_step = record.weight_step;
+        chunk.runs.resize(record.runs);
+        std::memcpy(chunk.runs.data(), mapping_ + offset + sizeof(record),
+                    record.runs * sizeof(VoxelRun));
+        return true;
+    }
+
+    void TsdfMapFile::remove(const chisel::ChunkID &id) {
+        std::unordered_map <chisel::ChunkID, Record, chisel::ChunkHasher>::iterator entry =
+                index_.find(id);
+        if (entry == index_.end()) {
+            return;
+        }
+        release(entry->second);
+        index_.erase(entry);
+        changed_ = true;
+    }
+
+    uint64_t TsdfMapFile::getRecordBytes() const {
+        return file_ < 0 ? 0 : end_ - sizeof(FileHeader);
+    }
+
+    uint64_t TsdfMapFile::allocate(uint64_t size) {
+        std::multimap <uint64_t, uint64_t>::iterator fit = free_sizes_.lower_bound(size);
+        if (fit == free_sizes_.end()) {
+            uint64_t offset = end_;
+            end_ += size;
+            return offset;
+        }
+        Record block = {fit->second, fit->first};
+        free_sizes_.erase(fit);
+        free_.erase(block.offset);
+        free_bytes_ -= block.size;
+        if (block.size > size) {
+            Record rest = {block.offset + size, block.size - size};
+            release(rest);
+        }
+        return block.offset;
+    }
+
+    void TsdfMapFile::release(const Record &record) {
+        if (!writable_ || record.size == 0) {
+            return;
+        }
+        Record block = record;
+        // merges with the free records right behind and in front of it
+        std::map <uint64_t, uint64_t>::iterator next = free_.find(block.offset + block.size);
+        if (next != free_.end()) {
+            block.size += next->second;
+            eraseFree(next->first, next->second);
+        }
+        std::map <uint64_t, uint64_t>::iterator previous = free_.lower_bound(block.offset);
+        if (previous != free_.begin()) {
+            --previous;
+            if (previous->first + previous->second == block.offset) {
+                block.offset = previous->first;
+                block.size += previous->second;
+                eraseFree(previous->first, previous->second);
+            }
+        }
+        if (block.offset + block.size == end_) {
+            // the file shrinks on the next flush
+            end_ = block.offset;
+            return;
+        }
+        free_[block.offset] = block.size;
+        free_sizes_.insert(std::make_pair(block.size, block.offset));
+        free_bytes_ += block.size;
+    }
+
+    void TsdfMapFile::eraseFree(uint64_t offset, uint64_t size) {
+        free_.erase(offset);
+        std::pair <std::multimap<uint64_t, uint64_t>::iterator,
+                std::multimap<uint64_t, uint64_t>::iterator> range = free_sizes_.equal_range(size);
+        for (std::multimap <uint64_t, uint64_t>::iterator it = range.first; it != range.second;
+             ++it) {
+            if (it->second == offset) {
+                free_sizes_.erase(it);
+                break;
+            }
+        }
+        free_bytes_ -= size;
+    }
+
+    std::vector <chisel::ChunkID> TsdfMapFile::getChunkIDs() const {
+        std::vector <chisel::ChunkID> ids;
+        ids.reserve(index_.size());
+        for (const std::pair <const chisel::ChunkID, Record> &entry : index_) {
+            ids.push_back(entry.first);
+        }
+        return ids;
+    }
+
+    bool TsdfMapFile::flush() {
+        if (!writable_) {
+            return false;
+        }
+        std::vector <IndexEntry> entries;
+        entries.reserve(index_.size());
+        for (const std::pair <const chisel::ChunkID, Record> &chunk : index_) {
+            IndexEntry entry = {{chunk.first(0), chunk.first(1), chunk.first(2)}, 0,
+                                chunk.second.offset};
+            entries.push_back(entry);
+        }
+        uint64_t offset = end_;
+        uint32_t count = static_cast<uint32_t>(entries.size());
+        if (!writeAt(file_, entries.data(), entries.size() * sizeof(IndexEntry), offset) ||
+            ftruncate(file_, static_cast<off_t>(offset + entries.size() * sizeof(IndexEntry))) ||
+            !writeAt(file_, &offset, sizeof(offset), offsetof(FileHeader, index_offset)) ||
+            !writeAt(file_, &count, sizeof(count), offsetof(FileHeader, index_count))) {
+            return false;
+        }
+        changed_ = false;
+        return true;
+    }
+
+    bool TsdfMapFile::map(size_t size) {
+        if (size <= mapped_size_) {
+            return true;
+        }
+        // appended records are beyond the old mapping, the whole file is mapped again
+        struct stat status;
+        if (fstat(file_, &status) != 0 || static_cast<size_t>(status.st_size) < size) {
+            return false;
+        }
+        unmap();
+        void *mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, file_, 0);
+        if (mapping == MAP_FAILED) {
+            return false;
+        }
+        mapping_ = static_cast<const uint8_t *>(mapping);
+        mapped_size_ = status.st_size;
+        return true;
+    }
+
+    void TsdfMapFile::unmap() {
+        if (mapping_ != nullptr) {
+            munmap(const_cast<uint8_t *>(mapping_), mapped_size_);
+        }
+        mapping_ = nullptr;
+        mapped_size_ = 0;
+    }
+
+}  // namespace tango_augmented_reality
@@ -0,0 +1,130 @@
+#include "tango-augmented-reality/tsdf_raycaster.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    // smallest step inside allocated chunks in voxel sizes, keeps rays from
+    // crawling along noisy distances close to the surface
+    const float kMinStep = 0.5f;
+
+    // moves the ray past the border of a skipped chunk
+    const float kChunkEpsilon = 1e-4f;
+
+    // distance along the ray at which it leaves the box [lower, upper]
+    float exitDistance(const glm::vec3 &origin, const glm::vec3 &direction,
+                       const glm::vec3 &lower, const glm::vec3 &upper) {
+        float exit = std::numeric_limits<float>::max();
+        for (int axis = 0; axis < 3; ++axis) {
+            if (direction[axis] > 0.0f) {
+                exit = std::min(exit, (upper[axis] - origin[axis]) / direction[axis]);
+            } else if (direction[axis] < 0.0f) {
+                exit = std::min(exit, (lower[axis] - origin[axis]) / direction[axis]);
+            }
+        }
+        return exit;
+    }
+}  // namespace
+
+namespace tango_augmented_reality {
+
+    TsdfRaycaster::TsdfRaycaster() : width_(0), height_(0) { }
+
+    void TsdfRaycaster::setResolution(int width, int height) {
+        width_ = width;
+        height_ = height;
+    }
+
+    void TsdfRaycaster::raycast(const chisel::ChunkManager &chunks,
+                                const glm::mat4 &view_projection, float max_distance,
+                                WorkerPool &pool, std::vector <float> &depth) const {
+        if (width_ == 0 || height_ == 0) {
+            return;
+        }
+        glm::mat4 inverse = glm::inverse(view_projection);
+
+        // rows are independent, the pool works on them in parallel
+        pool.run(height_, [&](int row) {
+            float y = (row + 0.5f) / height_ * 2.0f - 1.0f;
+            for (int column = 0; column < width_; ++column) {
+                float x = (column + 0.5f) / width_ * 2.0f - 1.0f;
+                glm::vec4 near = inverse * glm::vec4(x, y, -1.0f, 1.0f);
+                glm::vec4 far = inverse * glm::vec4(x, y, 1.0f, 1.0f);
+                glm::vec3 origin = glm::vec3(near) / near.w;
+                glm::vec3 direction = glm::vec3(far) / far.w - origin;
+                float length = glm::length(direction);
+                direction /= length;
+
+                float distance = castRay(chunks, origin, direction,
+                                         std::min(length, max_distance));
+                if (distance < 0.0f) {
+                    continue;
+                }
+                glm::vec4 clip = view_projection * glm::vec4(origin + direction * distance, 1.0f);
+                float window = clip.z / clip.w * 0.5f + 0.5f;
+                float &pixel = depth[row * width_ + column];
+                pixel = std::min(pixel, std::max(window, 0.0f));
+            }
+        });
+    }
+
+    float TsdfRaycaster::castRay(const chisel::ChunkManager &chunks, const glm::vec3 &origin,
+                                 const glm::vec3 &direction, float max_distance) const {
+        const Eigen::Vector3i &size = chunks.GetChunkSize();
+        float resolution = chunks.GetResolution();
+        glm::vec3 extent(size(0) * resolution, size(1) * resolution, size(2) * resolution);
+
+        chisel::ChunkID current(std::numeric_limits<int>::max(), 0, 0);
+        const chisel::Chunk *chunk = nullptr;
+        glm::vec3 lower;
+        bool has_last = false;
+        float last_sdf = 0.0f;
+        float last_distance = 0.0f;
+        float distance = 0.0f;
+        while (distance < max_distance) {
+            glm::vec3 point = origin + direction * distance;
+            chisel::ChunkID id(static_cast<int>(std::floor(point.x / extent.x)),
+                               static_cast<int>(std::floor(point.y / extent.y)),
+                               static_cast<int>(std::floor(point.z / extent.z)));
+            if (id != current) {
+                current = id;
+                auto found = chunks.GetChunks().find(id);
+                chunk = found == chunks.GetChunks().end() ? nullptr : found->second.get();
+                lower = glm::vec3(id(0) * extent.x, id(1) * extent.y, id(2) * extent.z);
+            }
+            if (chunk == nullptr) {
+                // nothing was ever integrated here, skip the whole chunk
+                distance = std::max(exitDistance(origin, direction, lower, lower + extent),
+                                    distance) + kChunkEpsilon;
+                has_last = false;
+                continue;
+            }
+
+            int voxel[3];
+            for (int axis = 0; axis < 3; ++axis) {
+                voxel[axis] = std::min(std::max(static_cast<int>(
+                        (point[axis] - lower[axis]) / resolution), 0), size(axis) - 1);
+            }
+            const chisel::DistVoxel &sample = chunk->GetDistVoxel(
+                    (voxel[2] * size(1) + voxel[1]) * size(0) + voxel[0]);
+            if (sample.GetWeight() <= 0.0f) {
+                distance += resolution;
+                has_last = false;
+                continue;
+            }
+
+            float sdf = sample.GetSDF();
+            if (has_last && last_sdf > 0.0f && sdf <= 0.0f) {
+                // the surface lies where the interpolated distance is zero
+                return last_distance + (distance - last_distance) * last_sdf / (last_sdf - sdf);
+            }
+            has_last = true;
+            last_sdf = sdf;
+            last_distance = distance;
+            distance += std::max(sdf, kMinStep * resolution);
+        }
+        return -1.0f;
+    }
+
+}  // namespace tango_augmented_reality
@@ -0,0 +1,59 @@
+#include "tango-augmented-reality/view_frustum.h"
+
+namespace tango_augmented_reality {
+
+    ViewFrustum::ViewFrustum() {
+        for (int i = 0; i < 6; ++i) {
+            planes_[i] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        }
+    }
+
+    ViewFrustum::ViewFrustum(const glm::mat4 &view_projection) {
+        // rows of the (column major) matrix
+        glm::vec4 row[4];
+        for (int i = 0; i < 4; ++i) {
+            row[i] = glm::vec4(view_projection[0][i], view_projection[1][i],
+                               view_projection[2][i], view_projection[3][i]);
+        }
+        // left, right, bottom, top, near, far (Gribb & Hartmann)
+        planes_[0] = row[3] + row[0];
+        planes_[1] = row[3] - row[0];
+        planes_[2] = row[3] + row[1];
+        planes_[3] = row[3] - row[1];
+        planes_[4] = row[3] + row[2];
+        planes_[5] = row[3] - row[2];
+        for (int i = 0; i < 6; ++i) {
+            float length = glm::length(glm::vec3(planes_[i]));
+            if (length > 0.0f) {
+                planes_[i] /= length;
+            }
+        }
+    }
+
+    bool ViewFrustum::intersects(const glm::vec3 &min, const glm::vec3 &max) const {
+        for (int i = 0; i < 6; ++i) {
+            // corner of the box which lies furthest along the plane normal
+            glm::vec3 corner(planes_[i].x >= 0.0f ? max.x : min.x,
+                             planes_[i].y >= 0.0f ? max.y : min.y,
+                             planes_[i].z >= 0.0f ? max.z : min.z);
+            if (glm::dot(glm::vec3(planes_[i]), corner) + planes_[i].w < 0.0f) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ViewFrustum::intersectsSphere(const glm::vec3 &center, float radius) const {
+        for (int i = 0; i < 6; ++i) {
+            if (glm::dot(glm::vec3(planes_[i]), center) + planes_[i].w < -radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ViewFrustum::contains(const glm::vec3 &point) const {
+        return intersectsSphere(point, 0.0f);
+    }
+
+}  // namespace tango_augmented_reality
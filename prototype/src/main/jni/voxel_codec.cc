@@ -0,0 +1,74 @@
+#include "tango-augmented-reality/voxel_codec.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // fixed point steps per voxel size, 128 voxels fit into 16 bits
+    const float kSdfStepsPerVoxel = 256.0f;
+
+    const float kMaxSdf = 32767.0f;
+    const float kMaxWeight = 255.0f;
+}  // namespace
+
+namespace tango_augmented_reality {
+
+    VoxelCodec::VoxelCodec(float sdf_step, float weight_step) : sdf_step_(sdf_step),
+                                                                weight_step_(weight_step) { }
+
+    VoxelCodec VoxelCodec::forResolution(float resolution, float weight_step) {
+        return VoxelCodec(resolution / kSdfStepsPerVoxel, weight_step);
+    }
+
+    void VoxelCodec::encode(const float *sdf, const float *weight, size_t count,
+                            int16_t *compact_sdf, uint8_t *compact_weight) const {
+        float sdf_scale = 1.0f / sdf_step_;
+        float weight_scale = 1.0f / weight_step_;
+        for (size_t i = 0; i < count; ++i) {
+            float distance = std::min(std::max(sdf[i] * sdf_scale, -kMaxSdf), kMaxSdf);
+            compact_sdf[i] = static_cast<int16_t>(std::floor(distance + 0.5f));
+            // observed voxels keep at least one step, otherwise they would vanish
+            float steps = std::min(std::floor(weight[i] * weight_scale + 0.5f), kMaxWeight);
+            compact_weight[i] = static_cast<uint8_t>(weight[i] > 0.0f ? std::max(steps, 1.0f)
+                                                                      : 0.0f);
+        }
+    }
+
+    void VoxelCodec::decode(const int16_t *compact_sdf, const uint8_t *compact_weight,
+                            size_t count, float *sdf, float *weight) const {
+        for (size_t i = 0; i < count; ++i) {
+            sdf[i] = compact_sdf[i] * sdf_step_;
+            weight[i] = compact_weight[i] * weight_step_;
+        }
+    }
+
+    void VoxelCodec::encode(const chisel::Chunk &chunk, CompactVoxels &voxels) const {
+        size_t count = chunk.GetTotalNumVoxels();
+        std::vector <float> sdf(count);
+        std::vector <float> weight(count);
+        for (size_t i = 0; i < count; ++i) {
+            const chisel::DistVoxel &voxel = chunk.GetDistVoxel(i);
+            sdf[i] = voxel.GetSDF();
+            weight[i] = voxel.GetWeight();
+        }
+        voxels.sdf.resize(count);
+        voxels.weight.resize(count);
+        encode(sdf.data(), weight.data(), count, voxels.sdf.data(), voxels.weight.data());
+    }
+
+    void VoxelCodec::decode(const CompactVoxels &voxels, chisel::Chunk &chunk) const {
+        size_t count = std::min(voxels.sdf.size(), static_cast<size_t>(chunk.GetTotalNumVoxels()));
+        std::vector <float> sdf(count);
+        std::vector <float> weight(count);
+        decode(voxels.sdf.data(), voxels.weight.data(), count, sdf.data(), weight.data());
+        for (size_t i = 0; i < count; ++i) {
+            if (voxels.weight[i] == 0) {
+                continue;
+            }
+            chisel::DistVoxel &voxel = chunk.GetDistVoxelMutable(i);
+            voxel.SetSDF(sdf[i]);
+            voxel.SetWeight(weight[i]);
+        }
+    }
+
+}  // namespace tango_augmented_reality
@@ -0,0 +1,76 @@
+#include "tango-augmented-reality/worker_pool.h"
+
+#include <algorithm>
+
+namespace tango_augmented_reality {
+
+    WorkerPool::WorkerPool(int threads) : task_(nullptr), count_(0), next_(0), active_(0),
+                                          generation_(0), running_(true) {
+        if (threads <= 0) {
+            threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+        }
+        for (int i = 0; i < threads; ++i) {
+            threads_.push_back(std::thread(&WorkerPool::loop, this));
+        }
+    }
+
+    WorkerPool::~WorkerPool() {
+        {
+            std::lock_guard <std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        start_.notify_all();
+        for (std::thread &thread : threads_) {
+            thread.join();
+        }
+    }
+
+    void WorkerPool::run(int count, const std::function<void(int)> &task) {
+        if (count <= 0) {
+            return;
+        }
+        {
+            std::lock_guard <std::mutex> lock(mutex_);
+            task_ = &task;
+            count_ = count;
+            next_ = 0;
+            active_ = static_cast<int>(threads_.size());
+            ++generation_;
+        }
+        start_.notify_all();
+        work();
+
+        // task has to outlive the helpers still working on it
+        std::unique_lock <std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return active_ == 0; });
+        task_ = nullptr;
+    }
+
+    void WorkerPool::loop() {
+        unsigned generation = 0;
+        while (true) {
+            {
+                std::unique_lock <std::mutex> lock(mutex_);
+                start_.wait(lock, [this, generation] {
+                    return !running_ || generation_ != generation;
+                });
+                if (!running_) {
+                    return;
+                }
+                generation = generation_;
+            }
+            work();
+            std::lock_guard <std::mutex> lock(mutex_);
+            if (--active_ == 0) {
+                done_.notify_one();
+            }
+        }
+    }
+
+    void WorkerPool::work() {
+        for (int i = next_++; i < count_; i = next_++) {
+            (*task_)(i);
+        }
+    }
+
+}  // namespace tango_augmented_reality